@@ -0,0 +1,192 @@
+#include "include/CodonSpecificParameterSet.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+CodonSpecificParameterSet::CodonSpecificParameterSet()
+{
+	alignOffset = 0u;
+	numCodons = 0u;
+	rowStride = 0u;
+}
+
+
+CodonSpecificParameterSet::CodonSpecificParameterSet(const CodonSpecificParameterSet& other)
+{
+	alignOffset = 0u;
+	numCodons = 0u;
+	rowStride = 0u;
+	*this = other;
+}
+
+
+// The alignment offset depends on the address of the buffer, so the values are copied
+// into a freshly aligned buffer instead of copying the vector as is.
+CodonSpecificParameterSet& CodonSpecificParameterSet::operator=(const CodonSpecificParameterSet& rhs)
+{
+	if (this == &rhs) return *this; // handle self assignment
+	categoriesPerType = rhs.categoriesPerType;
+	typeOffset = rhs.typeOffset;
+	numCodons = rhs.numCodons;
+	rowStride = rhs.rowStride;
+
+	unsigned size = rhs.values.empty() ? 0u : (unsigned)rhs.values.size() - alignment;
+	values.assign(size + alignment, 0.0);
+	uintptr_t misalignment = ((uintptr_t)values.data() % (alignment * sizeof(double))) / sizeof(double);
+	alignOffset = (unsigned)((alignment - misalignment) % alignment);
+	if (size > 0u)
+		std::copy(rhs.values.begin() + rhs.alignOffset, rhs.values.begin() + rhs.alignOffset + size, base());
+	return *this;
+}
+
+
+CodonSpecificParameterSet::~CodonSpecificParameterSet()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Layout Functions ----------//
+//--------------------------------------//
+
+
+// Sets up numParamTypes parameter types without any categories.
+void CodonSpecificParameterSet::initialize(unsigned numParamTypes, unsigned _numCodons)
+{
+	relayout(std::vector<unsigned>(numParamTypes, 0u), _numCodons, 0.0);
+}
+
+
+// Changes the number of categories of one parameter type, keeping the values of all
+// existing categories. New categories are filled with value.
+void CodonSpecificParameterSet::resizeParameterType(unsigned paramType, unsigned numCategories, double value)
+{
+	std::vector<unsigned> newCategoriesPerType = categoriesPerType;
+	if (paramType >= newCategoriesPerType.size())
+		newCategoriesPerType.resize(paramType + 1, 0u);
+	newCategoriesPerType[paramType] = numCategories;
+	relayout(newCategoriesPerType, numCodons, value);
+}
+
+
+unsigned CodonSpecificParameterSet::getNumParameterTypes()
+{
+	return (unsigned)categoriesPerType.size();
+}
+
+
+unsigned CodonSpecificParameterSet::getNumCategories(unsigned paramType)
+{
+	return categoriesPerType[paramType];
+}
+
+
+unsigned CodonSpecificParameterSet::getNumCodons()
+{
+	return numCodons;
+}
+
+
+void CodonSpecificParameterSet::relayout(std::vector<unsigned> newCategoriesPerType, unsigned newNumCodons, double value)
+{
+	unsigned newRowStride = ((newNumCodons + alignment - 1u) / alignment) * alignment;
+	std::vector<unsigned> newTypeOffset(newCategoriesPerType.size(), 0u);
+	unsigned size = 0u;
+	for (unsigned i = 0u; i < newCategoriesPerType.size(); i++)
+	{
+		newTypeOffset[i] = size;
+		size += newCategoriesPerType[i] * newRowStride;
+	}
+
+	std::vector<double> newValues(size + alignment, value);
+	uintptr_t misalignment = ((uintptr_t)newValues.data() % (alignment * sizeof(double))) / sizeof(double);
+	unsigned newAlignOffset = (unsigned)((alignment - misalignment) % alignment);
+
+	// keep whatever overlaps with the old layout
+	unsigned copyCodons = std::min(numCodons, newNumCodons);
+	for (unsigned i = 0u; i < std::min(categoriesPerType.size(), newCategoriesPerType.size()); i++)
+	{
+		for (unsigned category = 0u; category < std::min(categoriesPerType[i], newCategoriesPerType[i]); category++)
+		{
+			double *from = base() + typeOffset[i] + category * rowStride;
+			std::copy(from, from + copyCodons, newValues.data() + newAlignOffset + newTypeOffset[i] + category * newRowStride);
+		}
+	}
+
+	values.swap(newValues);
+	alignOffset = newAlignOffset;
+	categoriesPerType = newCategoriesPerType;
+	typeOffset = newTypeOffset;
+	numCodons = newNumCodons;
+	rowStride = newRowStride;
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Access Functions ----------//
+//--------------------------------------//
+
+
+CodonSpecificParameterSet::ParameterTypeView CodonSpecificParameterSet::operator[](unsigned paramType)
+{
+	return ParameterTypeView(base() + typeOffset[paramType], categoriesPerType[paramType], rowStride);
+}
+
+
+// Copy of one parameter type as nested vectors ([category][codon]), e.g. for R or restart files.
+std::vector<std::vector<double>> CodonSpecificParameterSet::getParameterType(unsigned paramType)
+{
+	std::vector<std::vector<double>> matrix(categoriesPerType[paramType]);
+	for (unsigned category = 0u; category < matrix.size(); category++)
+	{
+		double *row = (*this)[paramType][category];
+		matrix[category].assign(row, row + numCodons);
+	}
+	return matrix;
+}
+
+
+// Replaces one parameter type by the given [category][codon] matrix. If no codon count
+// has been set yet, it is taken from the matrix.
+void CodonSpecificParameterSet::setParameterType(unsigned paramType, const std::vector<std::vector<double>> &matrix)
+{
+	if (numCodons == 0u && !matrix.empty())
+		relayout(categoriesPerType, (unsigned)matrix[0].size(), 0.0);
+	resizeParameterType(paramType, (unsigned)matrix.size());
+	for (unsigned category = 0u; category < matrix.size(); category++)
+	{
+		unsigned n = std::min(numCodons, (unsigned)matrix[category].size());
+		std::copy(matrix[category].begin(), matrix[category].begin() + n, (*this)[paramType][category]);
+	}
+}
+
+
+// Copies the codons [codonStart, codonEnd) of all parameter types and categories from other,
+// which must have the same layout. Used to accept the proposal for a single grouping; the rows
+// of a grouping are contiguous so this is one block copy per row.
+void CodonSpecificParameterSet::copyCodonRange(CodonSpecificParameterSet &other, unsigned codonStart, unsigned codonEnd)
+{
+	for (unsigned i = 0u; i < categoriesPerType.size(); i++)
+	{
+		ParameterTypeView to = (*this)[i];
+		ParameterTypeView from = other[i];
+		for (unsigned category = 0u; category < to.size(); category++)
+		{
+			std::copy(from[category] + codonStart, from[category] + codonEnd, to[category] + codonStart);
+		}
+	}
+}
@@ -1,5 +1,4 @@
 #include "include/CovarianceMatrix.h"
-#include "include/SequenceSummary.h"
 
 #ifndef STANDALONE
 #include <Rcpp.h>
@@ -31,6 +30,7 @@ CovarianceMatrix::CovarianceMatrix(std::vector <double> &matrix)
     numVariates = (int)std::sqrt(matrix.size());
     covMatrix = matrix;
     choleskiMatrix.resize(matrix.size(), 0.0);
+    clearSamples();
 }
 
 
@@ -39,6 +39,10 @@ CovarianceMatrix::CovarianceMatrix(const CovarianceMatrix& other)
     numVariates = other.numVariates;
     covMatrix = other.covMatrix;
     choleskiMatrix = other.choleskiMatrix;
+    numSamples = other.numSamples;
+    sampleMeans = other.sampleMeans;
+    sampleComoments = other.sampleComoments;
+    sampleDeviations = other.sampleDeviations;
 }
 
 
@@ -48,6 +52,10 @@ CovarianceMatrix& CovarianceMatrix::operator=(const CovarianceMatrix& rhs)
     numVariates = rhs.numVariates;
     covMatrix = rhs.covMatrix;
 		choleskiMatrix = rhs.choleskiMatrix;
+    numSamples = rhs.numSamples;
+    sampleMeans = rhs.sampleMeans;
+    sampleComoments = rhs.sampleComoments;
+    sampleDeviations = rhs.sampleDeviations;
     return *this;
 }
 
@@ -96,6 +104,7 @@ void CovarianceMatrix::initCovarianceMatrix(unsigned _numVariates)
         covMatrix[i] = (i % (numVariates + 1) ? 0.0 : 0.1);
         choleskiMatrix[i] = 0.0;
     }
+    clearSamples();
 }
 
 void CovarianceMatrix::setDiag(double val)
@@ -211,60 +220,55 @@ std::vector<double> CovarianceMatrix::transformIidNumersIntoCovaryingNumbers(std
     return covnumbers;
 }
 
-void CovarianceMatrix::calculateSampleCovariance(std::vector<std::vector<std::vector<std::vector<double>>>> codonSpecificParameterTrace, std::string aa, unsigned samples, unsigned lastIteration)
+// Rank-1 update of the running mean and comoments with one sample of all variates, O(numVariates^2).
+void CovarianceMatrix::addSample(const std::vector<double> &sample)
 {
-	//order of codonSpecificParameterTrace: paramType, category, numparam, samples
-	unsigned numParamTypesInModel = codonSpecificParameterTrace.size();
-	unsigned numCategoriesInModel = codonSpecificParameterTrace[0].size();
-
-	unsigned start = lastIteration - samples;
-	
-	unsigned aaStart;
-	unsigned aaEnd;
-	SequenceSummary::AAToCodonRange(aa, aaStart, aaEnd, true);
-
-	unsigned IDX = 0;
-	for (unsigned paramType1 = 0; paramType1 < numParamTypesInModel; paramType1++)
+	unsigned n = (unsigned)numVariates;
+	if (sampleMeans.size() != n) clearSamples(); // the matrix was replaced, e.g. by setCovarianceMatrix
+	numSamples++;
+	for (unsigned i = 0u; i < n; i++)
 	{
-		for (unsigned category1 = 0; category1 < numCategoriesInModel; category1++)
+		sampleDeviations[i] = sample[i] - sampleMeans[i];
+		sampleMeans[i] += sampleDeviations[i] / numSamples;
+	}
+	for (unsigned i = 0u; i < n; i++)
+	{
+		double *row = &sampleComoments[i * n];
+		double deviation = sampleDeviations[i];
+		for (unsigned j = 0u; j < n; j++)
 		{
-			for (unsigned param1 = aaStart; param1 < aaEnd; param1++)
-			{
-				double mean1 = sampleMean(codonSpecificParameterTrace[paramType1][category1][param1], samples, lastIteration);
-				for (unsigned paramType2 = 0; paramType2 < numParamTypesInModel; paramType2++)
-				{
-					for (unsigned category2 = 0; category2 < numCategoriesInModel; category2++)
-					{
-						for (unsigned param2 = aaStart; param2 < aaEnd; param2++)
-						{
-							double mean2 = sampleMean(codonSpecificParameterTrace[paramType2][category2][param2], samples, lastIteration);
-							double unscaledSampleCov = 0.0;
-							for (unsigned i = start; i < lastIteration; i++)
-							{
-								unscaledSampleCov += (codonSpecificParameterTrace[paramType1][category1][param1][i] - mean1) * (codonSpecificParameterTrace[paramType2][category2][param2][i] - mean2);
-							}
-							covMatrix[IDX] = unscaledSampleCov / (samples - 1);
-							IDX++;
-						}
-					}
-				}
-			}
+			row[j] += deviation * (sample[j] - sampleMeans[j]);
 		}
 	}
 }
 
-double CovarianceMatrix::sampleMean(std::vector<double> sampleVector, unsigned samples, unsigned lastIteration)
+
+void CovarianceMatrix::clearSamples()
 {
-	double posteriorMean = 0.0;
-	unsigned start = lastIteration - samples;
-	for (unsigned i = start; i < lastIteration; i++)
-	{
-		posteriorMean += sampleVector[i];
-	}
-	return posteriorMean / (double)samples;
+	unsigned n = (unsigned)numVariates;
+	numSamples = 0u;
+	sampleMeans.assign(n, 0.0);
+	sampleComoments.assign(n * n, 0.0);
+	sampleDeviations.assign(n, 0.0);
+}
+
+
+unsigned CovarianceMatrix::getNumSamples()
+{
+	return numSamples;
 }
 
 
+// Sets the matrix to the sample covariance of the samples added since the last clearSamples. Needs two samples,
+// otherwise the matrix is left as it is.
+void CovarianceMatrix::calculateSampleCovariance()
+{
+	if (numSamples < 2u) return;
+	for (unsigned i = 0u; i < covMatrix.size(); i++)
+	{
+		covMatrix[i] = sampleComoments[i] / (numSamples - 1);
+	}
+}
 
 
 
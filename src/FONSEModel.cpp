@@ -1,5 +1,7 @@
 #include "include/FONSE/FONSEModel.h"
 
+#include <algorithm>
+
 
 //--------------------------------------------------//
 //----------- Constructors & Destructors ---------- //
@@ -98,43 +100,51 @@ void FONSEModel::calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneInd
 
 	double phiValue = parameter->getSynthesisRate(geneIndex, expressionCategory, false);
 	double phiValue_proposed = parameter->getSynthesisRate(geneIndex, expressionCategory, true);
+	double logPhiValue = parameter->getLogSynthesisRate(geneIndex, expressionCategory, false);
+	double logPhiValue_proposed = parameter->getLogSynthesisRate(geneIndex, expressionCategory, true);
 
 
-	/* This loop causes a compiler warning because i is an int, but openMP won't compile if I change i to unsigned.
-		Maybe worth looking into? */
+	// the amino acid terms are added up in grouping order after the loop, so the result does not depend on the number of threads
+	int numGroupings = (int)getGroupListSize();
+	double groupingLikelihoods[2 * maxGroupings] = {0.0};
 #ifndef __APPLE__
-#pragma omp parallel for private(mutation, selection, positions, curAA) reduction(+:likelihood,likelihood_proposed)
+#pragma omp parallel for private(mutation, selection, positions, curAA)
 #endif
-	for (int i = 0; i < getGroupListSize(); i++)
+	for (int i = 0; i < numGroupings; i++)
 	{
 		curAA = getGrouping(i);
 
 		parameter->getParameterForCategory(mutationCategory, FONSEParameter::dM, curAA, false, mutation);
 		parameter->getParameterForCategory(selectionCategory, FONSEParameter::dOmega, curAA, false, selection);
 
-		likelihood += calculateLogLikelihoodRatioPerAA(gene, curAA, mutation, selection, phiValue);
-		likelihood_proposed += calculateLogLikelihoodRatioPerAA(gene, curAA, mutation, selection, phiValue_proposed);
+		groupingLikelihoods[2 * i] = calculateLogLikelihoodRatioPerAA(gene, curAA, mutation, selection, phiValue);
+		groupingLikelihoods[2 * i + 1] = calculateLogLikelihoodRatioPerAA(gene, curAA, mutation, selection, phiValue_proposed);
+	}
+	for (int i = 0; i < numGroupings; i++)
+	{
+		likelihood += groupingLikelihoods[2 * i];
+		likelihood_proposed += groupingLikelihoods[2 * i + 1];
 	}
 
 	//std::cout << logLikelihood << " " << logLikelihood_proposed << std::endl;
 
 	double stdDevSynthesisRate = parameter->getStdDevSynthesisRate(false);
-	double logPhiProbability = Parameter::densityLogNorm(phiValue, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
-	double logPhiProbability_proposed = Parameter::densityLogNorm(phiValue_proposed, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
-	double currentLogLikelihood = (likelihood + logPhiProbability);
-	double proposedLogLikelihood = (likelihood_proposed + logPhiProbability_proposed);
+	double logPhiProbability = Parameter::densityLogNormLogScale(logPhiValue, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
+	double logPhiProbability_proposed = Parameter::densityLogNormLogScale(logPhiValue_proposed, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
+	double currentLogLikelihood = (inverseTemperature * likelihood + logPhiProbability);
+	double proposedLogLikelihood = (inverseTemperature * likelihood_proposed + logPhiProbability_proposed);
 	if (phiValue == 0) {
 		std::cout << "phiValue is 0\n";
 	}
 	if (phiValue_proposed == 0) {
 		std::cout << "phiValue_prop is 0\n";
 	}
-	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (std::log(phiValue) - std::log(phiValue_proposed));
-	logProbabilityRatio[1] = currentLogLikelihood - std::log(phiValue_proposed);
+	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (logPhiValue - logPhiValue_proposed);
+	logProbabilityRatio[1] = currentLogLikelihood - logPhiValue_proposed;
 	if (std::isinf(logProbabilityRatio[1])) {
 		std::cout << "logprob1 inf\n";
 	}
-	logProbabilityRatio[2] = proposedLogLikelihood - std::log(phiValue);
+	logProbabilityRatio[2] = proposedLogLikelihood - logPhiValue;
 	if (std::isinf(logProbabilityRatio[2])) {
 		std::cout << "logprob2 inf\n";
 	}
@@ -164,8 +174,10 @@ void FONSEModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string g
 	Gene *gene;
 	SequenceSummary *seqsum;
 
+	// the gene terms are added up in gene order after the loop, so the result does not depend on the number of threads
+	std::vector<double> geneLikelihoods(2 * numGenes, 0.0);
 #ifndef __APPLE__
-	#pragma omp parallel for private(mutation, selection, mutation_proposed, selection_proposed, curAA, gene, seqsum) reduction(+:likelihood,likelihood_proposed)
+	#pragma omp parallel for private(mutation, selection, mutation_proposed, selection_proposed, curAA, gene, seqsum)
 #endif
 	for (int i = 0; i < numGenes; i++)
 	{
@@ -191,11 +203,118 @@ void FONSEModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string g
 		parameter->getParameterForCategory(mutationCategory, FONSEParameter::dM, grouping, true, mutation_proposed);
 		parameter->getParameterForCategory(selectionCategory, FONSEParameter::dOmega, grouping, true, selection_proposed);
 
-		likelihood += calculateLogLikelihoodRatioPerAA(*gene, grouping, mutation, selection, phiValue);
-		likelihood_proposed += calculateLogLikelihoodRatioPerAA(*gene, grouping, mutation_proposed, selection_proposed, phiValue);
+		geneLikelihoods[2 * i] = calculateLogLikelihoodRatioPerAA(*gene, grouping, mutation, selection, phiValue);
+		geneLikelihoods[2 * i + 1] = calculateLogLikelihoodRatioPerAA(*gene, grouping, mutation_proposed, selection_proposed, phiValue);
+
+	}
+	for (int i = 0; i < numGenes; i++)
+	{
+		likelihood += geneLikelihoods[2 * i];
+		likelihood_proposed += geneLikelihoods[2 * i + 1];
+	}
+	logAcceptanceRatioForAllMixtures = inverseTemperature * (likelihood_proposed - likelihood);
+}
+
+
+// Blocked version of calculateLogLikelihoodRatioPerGroupingPerCategory: every gene is visited once and
+// contributes to the ratios of all amino acids. The genes are split into chunks of codonSpecificChunkSize
+// genes with their own partial sums, which are added up in chunk order, so the result does not depend on
+// the number of threads.
+void FONSEModel::calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios)
+{
+	prepareCodonSpecificParameterTables();
+
+	unsigned numGroupings = getGroupListSize();
+	int numGenes = genome.getGenomeSize();
+	int numChunks = (numGenes + codonSpecificChunkSize - 1) / codonSpecificChunkSize;
+	std::vector<double> chunkLikelihoods(numChunks * 2 * numGroupings, 0.0);
+
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int c = 0; c < numChunks; c++)
+	{
+		int end = std::min((c + 1) * (int)codonSpecificChunkSize, numGenes);
+		for (int i = c * codonSpecificChunkSize; i < end; i++)
+		{
+			addGeneToCodonSpecificLogLikelihoods(genome.getGene(i), i, &chunkLikelihoods[c * 2 * numGroupings]);
+		}
+	}
 
+	logAcceptanceRatios.assign(numGroupings, 0.0);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		double likelihood = 0.0;
+		double likelihood_proposed = 0.0;
+		for (int c = 0; c < numChunks; c++)
+		{
+			likelihood += chunkLikelihoods[(c * numGroupings + g) * 2];
+			likelihood_proposed += chunkLikelihoods[(c * numGroupings + g) * 2 + 1];
+		}
+		logAcceptanceRatios[g] = inverseTemperature * (likelihood_proposed - likelihood);
+	}
+}
+
+
+// Looks up the current and proposed parameters of every grouping and category once per update instead of once per gene.
+void FONSEModel::prepareCodonSpecificParameterTables()
+{
+	unsigned numGroupings = getGroupListSize();
+	unsigned numMutationCategories = parameter->getNumMutationCategories();
+	unsigned numSelectionCategories = parameter->getNumSelectionCategories();
+
+	tableGroupings.resize(numGroupings);
+	tableMutation.assign(numGroupings * numMutationCategories * 5, 0.0);
+	tableMutation_proposed.assign(numGroupings * numMutationCategories * 5, 0.0);
+	tableSelection.assign(numGroupings * numSelectionCategories * 5, 0.0);
+	tableSelection_proposed.assign(numGroupings * numSelectionCategories * 5, 0.0);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		tableGroupings[g] = getGrouping(g);
+		for (unsigned category = 0u; category < numMutationCategories; category++)
+		{
+			unsigned c = (g * numMutationCategories + category) * 5;
+			parameter->getParameterForCategory(category, FONSEParameter::dM, tableGroupings[g], false, &tableMutation[c]);
+			parameter->getParameterForCategory(category, FONSEParameter::dM, tableGroupings[g], true, &tableMutation_proposed[c]);
+		}
+		for (unsigned category = 0u; category < numSelectionCategories; category++)
+		{
+			unsigned c = (g * numSelectionCategories + category) * 5;
+			parameter->getParameterForCategory(category, FONSEParameter::dOmega, tableGroupings[g], false, &tableSelection[c]);
+			parameter->getParameterForCategory(category, FONSEParameter::dOmega, tableGroupings[g], true, &tableSelection_proposed[c]);
+		}
+	}
+}
+
+
+// Adds the gene to the current (2 * grouping) and proposed (2 * grouping + 1) log likelihood of every grouping,
+// using the tables of prepareCodonSpecificParameterTables.
+void FONSEModel::addGeneToCodonSpecificLogLikelihoods(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods)
+{
+	unsigned numMutationCategories = parameter->getNumMutationCategories();
+	unsigned numSelectionCategories = parameter->getNumSelectionCategories();
+	SequenceSummary *seqsum = gene.getSequenceSummary();
+
+	// which mixture element does this gene belong to
+	unsigned mixtureElement = parameter->getMixtureAssignment(geneIndex);
+	// how is the mixture element defined. Which categories make it up
+	unsigned mutationCategory = parameter->getMutationCategory(mixtureElement);
+	unsigned selectionCategory = parameter->getSelectionCategory(mixtureElement);
+	unsigned expressionCategory = parameter->getSynthesisRateCategory(mixtureElement);
+	// get phi value, calculate likelihood conditional on phi
+	double phiValue = parameter->getSynthesisRate(geneIndex, expressionCategory, false);
+
+	for (unsigned g = 0u; g < tableGroupings.size(); g++)
+	{
+		if (seqsum->getAACountForAA(tableGroupings[g]) == 0) continue;
+
+		unsigned m = (g * numMutationCategories + mutationCategory) * 5;
+		unsigned s = (g * numSelectionCategories + selectionCategory) * 5;
+		codonSpecificLogLikelihoods[2 * g] += calculateLogLikelihoodRatioPerAA(gene, tableGroupings[g], &tableMutation[m],
+				&tableSelection[s], phiValue);
+		codonSpecificLogLikelihoods[2 * g + 1] += calculateLogLikelihoodRatioPerAA(gene, tableGroupings[g], &tableMutation_proposed[m],
+				&tableSelection_proposed[s], phiValue);
 	}
-	logAcceptanceRatioForAllMixtures = likelihood_proposed - likelihood;
 }
 
 
@@ -212,23 +331,32 @@ void FONSEModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, u
 		currentStdDevSynthesisRate[i] = getStdDevSynthesisRate(i, false);
 		currentMphi[i] = -((currentStdDevSynthesisRate[i] * currentStdDevSynthesisRate[i]) / 2);
 		proposedStdDevSynthesisRate[i] = getStdDevSynthesisRate(i, true);
-		proposedMphi[i] = -((proposedMphi[i] * proposedMphi[i]) / 2);
+		proposedMphi[i] = -((proposedStdDevSynthesisRate[i] * proposedStdDevSynthesisRate[i]) / 2);
 		lpr -= (std::log(currentStdDevSynthesisRate[i]) - std::log(proposedStdDevSynthesisRate[i]));
 	}
 
 	logProbabilityRatio.resize(1);
 
+	// the gene terms are added up in gene order after the loop, so the result does not depend on the number of threads
+	int numGenes = genome.getGenomeSize();
+	std::vector<double> geneLogProbabilityRatios(numGenes, 0.0);
 #ifndef __APPLE__
-#pragma omp parallel for reduction(+:lpr)
+#pragma omp parallel for
 #endif
-	for (int i = 0u; i < genome.getGenomeSize(); i++)
+	for (int i = 0u; i < numGenes; i++)
 	{
 		unsigned mixture = getMixtureAssignment(i);
 		mixture = getSynthesisRateCategory(mixture);
-		double phi = getSynthesisRate(i, mixture, false);
-		lpr += Parameter::densityLogNorm(phi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true)
-			   - Parameter::densityLogNorm(phi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
+		double logPhi = getLogSynthesisRate(i, mixture, false);
+		geneLogProbabilityRatios[i] = Parameter::densityLogNormLogScale(logPhi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true)
+			   - Parameter::densityLogNormLogScale(logPhi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
+	}
+	double geneLpr = 0.0;
+	for (int i = 0; i < numGenes; i++)
+	{
+		geneLpr += geneLogProbabilityRatios[i];
 	}
+	lpr += geneLpr;
 	logProbabilityRatio[0] = lpr;
 }
 
@@ -236,6 +364,76 @@ void FONSEModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, u
 
 
 
+
+//-----------------------------------------------//
+//---------- Fused Iteration Functions ----------//
+//-----------------------------------------------//
+
+
+bool FONSEModel::isFusedIterationSupported()
+{
+	return true;
+}
+
+
+unsigned FONSEModel::getNumHyperParameterLogRatios()
+{
+	return 1u;
+}
+
+
+void FONSEModel::prepareFusedIteration(Genome& genome)
+{
+	prepareCodonSpecificParameterTables();
+
+	unsigned numSynthesisRateCategories = getNumSynthesisRateCategories();
+	fusedStdDevSynthesisRate.resize(numSynthesisRateCategories);
+	fusedStdDevSynthesisRate_proposed.resize(numSynthesisRateCategories);
+	for (unsigned i = 0u; i < numSynthesisRateCategories; i++)
+	{
+		fusedStdDevSynthesisRate[i] = getStdDevSynthesisRate(i, false);
+		fusedStdDevSynthesisRate_proposed[i] = getStdDevSynthesisRate(i, true);
+	}
+}
+
+
+// Gene terms of calculateLogLikelihoodRatioPerGroupingPerCategory and calculateLogLikelihoodRatioForHyperParameters.
+void FONSEModel::addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+		double *hyperParameterLogRatios)
+{
+	addGeneToCodonSpecificLogLikelihoods(gene, geneIndex, codonSpecificLogLikelihoods);
+
+	unsigned mixture = getSynthesisRateCategory(getMixtureAssignment(geneIndex));
+	double logPhi = getLogSynthesisRate(geneIndex, mixture, false);
+	double stdDevSynthesisRate = fusedStdDevSynthesisRate[mixture];
+	double stdDevSynthesisRate_proposed = fusedStdDevSynthesisRate_proposed[mixture];
+	double mPhi = -((stdDevSynthesisRate * stdDevSynthesisRate) / 2);
+	double mPhi_proposed = -((stdDevSynthesisRate_proposed * stdDevSynthesisRate_proposed) / 2);
+	hyperParameterLogRatios[0] += Parameter::densityLogNormLogScale(logPhi, mPhi_proposed, stdDevSynthesisRate_proposed, true)
+			- Parameter::densityLogNormLogScale(logPhi, mPhi, stdDevSynthesisRate, true);
+}
+
+
+void FONSEModel::completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+		std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios)
+{
+	unsigned numGroupings = (unsigned)tableGroupings.size();
+	codonSpecificLogRatios.resize(numGroupings);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		codonSpecificLogRatios[g] = inverseTemperature * (codonSpecificLogLikelihoods[2 * g + 1] - codonSpecificLogLikelihoods[2 * g]);
+	}
+
+	for (unsigned i = 0u; i < fusedStdDevSynthesisRate.size(); i++)
+	{
+		hyperParameterLogRatios[0] -= (std::log(fusedStdDevSynthesisRate[i]) - std::log(fusedStdDevSynthesisRate_proposed[i]));
+	}
+}
+
+
+
+
+
 //----------------------------------------------------------//
 //---------- Initialization and Restart Functions ----------//
 //----------------------------------------------------------//
@@ -285,7 +483,7 @@ unsigned FONSEModel::getSynthesisRateCategory(unsigned mixture)
 }
 
 
-std::vector<unsigned> FONSEModel::getMixtureElementsOfSelectionCategory(unsigned k)
+std::vector<unsigned>& FONSEModel::getMixtureElementsOfSelectionCategory(unsigned k)
 {
 	return parameter->getMixtureElementsOfSelectionCategory(k);
 }
@@ -351,6 +549,12 @@ double FONSEModel::getSynthesisRate(unsigned index, unsigned mixture, bool propo
 }
 
 
+double FONSEModel::getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed)
+{
+	return parameter->getLogSynthesisRate(index, mixture, proposed);
+}
+
+
 void FONSEModel::updateSynthesisRate(unsigned i, unsigned k)
 {
 	parameter->updateSynthesisRate(i, k);
@@ -438,6 +642,12 @@ void FONSEModel::updateTracesWithInitialValues(Genome & genome)
 }
 
 
+Trace& FONSEModel::getTraceObject()
+{
+	return parameter->getTraceObject();
+}
+
+
 
 
 
@@ -670,6 +880,38 @@ double FONSEModel::calculateAllPriors()
 }
 
 
+// Untempered codon log likelihood of the current state. Summed in chunk order as in
+// calculateLogLikelihoodRatioForAllGroupings, so the result does not depend on the number of threads.
+double FONSEModel::calculateLogLikelihood(Genome& genome)
+{
+	prepareCodonSpecificParameterTables();
+
+	unsigned numGroupings = getGroupListSize();
+	int numGenes = genome.getGenomeSize();
+	int numChunks = (numGenes + codonSpecificChunkSize - 1) / codonSpecificChunkSize;
+	std::vector<double> chunkLogLikelihoods(numChunks * 2 * numGroupings, 0.0);
+
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int c = 0; c < numChunks; c++)
+	{
+		int end = std::min((c + 1) * (int)codonSpecificChunkSize, numGenes);
+		for (int i = c * codonSpecificChunkSize; i < end; i++)
+		{
+			addGeneToCodonSpecificLogLikelihoods(genome.getGene(i), i, &chunkLogLikelihoods[c * 2 * numGroupings]);
+		}
+	}
+
+	double logLikelihood = 0.0;
+	for (unsigned k = 0u; k < chunkLogLikelihoods.size(); k += 2u)
+	{
+		logLikelihood += chunkLogLikelihoods[k];
+	}
+	return logLikelihood;
+}
+
+
 void FONSEModel::calculateCodonProbabilityVector(unsigned numCodons, unsigned position, unsigned maxIndexValue,
 												 double *mutation, double *selection, double phi, double codonProb[])
 {
@@ -22,15 +22,15 @@ FONSEParameter::FONSEParameter() : Parameter()
 	//CTOR
 	bias_csp = 0;
 	mutation_prior_sd = 0.35;
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 }
 
 
 FONSEParameter::FONSEParameter(std::string filename) : Parameter(22)
 {
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 	initFromRestartFile(filename);
 }
 
@@ -94,28 +94,14 @@ void FONSEParameter::initFONSEParameterSet()
 	std_csp.resize(numParam, 0.1);
 	//may need getter fcts
 
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, numParam);
+	proposedCodonSpecificParameter.initialize(2, numParam);
 
-	currentCodonSpecificParameter[dM].resize(numMutationCategories);
-	proposedCodonSpecificParameter[dM].resize(numMutationCategories);
+	currentCodonSpecificParameter.resizeParameterType(dM, numMutationCategories);
+	proposedCodonSpecificParameter.resizeParameterType(dM, numMutationCategories);
 
-	for (unsigned i = 0u; i < numMutationCategories; i++)
-	{
-		std::vector<double> tmp(numParam, 0.0);
-		currentCodonSpecificParameter[dM][i] = tmp;
-		proposedCodonSpecificParameter[dM][i] = tmp;
-	}
-
-	currentCodonSpecificParameter[dOmega].resize(numSelectionCategories);
-	proposedCodonSpecificParameter[dOmega].resize(numSelectionCategories);
-
-	for (unsigned i = 0u; i < numSelectionCategories; i++)
-	{
-		std::vector<double> tmp(numParam, 0.0);
-		proposedCodonSpecificParameter[dOmega][i] = tmp;
-		currentCodonSpecificParameter[dOmega][i] = tmp;
-	}
+	currentCodonSpecificParameter.resizeParameterType(dOmega, numSelectionCategories);
+	proposedCodonSpecificParameter.resizeParameterType(dOmega, numSelectionCategories);
 
 	for (unsigned i = 0; i < maxGrouping; i++)
 	{
@@ -133,6 +119,8 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 {
 	std::ifstream input;
 	std::vector <double> mat;
+	std::vector<std::vector<double>> mutationValues;
+	std::vector<std::vector<double>> selectionValues;
 	covarianceMatrix.resize(maxGrouping);
 	input.open(filename.c_str());
 	if (input.fail())
@@ -181,7 +169,7 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 			{
 				if (tmp == "***")
 				{
-					currentCodonSpecificParameter[dM].resize(currentCodonSpecificParameter[dM].size() + 1);
+					mutationValues.resize(mutationValues.size() + 1);
 					cat++;
 				}
 				else if (tmp == "\n")
@@ -192,7 +180,7 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 					iss.str(tmp);
 					while (iss >> val)
 					{
-						currentCodonSpecificParameter[dM][cat - 1].push_back(val);
+						mutationValues[cat - 1].push_back(val);
 					}
 				}
 			}
@@ -200,7 +188,7 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 			{
 				if (tmp == "***")
 				{
-					currentCodonSpecificParameter[dOmega].resize(currentCodonSpecificParameter[dOmega].size() + 1);
+					selectionValues.resize(selectionValues.size() + 1);
 					cat++;
 				}
 				else if (tmp == "\n")
@@ -211,7 +199,7 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 					iss.str(tmp);
 					while (iss >> val)
 					{
-						currentCodonSpecificParameter[dOmega][cat - 1].push_back(val);
+						selectionValues[cat - 1].push_back(val);
 					}
 				}
 			}
@@ -249,16 +237,9 @@ void FONSEParameter::initFONSEValuesFromFile(std::string filename)
 
 	//init other values
 	bias_csp = 0;
-	proposedCodonSpecificParameter[dM].resize(numMutationCategories);
-	proposedCodonSpecificParameter[dOmega].resize(numSelectionCategories);
-	for (unsigned i = 0; i < numMutationCategories; i++)
-	{
-		proposedCodonSpecificParameter[dM][i] = currentCodonSpecificParameter[dM][i];
-	}
-	for (unsigned i = 0; i < numSelectionCategories; i++)
-	{
-		proposedCodonSpecificParameter[dOmega][i] = currentCodonSpecificParameter[dOmega][i];
-	}
+	currentCodonSpecificParameter.setParameterType(dM, mutationValues);
+	currentCodonSpecificParameter.setParameterType(dOmega, selectionValues);
+	proposedCodonSpecificParameter = currentCodonSpecificParameter;
 
 	groupList = { "A", "C", "D", "E", "F", "G", "H", "I", "K", "L", "N", "P", "Q", "R", "S", "T", "V", "Y", "Z" };
 	//groupList = { "C", "D", "E", "F", "H", "K", "M", "N", "Q", "W", "Y" };
@@ -298,7 +279,7 @@ void FONSEParameter::writeFONSERestartFile(std::string filename)
     for (unsigned i = 0; i < currentCodonSpecificParameter[dM].size(); i++)
     {
         oss << "***\n";
-        for (j = 0; j < currentCodonSpecificParameter[dM][i].size(); j++)
+        for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
         {
             oss << currentCodonSpecificParameter[dM][i][j];
             if ((j + 1) % 10 == 0)
@@ -314,7 +295,7 @@ void FONSEParameter::writeFONSERestartFile(std::string filename)
     for (unsigned i = 0; i < currentCodonSpecificParameter[dOmega].size(); i++)
     {
         oss << "***\n";
-        for (j = 0; j < currentCodonSpecificParameter[dOmega][i].size(); j++)
+        for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
         {
             oss << currentCodonSpecificParameter[dOmega][i][j];
             if ((j + 1) % 10 == 0)
@@ -443,6 +424,7 @@ void FONSEParameter::updateCodonSpecificParameterTrace(unsigned sample, std::str
 {
 	traces.updateCodonSpecificParameterTraceForAA(sample, grouping, currentCodonSpecificParameter[dM], dM);
 	traces.updateCodonSpecificParameterTraceForAA(sample, grouping, currentCodonSpecificParameter[dOmega], dOmega);
+	if (sample > 0u) updateCodonSpecificParameterCovariance(grouping);
 }
 
 
@@ -477,16 +459,13 @@ void FONSEParameter::proposeCodonSpecificParameter()
 {
     for (unsigned k = 0; k < getGroupListSize(); k++)
     {
-        std::vector<double> iidProposed;
         std::string aa = getGrouping(k);
 		unsigned aaStart;
 		unsigned aaEnd;
 		SequenceSummary::AAToCodonRange(aa, aaStart, aaEnd, true);
         unsigned numCodons = aaEnd - aaStart;
-        for (unsigned i = 0u; i < numCodons * (numMutationCategories + numSelectionCategories); i++)
-        {
-            iidProposed.push_back(randNorm(0.0, 1.0));
-        }
+        std::vector<double> iidProposed(numCodons * (numMutationCategories + numSelectionCategories));
+        randNormVector((unsigned)iidProposed.size(), 0.0, 1.0, iidProposed.data());
         
         std::vector<double> covaryingNums;
         covaryingNums = covarianceMatrix[SequenceSummary::AAToAAIndex(aa)].transformIidNumersIntoCovaryingNumbers(iidProposed);
@@ -517,20 +496,7 @@ void FONSEParameter::updateCodonSpecificParameter(std::string grouping)
     unsigned aaIndex = SequenceSummary::aaToIndex.find(grouping)->second;
 	numAcceptForCodonSpecificParameters[aaIndex]++;
     
-    for (unsigned k = 0u; k < numMutationCategories; k++)
-    {
-        for (unsigned i = aaStart; i < aaEnd; i++)
-        {
-            currentCodonSpecificParameter[dM][k][i] = proposedCodonSpecificParameter[dM][k][i];
-        }
-    }
-    for (unsigned k = 0u; k < numSelectionCategories; k++)
-    {
-        for (unsigned i = aaStart; i < aaEnd; i++)
-        {
-            currentCodonSpecificParameter[dOmega][k][i] = proposedCodonSpecificParameter[dOmega][k][i];
-        }
-    }
+    currentCodonSpecificParameter.copyCodonRange(proposedCodonSpecificParameter, aaStart, aaEnd);
 }
 
 
@@ -561,8 +527,7 @@ void FONSEParameter::setMutationPriorStandardDeviation(double _mutation_prior_sd
 void FONSEParameter::getParameterForCategory(unsigned category, unsigned paramType, std::string aa, bool proposal,
                                              double *returnSet)
 {
-    std::vector<double> *tempSet;
-	tempSet = proposal ? &proposedCodonSpecificParameter[paramType][category] : &currentCodonSpecificParameter[paramType][category];
+    double *tempSet = proposal ? proposedCodonSpecificParameter[paramType][category] : currentCodonSpecificParameter[paramType][category];
 	unsigned aaStart;
 	unsigned aaEnd;
 	SequenceSummary::AAToCodonRange(aa, aaStart, aaEnd, true);
@@ -570,7 +535,7 @@ void FONSEParameter::getParameterForCategory(unsigned category, unsigned paramTy
     unsigned j = 0u;
     for (unsigned i = aaStart; i < aaEnd; i++, j++)
     {
-        returnSet[j] = tempSet->at(i);
+        returnSet[j] = tempSet[i];
     }
 }
 
@@ -720,24 +685,24 @@ void FONSEParameter::initSelection(std::vector<double> selectionValues, unsigned
 
 std::vector< std::vector <double> > FONSEParameter::getCurrentMutationParameter()
 {
-    return currentCodonSpecificParameter[dM];
+    return currentCodonSpecificParameter.getParameterType(dM);
 }
 
 
 std::vector< std::vector <double> > FONSEParameter::getCurrentSelectionParameter()
 {
-    return currentCodonSpecificParameter[dOmega];
+    return currentCodonSpecificParameter.getParameterType(dOmega);
 }
 
 
 void FONSEParameter::setCurrentMutationParameter(std::vector<std::vector<double>> _currentMutationParameter)
 {
-	currentCodonSpecificParameter[dM] = _currentMutationParameter;
+	currentCodonSpecificParameter.setParameterType(dM, _currentMutationParameter);
 }
 
 
 void FONSEParameter::setCurrentSelectionParameter(std::vector<std::vector<double>> _currentSelectionParameter)
 {
-	currentCodonSpecificParameter[dOmega] = _currentSelectionParameter;
+	currentCodonSpecificParameter.setParameterType(dOmega, _currentSelectionParameter);
 }
 #endif
@@ -14,7 +14,9 @@ using namespace Rcpp;
 
 Genome::Genome()
 {
-	//ctor
+	genesWithAA.resize(22);
+	codonCountsForAA.resize(22);
+	numObservedSynthesisRateSets = 0u;
 }
 
 
@@ -24,6 +26,12 @@ Genome& Genome::operator=(const Genome& rhs)
 	genes = rhs.genes;
 	simulatedGenes = rhs.simulatedGenes;
 	numGenesWithPhi = rhs.numGenesWithPhi;
+	codonCountMatrix = rhs.codonCountMatrix;
+	genesWithAA = rhs.genesWithAA;
+	codonCountsForAA = rhs.codonCountsForAA;
+	numObservedSynthesisRateSets = rhs.numObservedSynthesisRateSets;
+	logObservedSynthesisRates = rhs.logObservedSynthesisRates;
+	observedSynthesisRateMask = rhs.observedSynthesisRateMask;
 	//assignment operator
 	return *this;
 }
@@ -569,6 +577,7 @@ void Genome::readObservedPhiValues(std::string filename, bool byId)
 			}//end of reading by index
 		}
 		input.close();
+		buildObservedSynthesisRateMatrix();
 	}
 }
 
@@ -584,7 +593,12 @@ void Genome::readObservedPhiValues(std::string filename, bool byId)
 void Genome::addGene(const Gene& gene, bool simulated)
 {
 	if (!simulated)
+	{
 		genes.push_back(gene);
+		codonCountMatrix.resize(genes.size() * 64);
+		addGeneToCodonCountTables((unsigned)genes.size() - 1);
+		addGeneToObservedSynthesisRateMatrix((unsigned)genes.size() - 1);
+	}
 	else
 		simulatedGenes.push_back(gene);
 }
@@ -641,6 +655,15 @@ void Genome::clear()
 	genes.clear();
 	simulatedGenes.clear();
 	numGenesWithPhi.clear();
+	codonCountMatrix.clear();
+	numObservedSynthesisRateSets = 0u;
+	logObservedSynthesisRates.clear();
+	observedSynthesisRateMask.clear();
+	for (unsigned aa = 0u; aa < 22; aa++)
+	{
+		genesWithAA[aa].clear();
+		codonCountsForAA[aa].clear();
+	}
 }
 
 
@@ -671,6 +694,130 @@ std::vector<unsigned> Genome::getCodonCountsPerGene(std::string codon)
 }
 
 
+// The codon count tables are kept up to date by addGene. Only needs to be called if genes are modified in place.
+void Genome::buildCodonCountMatrix()
+{
+	codonCountMatrix.resize(genes.size() * 64);
+	for (unsigned aa = 0u; aa < 22; aa++)
+	{
+		genesWithAA[aa].clear();
+		codonCountsForAA[aa].clear();
+	}
+	for (unsigned i = 0u; i < genes.size(); i++)
+	{
+		addGeneToCodonCountTables(i);
+	}
+}
+
+
+const unsigned* Genome::getCodonCountsForGene(unsigned geneIndex)
+{
+	return &codonCountMatrix[geneIndex * 64];
+}
+
+
+const std::vector<unsigned>& Genome::getGenesWithAA(unsigned aaIndex)
+{
+	return genesWithAA[aaIndex];
+}
+
+
+// Codon counts of the genes listed by getGenesWithAA, GetNumCodonsForAAIndex(aaIndex) values per gene.
+const unsigned* Genome::getCodonCountsForAA(unsigned aaIndex)
+{
+	return codonCountsForAA[aaIndex].data();
+}
+
+
+// The observed phi values as a dense matrix of their logs with a mask for missing values, so the likelihood
+// functions neither have to go through the genes nor call std::log every iteration. Values that are not
+// positive (missing values are stored as -1) are masked. Kept up to date by addGene and readObservedPhiValues,
+// only needs to be called if the observed values of a gene are modified in place.
+void Genome::buildObservedSynthesisRateMatrix()
+{
+	numObservedSynthesisRateSets = 0u;
+	for (unsigned i = 0u; i < genes.size(); i++)
+	{
+		unsigned numSets = genes[i].getNumObservedSynthesisSets();
+		if (numSets > numObservedSynthesisRateSets) numObservedSynthesisRateSets = numSets;
+	}
+	logObservedSynthesisRates.assign(genes.size() * numObservedSynthesisRateSets, 0.0);
+	observedSynthesisRateMask.assign(genes.size() * numObservedSynthesisRateSets, 0u);
+	for (unsigned i = 0u; i < genes.size(); i++)
+	{
+		std::vector<double> &values = genes[i].observedSynthesisRateValues;
+		for (unsigned j = 0u; j < values.size(); j++)
+		{
+			if (values[j] > 0.0)
+			{
+				logObservedSynthesisRates[i * numObservedSynthesisRateSets + j] = std::log(values[j]);
+				observedSynthesisRateMask[i * numObservedSynthesisRateSets + j] = 1u;
+			}
+		}
+	}
+}
+
+
+unsigned Genome::getNumObservedSynthesisRateSets()
+{
+	return numObservedSynthesisRateSets;
+}
+
+
+// getNumObservedSynthesisRateSets() values per gene, see buildObservedSynthesisRateMatrix.
+const double* Genome::getLogObservedSynthesisRates()
+{
+	return logObservedSynthesisRates.data();
+}
+
+
+const unsigned char* Genome::getObservedSynthesisRateMask()
+{
+	return observedSynthesisRateMask.data();
+}
+
+
+void Genome::addGeneToCodonCountTables(unsigned geneIndex)
+{
+	SequenceSummary *seqsum = genes[geneIndex].getSequenceSummary();
+	for (unsigned i = 0u; i < 64; i++)
+	{
+		codonCountMatrix[geneIndex * 64 + i] = seqsum->getCodonCountForCodon(i);
+	}
+	for (unsigned aa = 0u; aa < 22; aa++)
+	{
+		if (seqsum->getAACountForAA(aa) == 0) continue;
+		genesWithAA[aa].push_back(geneIndex);
+		for (unsigned i = SequenceSummary::codonRangeForAAIndex[aa][0]; i < SequenceSummary::codonRangeForAAIndex[aa][1]; i++)
+		{
+			codonCountsForAA[aa].push_back(seqsum->getCodonCountForCodon(i));
+		}
+	}
+}
+
+
+void Genome::addGeneToObservedSynthesisRateMatrix(unsigned geneIndex)
+{
+	std::vector<double> &values = genes[geneIndex].observedSynthesisRateValues;
+	if (values.size() > numObservedSynthesisRateSets)
+	{
+		// the gene has more phi sets than the genes before, the layout of the matrix changes
+		buildObservedSynthesisRateMatrix();
+		return;
+	}
+	logObservedSynthesisRates.resize(genes.size() * numObservedSynthesisRateSets, 0.0);
+	observedSynthesisRateMask.resize(genes.size() * numObservedSynthesisRateSets, 0u);
+	for (unsigned j = 0u; j < values.size(); j++)
+	{
+		if (values[j] > 0.0)
+		{
+			logObservedSynthesisRates[geneIndex * numObservedSynthesisRateSets + j] = std::log(values[j]);
+			observedSynthesisRateMask[geneIndex * numObservedSynthesisRateSets + j] = 1u;
+		}
+	}
+}
+
+
 
 
 
@@ -1,5 +1,9 @@
 #include "include/MCMCAlgorithm.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 
 //R runs only
 #ifndef STANDALONE
@@ -22,6 +26,11 @@ using namespace Rcpp;
 
 
 
+const unsigned MCMCAlgorithm::gewekeLogLikelihood = 1u;
+const unsigned MCMCAlgorithm::gewekeCodonSpecificParameters = 2u;
+
+
+
 
 //--------------------------------------------------//
 //----------- Constructors & Destructors -----------//
@@ -39,7 +48,15 @@ MCMCAlgorithm::MCMCAlgorithm() : samples(1000), thining(1), adaptiveWidth(100 *
 	lastConvergenceTest = 0u;
 
 	estimateMixtureAssignment = true;
+	parallelSynthesisRateSweep = false;
+	blockedCodonSpecificParameterUpdate = false;
+	fusedIteration = false;
+	fusedIterationActive = false;
 	stepsToAdapt = -1;
+	convergenceDiagnostics = 0u;
+	convergenceThreshold = 1.96;
+	minimumConvergenceSamples = 0u;
+	converged = false;
 }
 
 
@@ -56,7 +73,15 @@ MCMCAlgorithm::MCMCAlgorithm(unsigned _samples, unsigned _thining, unsigned _ada
 	fileWriteInterval = 1u;
 	lastConvergenceTest = 0u;
 	estimateMixtureAssignment = true;
+	parallelSynthesisRateSweep = false;
+	blockedCodonSpecificParameterUpdate = false;
+	fusedIteration = false;
+	fusedIterationActive = false;
 	stepsToAdapt = -1;
+	convergenceDiagnostics = 0u;
+	convergenceThreshold = 1.96;
+	minimumConvergenceSamples = 0u;
+	converged = false;
 }
 
 
@@ -74,7 +99,38 @@ MCMCAlgorithm::~MCMCAlgorithm()
 //----------------------------------------------------//
 
 
-double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome, Model& model, int iteration)
+// Sizes the working memory of the synthesis rate sweeps. The numbers of genes, categories and mixtures
+// do not change during a run, so this only allocates on the first sweep and the sweeps themselves run
+// without any allocation.
+void MCMCAlgorithm::prepareSweepScratch(unsigned numGenes, unsigned numSynthesisRateCategories, unsigned numMixtures,
+		unsigned numThreads)
+{
+	if (sweepScratch.size() >= numThreads && geneLogLikelihood.size() == numGenes
+		&& acceptanceDraws.size() == numGenes * numSynthesisRateCategories
+		&& categoryProbabilities.size() == numMixtures && sweepScratch[0].probabilities.size() == numMixtures
+		&& sweepScratch[0].unscaledLogProb_curr.size() == numSynthesisRateCategories)
+		return;
+
+	sweepScratch.resize(numThreads);
+	for (unsigned t = 0u; t < numThreads; t++)
+	{
+		sweepScratch[t].unscaledLogProb_curr.assign(numSynthesisRateCategories, 0.0);
+		sweepScratch[t].unscaledLogProb_prop.assign(numSynthesisRateCategories, 0.0);
+		sweepScratch[t].unscaledLogPost_curr.assign(numSynthesisRateCategories, 0.0);
+		sweepScratch[t].unscaledLogPost_prop.assign(numSynthesisRateCategories, 0.0);
+		sweepScratch[t].unscaledLogProb_curr_singleMixture.assign(numMixtures, 0.0);
+		sweepScratch[t].probabilities.assign(numMixtures, 0.0);
+		sweepScratch[t].dirichletParameters.assign(numMixtures, 0.0);
+	}
+	acceptanceDraws.assign(numGenes * numSynthesisRateCategories, 0.0);
+	mixtureDraws.assign(numGenes, 0.0);
+	geneLogLikelihood.assign(numGenes, 0.0);
+	categoryProbabilities.assign(numMixtures, 0.0);
+	newMixtureProbabilities.assign(numMixtures, 0.0);
+}
+
+
+double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome, Model& model, int iteration, bool fused)
 {
     //FILE * pFile;
     //pFile = fopen ("/home/clandere/Desktop/myfile.txt","a");
@@ -86,13 +142,21 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
 
 	unsigned numSynthesisRateCategories = model.getNumSynthesisRateCategories();
 	unsigned numMixtures = model.getNumMixtureElements();
-	double* dirichletParameters = new double[numMixtures]();
+	prepareSweepScratch((unsigned)numGenes, numSynthesisRateCategories, numMixtures, 1u);
+	SweepScratch &scratch = sweepScratch[0];
+	double* dirichletParameters = scratch.dirichletParameters.data();
 
 
 	for (unsigned i = 0u; i < numMixtures; i++) {
 		dirichletParameters[i] = 0.0;
 	}
 
+	// the random numbers of the whole sweep are drawn up front in two blocks
+	Parameter::randExpVector((unsigned)acceptanceDraws.size(), 1.0, acceptanceDraws.data());
+	Parameter::randUnifVector((unsigned)numGenes, 0.0, 1.0, mixtureDraws.data());
+	unsigned numGroupings = model.getGroupListSize();
+	unsigned fusedStride = 2 * numGroupings + model.getNumHyperParameterLogRatios();
+
 	//initialize parameter's size
 	for(int i = 0; i < numGenes; i++)
 	{
@@ -113,15 +177,15 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
 		double maxValue = -1000000.0;
 		unsigned mixtureIndex = 0u;
 
-		double* unscaledLogProb_curr = new double[numSynthesisRateCategories]();
-		double* unscaledLogProb_prop = new double[numSynthesisRateCategories]();
+		double* unscaledLogProb_curr = scratch.unscaledLogProb_curr.data();
+		double* unscaledLogProb_prop = scratch.unscaledLogProb_prop.data();
 
-		double* unscaledLogPost_curr = new double[numSynthesisRateCategories]();
-		double* unscaledLogPost_prop = new double[numSynthesisRateCategories]();
+		double* unscaledLogPost_curr = scratch.unscaledLogPost_curr.data();
+		double* unscaledLogPost_prop = scratch.unscaledLogPost_prop.data();
 
 
-		double* unscaledLogProb_curr_singleMixture = new double[numMixtures]();
-		double* probabilities = new double[numMixtures]();
+		double* unscaledLogProb_curr_singleMixture = scratch.unscaledLogProb_curr_singleMixture.data();
+		double* probabilities = scratch.probabilities.data();
 
 		for (unsigned j = 0u; j < numMixtures; j++)
 		{
@@ -141,7 +205,7 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
 		{
 			// logProbabilityRatio contains the logProbabilityRatio in element 0,
 			// the current unscaled probability in element 1 and the proposed unscaled probability in element 2
-			std::vector<unsigned> mixtureElements = model.getMixtureElementsOfSelectionCategory(k);
+			std::vector<unsigned> &mixtureElements = model.getMixtureElementsOfSelectionCategory(k);
 			for(unsigned n = 0u; n < mixtureElements.size(); n++)
 			{
 				unsigned mixtureElement = mixtureElements[n];
@@ -186,22 +250,19 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
 			// We do not need to add std::log(model.getCategoryProbability(k)) since it will cancel in the ratio!
 			double currLogLike = unscaledLogProb_curr[k];
 			double propLogLike = unscaledLogProb_prop[k];
-			if( -Parameter::randExp(1) < (propLogLike - currLogLike) )
+			// an accepted proposal is applied on every iteration, not only on the ones that are written to the trace
+			if( -acceptanceDraws[i * numSynthesisRateCategories + k] < (propLogLike - currLogLike) )
 			{
-                if((iteration % thining) == 0)
-                    //fprintf (pFile, "%f\t%s\n",(propLogLike - currLogLike), "TRUE");
-                if(estimateSynthesisRate){
-				    model.updateSynthesisRate(i, k);
-                    //logLikelihood += model.getCategoryProbability(k) * unscaledLogPost_prop[k];
-                    logLikelihood += probabilities[k] * unscaledLogPost_prop[k];                    
-                }else{
-                    logLikelihood += probabilities[k] * unscaledLogPost_curr[k]; // if phi is not estimatedd, it will always stay curr!    
-                }
+				if(estimateSynthesisRate){
+					model.updateSynthesisRate(i, k);
+					//logLikelihood += model.getCategoryProbability(k) * unscaledLogPost_prop[k];
+					logLikelihood += probabilities[k] * unscaledLogPost_prop[k];
+				}else{
+					logLikelihood += probabilities[k] * unscaledLogPost_curr[k]; // if phi is not estimatedd, it will always stay curr!
+				}
 			}else{
-                if((iteration % thining) == 0)
-                   // fprintf (pFile, "%f\t%s\n",(propLogLike - currLogLike), "FALSE");
 				//logLikelihood += model.getCategoryProbability(k) * unscaledLogPost_curr[k];
-                logLikelihood += probabilities[k] * unscaledLogPost_curr[k];
+				logLikelihood += probabilities[k] * unscaledLogPost_curr[k];
 			}
 		}
 
@@ -216,30 +277,29 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
 
 		// Get category in which the gene is placed in.
 		// If we use multiple sequence observation (like different mutants) randMultinom needs a parameter N to place N observations in numMixture buckets
-		unsigned categoryOfGene = Parameter::randMultinom(probabilities, numMixtures);
+		unsigned categoryOfGene = Parameter::randMultinom(probabilities, numMixtures, mixtureDraws[i]);
 		if(estimateMixtureAssignment)
 		{
 			model.setMixtureAssignment(i, categoryOfGene);
 		}
 
 		dirichletParameters[categoryOfGene] += 1;
+		if (fused)
+		{
+			// the gene is added to the ratios of the codon specific and hyper parameters with its new phi and mixture element
+			double *chunkLogRatios = &fusedLogRatios[(i / sweepChunkSize) * fusedStride];
+			model.addGeneToFusedLogRatios(*gene, i, chunkLogRatios, chunkLogRatios + 2 * numGroupings);
+		}
 		if((iteration % thining) == 0)
 		{
 			model.updateSynthesisRateTrace(iteration/thining, i);
 			model.updateMixtureAssignmentTrace(iteration/thining, i);
 		}
-		delete[] probabilities;
-		delete[] unscaledLogProb_curr_singleMixture;
-		delete[] unscaledLogProb_prop;
-		delete[] unscaledLogProb_curr;
-		delete[] unscaledLogPost_prop;
-		delete[] unscaledLogPost_curr;
 	}
 
 	// take all priors into account
 	logLikelihood += model.calculateAllPriors();
-	double *newMixtureProbabilities = new double[numMixtures]();
-	Parameter::randDirichlet(dirichletParameters, numMixtures, newMixtureProbabilities);
+	Parameter::randDirichlet(dirichletParameters, numMixtures, newMixtureProbabilities.data());
 	for(unsigned k = 0u; k < numMixtures; k++)
 	{
 		model.setCategoryProbability(k, newMixtureProbabilities[k]);
@@ -251,24 +311,232 @@ double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenes(Genome& genome,
         //fprintf (pFile, "%f\t%f\n",logLikelihood,logLikelihood2);
 	}
     //fclose (pFile);
-	delete[] dirichletParameters;
-	delete[] newMixtureProbabilities;
+	return logLikelihood;
+}
+
+
+// Gene-parallel version of acceptRejectSynthesisRateLevelForAllGenes.
+// Given the codon specific parameters and the mixture probabilities, the accept/reject step and the mixture
+// draw of a gene are independent of all other genes, so the gene loop itself is distributed over the threads.
+// Every gene draws from its own counter-based stream addressed by (sweep seed, iteration, gene), with the
+// sweep seed drawn from the global generator so the user's seed still controls the run. Each thread keeps its
+// own Dirichlet counts, and the per gene log likelihoods are summed in gene order after the loop, so the
+// result does not depend on the number of threads or the schedule.
+double MCMCAlgorithm::acceptRejectSynthesisRateLevelForAllGenesInParallel(Genome& genome, Model& model, int iteration, bool fused)
+{
+	int numGenes = genome.getGenomeSize();
+
+	unsigned numSynthesisRateCategories = model.getNumSynthesisRateCategories();
+	unsigned numMixtures = model.getNumMixtureElements();
+	unsigned numThreads = 1u;
+#ifndef __APPLE__
+	numThreads = (unsigned)omp_get_max_threads();
+#endif
+
+	prepareSweepScratch((unsigned)numGenes, numSynthesisRateCategories, numMixtures, numThreads);
+	for (unsigned k = 0u; k < numMixtures; k++)
+	{
+		categoryProbabilities[k] = model.getCategoryProbability(k);
+	}
+	for (unsigned t = 0u; t < numThreads; t++)
+	{
+		std::fill(sweepScratch[t].dirichletParameters.begin(), sweepScratch[t].dirichletParameters.end(), 0.0);
+	}
+
+	uint64_t sweepSeed = (uint64_t)(Parameter::randUnif(0.0, 1.0) * 9007199254740992.0);
+	unsigned numGroupings = model.getGroupListSize();
+	unsigned fusedStride = 2 * numGroupings + model.getNumHyperParameterLogRatios();
+
+#ifndef __APPLE__
+#pragma omp parallel
+#endif
+	{
+		unsigned thread = 0u;
+#ifndef __APPLE__
+		thread = (unsigned)omp_get_thread_num();
+#endif
+
+		SweepScratch &scratch = sweepScratch[thread];
+		std::vector<double> &unscaledLogProb_curr = scratch.unscaledLogProb_curr;
+		std::vector<double> &unscaledLogProb_prop = scratch.unscaledLogProb_prop;
+		std::vector<double> &unscaledLogPost_curr = scratch.unscaledLogPost_curr;
+		std::vector<double> &unscaledLogPost_prop = scratch.unscaledLogPost_prop;
+		std::vector<double> &unscaledLogProb_curr_singleMixture = scratch.unscaledLogProb_curr_singleMixture;
+		std::vector<double> &probabilities = scratch.probabilities;
+
+		// every chunk of sweepChunkSize genes is handled by one thread in gene order, so the fused partial sums
+		// of a chunk do not depend on the number of threads
+#ifndef __APPLE__
+#pragma omp for schedule(static, sweepChunkSize)
+#endif
+		for (int i = 0; i < numGenes; i++)
+		{
+			Gene *gene = &genome.getGene(i);
+			RandomStream generator(sweepSeed, (uint32_t)iteration, (uint32_t)i);
+
+			// see acceptRejectSynthesisRateLevelForAllGenes for the scaling by maxValue
+			double maxValue = -1000000.0;
+			unsigned mixtureIndex = 0u;
+			for (unsigned k = 0u; k < numSynthesisRateCategories; k++)
+			{
+				unscaledLogProb_curr[k] = 0.0;
+				unscaledLogProb_prop[k] = 0.0;
+				unscaledLogPost_curr[k] = 0.0;
+				unscaledLogPost_prop[k] = 0.0;
+
+				std::vector<unsigned> &mixtureElements = model.getMixtureElementsOfSelectionCategory(k);
+				for (unsigned n = 0u; n < mixtureElements.size(); n++)
+				{
+					double logProbabilityRatio[5];
+					model.calculateLogLikelihoodRatioPerGene(*gene, i, mixtureElements[n], logProbabilityRatio);
+
+					unscaledLogProb_curr[k] += logProbabilityRatio[1];
+					unscaledLogProb_prop[k] += logProbabilityRatio[2];
+					unscaledLogPost_curr[k] += logProbabilityRatio[3];
+					unscaledLogPost_prop[k] += logProbabilityRatio[4];
+
+					unscaledLogProb_curr_singleMixture[mixtureIndex] = logProbabilityRatio[3];
+					maxValue = logProbabilityRatio[3] > maxValue ? logProbabilityRatio[3] : maxValue;
+					mixtureIndex++;
+				}
+			}
+
+			double normalizingProbabilityConstant = 0.0;
+			for (unsigned k = 0u; k < numMixtures; k++)
+			{
+				probabilities[k] = categoryProbabilities[k] * std::exp(unscaledLogProb_curr_singleMixture[k] - maxValue);
+				normalizingProbabilityConstant += probabilities[k];
+			}
+			for (unsigned k = 0u; k < numMixtures; k++)
+			{
+				probabilities[k] = probabilities[k] / normalizingProbabilityConstant;
+			}
+
+			double logLikelihood = 0.0;
+			for (unsigned k = 0u; k < numSynthesisRateCategories; k++)
+			{
+				if (estimateSynthesisRate && -generator.nextExp() < (unscaledLogProb_prop[k] - unscaledLogProb_curr[k]))
+				{
+					model.updateSynthesisRate(i, k);
+					logLikelihood += probabilities[k] * unscaledLogPost_prop[k];
+				}
+				else
+				{
+					logLikelihood += probabilities[k] * unscaledLogPost_curr[k];
+				}
+			}
+			geneLogLikelihood[i] = logLikelihood;
+
+			// same draw as Parameter::randMultinom, but from the thread's stream
+			double referenceValue = generator.nextUnif();
+			double cumsum = 0.0;
+			unsigned categoryOfGene = 0u;
+			for (unsigned k = 0u; k < numMixtures; k++)
+			{
+				cumsum += probabilities[k];
+				if (referenceValue <= cumsum)
+				{
+					categoryOfGene = k;
+					break;
+				}
+			}
+			if (estimateMixtureAssignment)
+			{
+				model.setMixtureAssignment(i, categoryOfGene);
+			}
+			scratch.dirichletParameters[categoryOfGene] += 1;
+			if (fused)
+			{
+				double *chunkLogRatios = &fusedLogRatios[(i / sweepChunkSize) * fusedStride];
+				model.addGeneToFusedLogRatios(*gene, i, chunkLogRatios, chunkLogRatios + 2 * numGroupings);
+			}
+
+			if ((iteration % thining) == 0)
+			{
+				model.updateSynthesisRateTrace(iteration/thining, i);
+				model.updateMixtureAssignmentTrace(iteration/thining, i);
+			}
+		}
+	}
+
+	double logLikelihood = 0.0;
+	for (int i = 0; i < numGenes; i++)
+	{
+		logLikelihood += geneLogLikelihood[i];
+		if (std::isinf(geneLogLikelihood[i]))
+		{
+#ifndef STANDALONE
+			Rprintf("\tInfinity reached (Gene: %d)\n", i);
+#else
+			std::cout << "\tInfinity reached (Gene: " << i << ")\n";
+#endif
+		}
+	}
+
+	// the counts of all threads are summed into the ones of thread 0
+	double* dirichletParameters = sweepScratch[0].dirichletParameters.data();
+	for (unsigned t = 1u; t < numThreads; t++)
+	{
+		for (unsigned k = 0u; k < numMixtures; k++)
+		{
+			dirichletParameters[k] += sweepScratch[t].dirichletParameters[k];
+		}
+	}
+
+	// take all priors into account
+	logLikelihood += model.calculateAllPriors();
+	Parameter::randDirichlet(dirichletParameters, numMixtures, newMixtureProbabilities.data());
+	for (unsigned k = 0u; k < numMixtures; k++)
+	{
+		model.setCategoryProbability(k, newMixtureProbabilities[k]);
+	}
+	if ((iteration % thining) == 0)
+	{
+		model.updateMixtureProbabilitiesTrace(iteration/thining);
+	}
 	return logLikelihood;
 }
 
 
 void MCMCAlgorithm::acceptRejectCodonSpecificParameter(Genome& genome, Model& model, int iteration)
 {
-	double acceptanceRatioForAllMixtures = 0.0;
 	unsigned size = model.getGroupListSize();
 
-	for(unsigned i = 0; i < size; i++)
+	// The groupings do not share parameters and their likelihoods only depend on phi and the mixture
+	// assignments, so all ratios can be calculated before any grouping is accepted. In blocked mode they
+	// are evaluated in one pass over the genome.
+	std::vector<double> acceptanceRatios(size, 0.0);
+	if (blockedCodonSpecificParameterUpdate)
 	{
-		std::string grouping = model.getGrouping(i);
+		model.calculateLogLikelihoodRatioForAllGroupings(genome, acceptanceRatios);
+	}
+	else
+	{
+		for(unsigned i = 0; i < size; i++)
+		{
+			// calculate likelihood ratio for every Category for current AA
+			model.calculateLogLikelihoodRatioPerGroupingPerCategory(model.getGrouping(i), genome, acceptanceRatios[i]);
+		}
+	}
+	acceptCodonSpecificParameters(model, iteration, acceptanceRatios);
+}
+
+
+void MCMCAlgorithm::acceptRejectHyperParameter(Genome &genome, Model& model, int iteration)
+{
+	std::vector <double> logProbabilityRatios;
 
-		// calculate likelihood ratio for every Category for current AA
-		model.calculateLogLikelihoodRatioPerGroupingPerCategory(grouping, genome, acceptanceRatioForAllMixtures);
-		if( -Parameter::randExp(1) < acceptanceRatioForAllMixtures )
+	model.calculateLogLikelihoodRatioForHyperParameters(genome, iteration, logProbabilityRatios);
+	acceptHyperParameters(model, iteration, logProbabilityRatios);
+}
+
+
+void MCMCAlgorithm::acceptCodonSpecificParameters(Model& model, int iteration, std::vector<double> &logAcceptanceRatios)
+{
+	for(unsigned i = 0; i < logAcceptanceRatios.size(); i++)
+	{
+		std::string grouping = model.getGrouping(i);
+		if( -Parameter::randExp(1) < logAcceptanceRatios[i] )
 		{
 			// moves proposed codon specific parameters to current codon specific parameters
 			model.updateCodonSpecificParameter(grouping);
@@ -281,12 +549,8 @@ void MCMCAlgorithm::acceptRejectCodonSpecificParameter(Genome& genome, Model& mo
 }
 
 
-void MCMCAlgorithm::acceptRejectHyperParameter(Genome &genome, Model& model, int iteration)
+void MCMCAlgorithm::acceptHyperParameters(Model& model, int iteration, std::vector<double> &logProbabilityRatios)
 {
-	std::vector <double> logProbabilityRatios;
-
-	model.calculateLogLikelihoodRatioForHyperParameters(genome, iteration, logProbabilityRatios);
-
 	for (unsigned i = 0; i < logProbabilityRatios.size(); i++)
 	{
 		if (!std::isfinite(logProbabilityRatios[i]))
@@ -311,6 +575,54 @@ void MCMCAlgorithm::acceptRejectHyperParameter(Genome &genome, Model& model, int
 }
 
 
+// All update steps of an iteration in one pass over the genome (see setFusedIteration). Every gene is visited once:
+// its synthesis rate and mixture element are updated given the current codon specific and hyper parameters, then
+// the gene is added to the log ratios of the proposed codon specific and hyper parameters, which are accepted or
+// rejected after the pass. This is the regular scan (codon specific, hyper, phi and mixture) started one step later.
+// The codon specific and hyper parameters are independent given phi and the mixture assignments, so accepting them
+// after the same pass is a valid Metropolis-within-Gibbs step. The Gibbs sampled hyper parameters come last.
+double MCMCAlgorithm::acceptRejectFusedIteration(Genome& genome, Model& model, int iteration)
+{
+	unsigned numGroupings = model.getGroupListSize();
+	unsigned numHyperParameterLogRatios = model.getNumHyperParameterLogRatios();
+	unsigned fusedStride = 2 * numGroupings + numHyperParameterLogRatios;
+	unsigned numChunks = (genome.getGenomeSize() + sweepChunkSize - 1) / sweepChunkSize;
+
+	model.proposeCodonSpecificParameter();
+	model.proposeHyperParameters();
+	model.proposeSynthesisRateLevels();
+	model.prepareFusedIteration(genome);
+	fusedLogRatios.assign(numChunks * fusedStride, 0.0);
+
+	double logLikelihood = parallelSynthesisRateSweep ? acceptRejectSynthesisRateLevelForAllGenesInParallel(genome, model, iteration, true)
+		: acceptRejectSynthesisRateLevelForAllGenes(genome, model, iteration, true);
+
+	// the partial sums of the chunks are added up in chunk order
+	std::vector<double> codonSpecificLogLikelihoods(2 * numGroupings, 0.0);
+	std::vector<double> hyperParameterLogRatios(numHyperParameterLogRatios, 0.0);
+	for (unsigned c = 0u; c < numChunks; c++)
+	{
+		double *chunkLogRatios = &fusedLogRatios[c * fusedStride];
+		for (unsigned j = 0u; j < 2 * numGroupings; j++)
+		{
+			codonSpecificLogLikelihoods[j] += chunkLogRatios[j];
+		}
+		for (unsigned j = 0u; j < numHyperParameterLogRatios; j++)
+		{
+			hyperParameterLogRatios[j] += chunkLogRatios[2 * numGroupings + j];
+		}
+	}
+
+	std::vector<double> codonSpecificLogRatios;
+	model.completeFusedLogRatios(codonSpecificLogLikelihoods, codonSpecificLogRatios, hyperParameterLogRatios);
+	acceptCodonSpecificParameters(model, iteration, codonSpecificLogRatios);
+	acceptHyperParameters(model, iteration, hyperParameterLogRatios);
+	model.updateGibbsSampledHyperParameters(genome);
+
+	return logLikelihood;
+}
+
+
 
 
 
@@ -319,12 +631,10 @@ void MCMCAlgorithm::acceptRejectHyperParameter(Genome &genome, Model& model, int
 //------------------------------------//
 
 
-void MCMCAlgorithm::run(Genome& genome, Model& model, unsigned numCores, unsigned divergenceIterations)
+// Everything run does before the first iteration. Split from run so MultiChainMCMC can interleave the
+// iterations of several chains. The genome's observed synthesis rate matrix has to be built beforehand.
+void MCMCAlgorithm::initializeRun(Genome& genome, Model& model, unsigned divergenceIterations)
 {
-#ifndef __APPLE__
-	omp_set_num_threads(numCores);
-#endif
-
 	// Allows to diverge from initial conditions (divergenceIterations controls the divergence).
 	// This allows for varying initial conditions for better exploration of the parameter space.
 	varyInitialConditions(genome, model, divergenceIterations);
@@ -359,126 +669,181 @@ void MCMCAlgorithm::run(Genome& genome, Model& model, unsigned numCores, unsigne
 #endif
 
 
+	fusedIterationActive = fusedIteration && estimateCodonSpecificParameter && estimateHyperParameter
+		&& (estimateSynthesisRate || estimateMixtureAssignment) && model.isFusedIterationSupported();
+	if (fusedIteration && !fusedIterationActive)
+	{
+#ifndef STANDALONE
+		Rprintf("Fused iteration not available for this model or these settings, running the regular iteration\n");
+#else
+		std::cout << "Fused iteration not available for this model or these settings, running the regular iteration\n";
+#endif
+	}
+
 	// set the last iteration to the max iterations, this way if the MCMC doesn't exit based on Geweke score, it will use the max iteration for posterior means
 	model.setLastIteration(samples);
-	for(unsigned iteration = 1u; iteration <= maximumIterations; iteration++)
+	converged = false;
+	lastConvergenceTest = 0u;
+	likelihoodStatistics.clear();
+	likelihoodStatistics.reserve(samples);
+}
+
+
+// One iteration of the MCMC loop. Returns false if the run has to stop, because the log likelihood became NaN or the
+// convergence criteria (see setConvergenceCriteria) are met.
+bool MCMCAlgorithm::runIteration(Genome& genome, Model& model, unsigned iteration)
+{
+	if (writeRestartFile)
 	{
-		if (writeRestartFile)
+		if ((iteration) % fileWriteInterval  == 0u)
 		{
-			if ((iteration) % fileWriteInterval  == 0u)
-			{
 #ifndef STANDALONE
-				Rprintf("Writing restart file!\n");
+			Rprintf("Writing restart file!\n");
 #else
-				std::cout << "Writing restart file!\n";
+			std::cout << "Writing restart file!\n";
 #endif
-				if (multipleFiles)
-				{
-					std::ostringstream oss;
-					oss << (iteration) / thining << "_" << file;
-					std::string tmp = oss.str();
-					model.writeRestartFile(tmp);
-				}
-				else
-				{
-					model.writeRestartFile(file);
-				}
-			}
-		}
-		if( (iteration) % 100u == 0u)
-		{
-#ifndef STANDALONE
-			Rprintf("Status at iteration %d \n", iteration);
-			Rprintf("\t current logLikelihood: %f \n", likelihoodTrace[(iteration/thining) - 1] );
-			if (iteration > stepsToAdapt)
+			if (multipleFiles)
 			{
-				Rprintf("No longer adapting\n");
+				std::ostringstream oss;
+				oss << (iteration) / thining << "_" << file;
+				std::string tmp = oss.str();
+				model.writeRestartFile(tmp);
 			}
-#else
-			std::cout << "Status at iteration " << (iteration) << std::endl;
-			std::cout << "\t current logLikelihood: " << likelihoodTrace[(iteration/thining) - 1] << std::endl;
-			if (iteration > stepsToAdapt)
+			else
 			{
-				std::cout <<"No longer adapting\n";
+				model.writeRestartFile(file);
 			}
+		}
+	}
+	if( (iteration) % 100u == 0u)
+	{
+#ifndef STANDALONE
+		Rprintf("Status at iteration %d \n", iteration);
+		Rprintf("\t current logLikelihood: %f \n", likelihoodTrace[(iteration/thining) - 1] );
+		if (iteration > stepsToAdapt)
+		{
+			Rprintf("No longer adapting\n");
+		}
+#else
+		std::cout << "Status at iteration " << (iteration) << std::endl;
+		std::cout << "\t current logLikelihood: " << likelihoodTrace[(iteration/thining) - 1] << std::endl;
+		if (iteration > stepsToAdapt)
+		{
+			std::cout <<"No longer adapting\n";
+		}
 #endif
-			model.printHyperParameters();
-			for(unsigned i = 0u; i < model.getNumMixtureElements(); i++)
-			{
+		model.printHyperParameters();
+		for(unsigned i = 0u; i < model.getNumMixtureElements(); i++)
+		{
 #ifndef STANDALONE
-				Rprintf("\t current Mixture element probability for element %d: %f\n", i, model.getCategoryProbability(i));
+			Rprintf("\t current Mixture element probability for element %d: %f\n", i, model.getCategoryProbability(i));
 #else
-				std::cout << "\t current Mixture element probability for element " << i << ": " << model.getCategoryProbability(i) << std::endl;
+			std::cout << "\t current Mixture element probability for element " << i << ": " << model.getCategoryProbability(i) << std::endl;
 #endif
-			}
 		}
-		if(estimateCodonSpecificParameter)
+	}
+	if(estimateCodonSpecificParameter && !fusedIterationActive)
+	{
+		model.proposeCodonSpecificParameter();
+		acceptRejectCodonSpecificParameter(genome, model, iteration);
+		if(( (iteration) % adaptiveWidth) == 0u)
 		{
-			model.proposeCodonSpecificParameter();
-			acceptRejectCodonSpecificParameter(genome, model, iteration);
-			if(( (iteration) % adaptiveWidth) == 0u)
-			{
-				model.adaptCodonSpecificParameterProposalWidth(adaptiveWidth, iteration / thining, iteration <= stepsToAdapt);
-			}
+			model.adaptCodonSpecificParameterProposalWidth(adaptiveWidth, iteration / thining, iteration <= stepsToAdapt);
+		}
+	}
+	// update hyper parameter
+	if(estimateHyperParameter && !fusedIterationActive)
+	{
+		model.updateGibbsSampledHyperParameters(genome);
+		model.proposeHyperParameters();
+		acceptRejectHyperParameter(genome, model, iteration);
+		if(( (iteration) % adaptiveWidth) == 0u)
+		{
+			model.adaptHyperParameterProposalWidths(adaptiveWidth, iteration <= stepsToAdapt);
 		}
-		// update hyper parameter
-		if(estimateHyperParameter)
+	}
+	// update expression level values
+	if(estimateSynthesisRate || estimateMixtureAssignment)
+	{
+		double logLike;
+		if (fusedIterationActive)
 		{
-			model.updateGibbsSampledHyperParameters(genome);
-			model.proposeHyperParameters();
-			acceptRejectHyperParameter(genome, model, iteration);
-			if(( (iteration) % adaptiveWidth) == 0u)
-			{
-				model.adaptHyperParameterProposalWidths(adaptiveWidth, iteration <= stepsToAdapt);
-			}
+			logLike = acceptRejectFusedIteration(genome, model, iteration);
 		}
-		// update expression level values
-		if(estimateSynthesisRate || estimateMixtureAssignment)
+		else
 		{
 			model.proposeSynthesisRateLevels();
-			double logLike = acceptRejectSynthesisRateLevelForAllGenes(genome, model, iteration);
-			if((iteration % thining) == 0u)
-			{
-				likelihoodTrace[(iteration / thining)] = logLike;
-				if (std::isnan(logLike)) {
-					std::cerr << "Log likelihood is NaN, exiting at iteration " << iteration << std::endl;
-					model.setLastIteration(iteration / thining);
-					return;
-				}
+			logLike = parallelSynthesisRateSweep ? acceptRejectSynthesisRateLevelForAllGenesInParallel(genome, model, iteration)
+				: acceptRejectSynthesisRateLevelForAllGenes(genome, model, iteration);
+		}
+		if((iteration % thining) == 0u)
+		{
+			likelihoodTrace[(iteration / thining)] = logLike;
+			if (std::isnan(logLike)) {
+				std::cerr << "Log likelihood is NaN, exiting at iteration " << iteration << std::endl;
+				model.setLastIteration(iteration / thining);
+				return false;
 			}
-			if(( (iteration) % adaptiveWidth) == 0u)
+			likelihoodStatistics.add(logLike);
+		}
+		if(( (iteration) % adaptiveWidth) == 0u)
+		{
+			// initializeRun has replaced the -1 default of stepsToAdapt, so it is not negative here
+			bool adapt = iteration <= (unsigned)stepsToAdapt;
+			model.adaptSynthesisRateProposalWidth(adaptiveWidth, adapt);
+			if (fusedIterationActive)
 			{
-				model.adaptSynthesisRateProposalWidth(adaptiveWidth, iteration <= stepsToAdapt);
+				model.adaptCodonSpecificParameterProposalWidth(adaptiveWidth, iteration / thining, adapt);
+				model.adaptHyperParameterProposalWidths(adaptiveWidth, adapt);
 			}
 		}
+	}
 
 
-		if( ( (iteration) % (50*adaptiveWidth)) == 0u)
-		{
-			double gewekeScore = calculateGewekeScore(iteration/thining);
+	if( ( (iteration) % (50*adaptiveWidth)) == 0u)
+	{
+		double gewekeScore = calculateGewekeScore(iteration/thining);
 #ifndef STANDALONE
-			Rprintf("##################################################\n");
-			Rprintf("Geweke Score after %d iterations: %f\n", iteration, gewekeScore);
-			Rprintf("##################################################\n");
+		Rprintf("##################################################\n");
+		Rprintf("Geweke Score after %d iterations: %f\n", iteration, gewekeScore);
+		Rprintf("##################################################\n");
 #else
-			std::cout << "##################################################" << "\n";
-			std::cout << "Geweke Score after " << iteration << " iterations: " << gewekeScore << "\n";
-			std::cout << "##################################################" << "\n";
+		std::cout << "##################################################" << "\n";
+		std::cout << "Geweke Score after " << iteration << " iterations: " << gewekeScore << "\n";
+		std::cout << "##################################################" << "\n";
 #endif
 
-			if(std::abs(gewekeScore) < 1.96)
-			{
+		if(convergenceDiagnostics != 0u && checkConvergence(model, iteration / thining))
+		{
 #ifndef STANDALONE
-				Rprintf("Stopping run based on convergence after %d iterations\n\n", iteration);
+			Rprintf("Stopping run based on convergence after %d iterations\n\n", iteration);
 #else
-				std::cout << "Stopping run based on convergence after " << iteration << " iterations\n" << std::endl;
+			std::cout << "Stopping run based on convergence after " << iteration << " iterations\n" << std::endl;
 #endif
-				// Comment out this break to keep the run from stopping on convergence
-				//model.setLastIteration(iteration/thining);
-				//break;
-			}
+			converged = true;
+			truncateTraces(model, iteration / thining);
+			return false;
 		}
+	}
+	return true;
+}
+
+
+void MCMCAlgorithm::run(Genome& genome, Model& model, unsigned numCores, unsigned divergenceIterations)
+{
+#ifndef __APPLE__
+	omp_set_num_threads(numCores);
+#endif
+
+	genome.buildObservedSynthesisRateMatrix(); // the observed phi values might have been changed in place
+	initializeRun(genome, model, divergenceIterations);
+
+	unsigned maximumIterations = samples * thining;
+	for(unsigned iteration = 1u; iteration <= maximumIterations; iteration++)
+	{
+		if (!runIteration(genome, model, iteration)) break;
 	} // end MCMC loop
+	model.getTraceObject().flushTraceWriter();
 #ifndef STANDALONE
 	Rprintf("leaving MCMC loop\n");
 #else
@@ -542,8 +907,8 @@ void MCMCAlgorithm::varyInitialConditions(Genome& genome, Model& model, unsigned
 			{
 				// map from mixture to category and obtain corresponding phi value
 				unsigned expressionCategory = model.getSynthesisRateCategory(k);
-				double phiValue = model.getSynthesisRate(i, expressionCategory, false);
-				double phiValue_proposed = model.getSynthesisRate(i, expressionCategory, true);
+				double logPhiValue = model.getLogSynthesisRate(i, expressionCategory, false);
+				double logPhiValue_proposed = model.getLogSynthesisRate(i, expressionCategory, true);
 
 				unsigned mixture = model.getMixtureAssignment(k);
 				mixture = model.getSynthesisRateCategory(mixture);
@@ -551,8 +916,8 @@ void MCMCAlgorithm::varyInitialConditions(Genome& genome, Model& model, unsigned
 				double mPhi = (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2);
 
 				// accept/ reject based on prior ratio
-				double logPhiProbability = Parameter::densityLogNorm(phiValue, mPhi, stdDevSynthesisRate, true);
-				double logPhiProbability_proposed = Parameter::densityLogNorm(phiValue_proposed, mPhi, stdDevSynthesisRate, true);
+				double logPhiProbability = Parameter::densityLogNormLogScale(logPhiValue, mPhi, stdDevSynthesisRate, true);
+				double logPhiProbability_proposed = Parameter::densityLogNormLogScale(logPhiValue_proposed, mPhi, stdDevSynthesisRate, true);
 				if( -Parameter::randExp(1) < (logPhiProbability_proposed - logPhiProbability) )
 				{
 					model.updateSynthesisRate(i, k);
@@ -565,45 +930,91 @@ void MCMCAlgorithm::varyInitialConditions(Genome& genome, Model& model, unsigned
 	}
 }
 
+// Geweke score of the log likelihood trace up to current_iteration: the first 10% of the samples since the last test
+// against the last 50% of all samples. The window statistics come from likelihoodStatistics instead of a rescan of the
+// trace, and the initial evaluation (likelihoodTrace[0]) is not part of the first window.
 double MCMCAlgorithm::calculateGewekeScore(unsigned current_iteration)
 {
-	double posteriorMean1 = 0.0;
-	double posteriorMean2 = 0.0;
-	double posteriorVariance1 = 0.0;
-	double posteriorVariance2 = 0.0;
-
 	unsigned end1 = (unsigned)std::round( (current_iteration - lastConvergenceTest) * 0.1) + lastConvergenceTest;
 	unsigned start2 = (unsigned)std::round(current_iteration - (current_iteration * 0.5));
-
-	double numSamples1 = (double) (end1 - lastConvergenceTest);
-	double numSamples2 = (double) std::round(current_iteration * 0.5);
-
-	// calculate mean and and variance of first part of likelihood trace
-	for(unsigned i = lastConvergenceTest; i < end1; i++)
+	unsigned start1 = std::max(lastConvergenceTest, 1u);
+	lastConvergenceTest = current_iteration;
+	if (end1 <= start1 || current_iteration <= start2 || current_iteration - 1u > likelihoodStatistics.getNumSamples())
 	{
-		posteriorMean1 += likelihoodTrace[i];
+		return std::numeric_limits<double>::quiet_NaN();
 	}
-	posteriorMean1 = posteriorMean1 / numSamples1;
-	for(unsigned i = lastConvergenceTest; i < end1; i++)
+
+	// trace index i is sample i - 1 of likelihoodStatistics
+	double numSamples1 = (double) (end1 - start1);
+	double numSamples2 = (double) (current_iteration - start2);
+	double posteriorMean1 = likelihoodStatistics.getWindowMean(start1 - 1u, end1 - 1u);
+	double posteriorVariance1 = likelihoodStatistics.getWindowVariance(start1 - 1u, end1 - 1u);
+	double posteriorMean2 = likelihoodStatistics.getWindowMean(start2 - 1u, current_iteration - 1u);
+	double posteriorVariance2 = likelihoodStatistics.getWindowVariance(start2 - 1u, current_iteration - 1u);
+
+	// Geweke score
+	return (posteriorMean1 - posteriorMean2) / std::sqrt( ( posteriorVariance1 / numSamples1 ) + ( posteriorVariance2 / numSamples2 ) );
+}
+
+
+// Stops the run early once all given diagnostics pass, but not before minimumSamples samples:
+// gewekeLogLikelihood: the Geweke score of the log likelihood trace is below threshold.
+// gewekeCodonSpecificParameters: the Geweke scores of all codon specific parameter traces pass jointly. As the traces
+//	are tested together, the p-value of the largest score is Bonferroni corrected by the number of traces.
+// The diagnostics are evaluated every 50 * adaptiveWidth iterations, together with the reported Geweke score.
+void MCMCAlgorithm::setConvergenceCriteria(unsigned diagnostics, double threshold, unsigned minimumSamples)
+{
+	convergenceDiagnostics = diagnostics;
+	convergenceThreshold = threshold;
+	minimumConvergenceSamples = minimumSamples;
+}
+
+
+unsigned MCMCAlgorithm::getConvergenceDiagnostics()
+{
+	return convergenceDiagnostics;
+}
+
+
+bool MCMCAlgorithm::isConverged()
+{
+	return converged;
+}
+
+
+// Ends the traces at the given sample: the model uses samples up to it for posterior estimates and the log
+// likelihood trace is cut after it.
+void MCMCAlgorithm::truncateTraces(Model& model, unsigned sample)
+{
+	model.setLastIteration(sample);
+	if (sample + 1u < likelihoodTrace.size())
 	{
-		posteriorVariance1 += (likelihoodTrace[i] - posteriorMean1) * (likelihoodTrace[i] - posteriorMean1);
+		likelihoodTrace.resize(sample + 1u);
 	}
-	posteriorVariance1 = posteriorVariance1 / numSamples1;
-	// calculate mean and and variance of last part of likelihood trace
-	for(unsigned i = start2; i < current_iteration; i++)
+}
+
+
+bool MCMCAlgorithm::checkConvergence(Model& model, unsigned sample)
+{
+	if (sample < minimumConvergenceSamples) return false;
+
+	// the initial values (sample 0) are not part of the chain
+	if ((convergenceDiagnostics & gewekeLogLikelihood) != 0u)
 	{
-		posteriorMean2 += likelihoodTrace[i];
+		double score = likelihoodStatistics.getGewekeScore(0u, sample);
+		if (!(std::abs(score) < convergenceThreshold)) return false;
 	}
-	posteriorMean2 = posteriorMean2 / numSamples2;
-	for(unsigned i = start2; i < current_iteration; i++)
+
+	if ((convergenceDiagnostics & gewekeCodonSpecificParameters) != 0u)
 	{
-		posteriorVariance2 += (likelihoodTrace[i] - posteriorMean2) * (likelihoodTrace[i] - posteriorMean2);
+		unsigned numTraces = 0u;
+		double maximumScore = model.getTraceObject().getMaximumCodonSpecificParameterGewekeScore(0u, sample, numTraces);
+		if (std::isnan(maximumScore)) return false;
+		// two sided p-values: P(|Z| > maximumScore) * numTraces has to exceed P(|Z| > threshold)
+		if (numTraces > 0u && std::erfc(maximumScore / std::sqrt(2.0)) * numTraces < std::erfc(convergenceThreshold / std::sqrt(2.0)))
+			return false;
 	}
-	posteriorVariance2 = posteriorVariance2 / numSamples2;
-
-	lastConvergenceTest = current_iteration;
-	// Geweke score
-	return (posteriorMean1 - posteriorMean2) / std::sqrt( ( posteriorVariance1 / numSamples1 ) + ( posteriorVariance2 / numSamples2 ) );
+	return true;
 }
 
 
@@ -631,6 +1042,24 @@ bool MCMCAlgorithm::isEstimateMixtureAssignment()
 }
 
 
+bool MCMCAlgorithm::isParallelSynthesisRateSweep()
+{
+	return parallelSynthesisRateSweep;
+}
+
+
+bool MCMCAlgorithm::isBlockedCodonSpecificParameterUpdate()
+{
+	return blockedCodonSpecificParameterUpdate;
+}
+
+
+bool MCMCAlgorithm::isFusedIteration()
+{
+	return fusedIteration;
+}
+
+
 void MCMCAlgorithm::setEstimateSynthesisRate(bool in)
 {
 	estimateSynthesisRate = in;
@@ -655,6 +1084,27 @@ void MCMCAlgorithm::setEstimateMixtureAssignment(bool in)
 }
 
 
+void MCMCAlgorithm::setParallelSynthesisRateSweep(bool in)
+{
+	parallelSynthesisRateSweep = in;
+}
+
+
+void MCMCAlgorithm::setBlockedCodonSpecificParameterUpdate(bool in)
+{
+	blockedCodonSpecificParameterUpdate = in;
+}
+
+
+// Visits every gene once per iteration instead of once per update step, see acceptRejectFusedIteration.
+// Only used if codon specific parameters, hyper parameters and synthesis rates (or mixture assignments)
+// are all estimated and the model supports it, otherwise the regular iteration is run.
+void MCMCAlgorithm::setFusedIteration(bool in)
+{
+	fusedIteration = in;
+}
+
+
 void MCMCAlgorithm::setRestartFileSettings(std::string filename, unsigned interval, bool multiple)
 {
 	file = filename;
@@ -712,6 +1162,21 @@ double MCMCAlgorithm::getLogLikelihoodPosteriorMean(unsigned _samples)
 }
 
 
+// Autocorrelation of the log likelihood trace (without the initial evaluation) at the given lag, at most the maximum
+// lag of the streaming statistics.
+double MCMCAlgorithm::getLogLikelihoodAutocorrelation(unsigned lag)
+{
+	return likelihoodStatistics.getAutocorrelation(lag);
+}
+
+
+// Variance of the posterior mean of the log likelihood, estimated by batch means.
+double MCMCAlgorithm::getLogLikelihoodBatchMeansVariance()
+{
+	return likelihoodStatistics.getBatchMeansVariance();
+}
+
+
 std::vector<double> MCMCAlgorithm::acf(std::vector<double>& x, int nrows, int ncols, int lagmax, bool correlation, bool demean)
 {
 	if(demean)
@@ -919,9 +1384,20 @@ RCPP_MODULE(MCMCAlgorithm_mod)
 		//MCMC Functions:
 		.method("run", &MCMCAlgorithm::run)
 		.method("setEstimateMixtureAssignment", &MCMCAlgorithm::setEstimateMixtureAssignment)
+		.method("setParallelSynthesisRateSweep", &MCMCAlgorithm::setParallelSynthesisRateSweep)
+		.method("isParallelSynthesisRateSweep", &MCMCAlgorithm::isParallelSynthesisRateSweep)
+		.method("setBlockedCodonSpecificParameterUpdate", &MCMCAlgorithm::setBlockedCodonSpecificParameterUpdate)
+		.method("isBlockedCodonSpecificParameterUpdate", &MCMCAlgorithm::isBlockedCodonSpecificParameterUpdate)
+		.method("setFusedIteration", &MCMCAlgorithm::setFusedIteration)
+		.method("isFusedIteration", &MCMCAlgorithm::isFusedIteration)
 		.method("setRestartFileSettings", &MCMCAlgorithm::setRestartFileSettings)
 		.method("getLogLikelihoodTrace", &MCMCAlgorithm::getLogLikelihoodTrace)
 		.method("getLogLikelihoodPosteriorMean", &MCMCAlgorithm::getLogLikelihoodPosteriorMean)
+		.method("getLogLikelihoodAutocorrelation", &MCMCAlgorithm::getLogLikelihoodAutocorrelation)
+		.method("getLogLikelihoodBatchMeansVariance", &MCMCAlgorithm::getLogLikelihoodBatchMeansVariance)
+		.method("setConvergenceCriteria", &MCMCAlgorithm::setConvergenceCriteria)
+		.method("getConvergenceDiagnostics", &MCMCAlgorithm::getConvergenceDiagnostics)
+		.method("isConverged", &MCMCAlgorithm::isConverged)
 
 
 
@@ -2,7 +2,7 @@
 
 Model::Model()
 {
-//ctor
+	inverseTemperature = 1.0;
 }
 
 Model::~Model()
@@ -10,6 +10,73 @@ Model::~Model()
 //dtor
 }
 
+
+// Log acceptance ratios of the proposed codon specific parameters of all groupings (see
+// MCMCAlgorithm::setBlockedCodonSpecificParameterUpdate). Models that can evaluate all groupings in one
+// pass over the genome override this; the default evaluates one grouping after the other.
+void Model::calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios)
+{
+	unsigned numGroupings = getGroupListSize();
+	logAcceptanceRatios.resize(numGroupings);
+	for (unsigned i = 0u; i < numGroupings; i++)
+	{
+		calculateLogLikelihoodRatioPerGroupingPerCategory(getGrouping(i), genome, logAcceptanceRatios[i]);
+	}
+}
+
+
+
+// Parallel tempering (see MultiChainMCMC) samples from posteriors in which the codon likelihood is raised to the
+// power of the inverse temperature. Priors, the observed synthesis rates and the proposal terms are not tempered,
+// so at 1.0 (the default) the model is unchanged.
+double Model::getInverseTemperature()
+{
+	return inverseTemperature;
+}
+
+
+void Model::setInverseTemperature(double beta)
+{
+	inverseTemperature = beta;
+}
+
+
+
+// A fused iteration (see MCMCAlgorithm::setFusedIteration) visits every gene once per iteration: the synthesis rate
+// and mixture assignment of the gene are updated and the gene is then added to the log likelihoods of the proposed
+// codon specific parameters and hyper parameters. Models supporting this override the functions below:
+// prepareFusedIteration caches the current and proposed parameters after the proposals, addGeneToFusedLogRatios
+// adds one gene to the current (2 * grouping) and proposed (2 * grouping + 1) log likelihoods of every grouping and
+// to the hyper parameter log ratios (ordered as in calculateLogLikelihoodRatioForHyperParameters), and
+// completeFusedLogRatios adds the gene independent terms (priors, jacobians) once all genes are summed up.
+bool Model::isFusedIterationSupported()
+{
+	return false;
+}
+
+
+unsigned Model::getNumHyperParameterLogRatios()
+{
+	return 0u;
+}
+
+
+void Model::prepareFusedIteration(Genome& genome)
+{
+}
+
+
+void Model::addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+		double *hyperParameterLogRatios)
+{
+}
+
+
+void Model::completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+		std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios)
+{
+}
+
 //Cedric: This functions will repalce calculateMutationPrior in ROC/FONSE model and allows us to more generally use priors on codon specific parameters.
 //			We have to first change how current and proposed csp values are stored to move the function getParameterForCategory up into the base parameter class.
 
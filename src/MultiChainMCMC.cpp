@@ -0,0 +1,611 @@
+#include "include/MultiChainMCMC.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+
+//R runs only
+#ifndef STANDALONE
+#include <Rcpp.h>
+using namespace Rcpp;
+#endif
+
+
+//Open MP
+#ifndef __APPLE__
+#include <omp.h>
+#endif
+
+
+
+
+//--------------------------------------------------//
+//----------- Constructors & Destructors -----------//
+//--------------------------------------------------//
+
+
+MultiChainMCMC::MultiChainMCMC() : settings(1000, 1, 100, true, true, true)
+{
+	samples = 1000u;
+	thining = 1u;
+	adaptiveWidth = 100u;
+	swapInterval = 10u;
+	fileWriteInterval = 1u;
+	multipleFiles = false;
+	writeRestartFile = false;
+	rHatThreshold = 0.0;
+	minimumConvergenceSamples = 0u;
+	converged = false;
+}
+
+
+MultiChainMCMC::MultiChainMCMC(unsigned _samples, unsigned _thining, unsigned _adaptiveWidth, bool _estimateSynthesisRate,
+			bool _estimateCodonSpecificParameter, bool _estimateHyperParameter) : settings(_samples, _thining, _adaptiveWidth,
+			_estimateSynthesisRate, _estimateCodonSpecificParameter, _estimateHyperParameter)
+{
+	samples = _samples;
+	thining = _thining;
+	adaptiveWidth = _adaptiveWidth * _thining;
+	swapInterval = 10u;
+	fileWriteInterval = 1u;
+	multipleFiles = false;
+	writeRestartFile = false;
+	rHatThreshold = 0.0;
+	minimumConvergenceSamples = 0u;
+	converged = false;
+}
+
+
+MultiChainMCMC::~MultiChainMCMC()
+{
+	//dtor
+}
+
+
+
+
+
+//-------------------------------------//
+//---------- Chain Functions ----------//
+//-------------------------------------//
+
+
+// The model has to be set up (parameter object, initial values) as for MCMCAlgorithm::run. Every chain needs its own
+// model and parameter object.
+void MultiChainMCMC::addChain(Model& model)
+{
+	Chain chain;
+	chain.model = &model;
+	chain.slot = (unsigned)chains.size();
+	chain.stopped = false;
+	chain.logLikelihood = 0.0;
+	chains.push_back(chain);
+}
+
+
+unsigned MultiChainMCMC::getNumChains()
+{
+	return (unsigned)chains.size();
+}
+
+
+// One inverse temperature per chain, 1 being the posterior of interest. Chain i starts at the i-th largest value.
+void MultiChainMCMC::setInverseTemperatures(std::vector<double> betas)
+{
+	for (unsigned i = 0u; i < betas.size(); i++)
+	{
+		if (!(betas[i] > 0.0 && betas[i] <= 1.0))
+		{
+#ifndef STANDALONE
+			Rf_error("Error in MultiChainMCMC::setInverseTemperatures: inverse temperatures have to be in (0, 1]\n");
+#else
+			std::cerr << "Error in MultiChainMCMC::setInverseTemperatures: inverse temperatures have to be in (0, 1]\n";
+			return;
+#endif
+		}
+	}
+	std::sort(betas.begin(), betas.end(), std::greater<double>());
+	inverseTemperatures = betas;
+}
+
+
+std::vector<double> MultiChainMCMC::getInverseTemperatures()
+{
+	return inverseTemperatures;
+}
+
+
+void MultiChainMCMC::setSwapInterval(unsigned interval)
+{
+	swapInterval = std::max(interval, 1u);
+}
+
+
+unsigned MultiChainMCMC::getSwapInterval()
+{
+	return swapInterval;
+}
+
+
+
+
+
+//------------------------------------//
+//---------- MCMC Functions ----------//
+//------------------------------------//
+
+
+// The iterations are run in segments of swapInterval iterations. Within a segment the chains are independent and run
+// in parallel, one thread per chain. At the end of a segment the untempered codon log
+// likelihood of every chain is evaluated and neighbouring temperatures propose to swap.
+void MultiChainMCMC::run(Genome& genome, unsigned numCores, unsigned divergenceIterations)
+{
+	unsigned numChains = (unsigned)chains.size();
+	if (numChains == 0u)
+	{
+#ifndef STANDALONE
+		Rf_error("Error in MultiChainMCMC::run: no chains added\n");
+#else
+		std::cerr << "Error in MultiChainMCMC::run: no chains added\n";
+		return;
+#endif
+	}
+	if (inverseTemperatures.empty())
+	{
+		inverseTemperatures.assign(numChains, 1.0);
+	}
+	if (inverseTemperatures.size() != numChains)
+	{
+#ifndef STANDALONE
+		Rf_error("Error in MultiChainMCMC::run: %d inverse temperatures for %d chains\n", (int)inverseTemperatures.size(), numChains);
+#else
+		std::cerr << "Error in MultiChainMCMC::run: " << inverseTemperatures.size() << " inverse temperatures for " << numChains << " chains\n";
+		return;
+#endif
+	}
+
+#ifndef __APPLE__
+	omp_set_num_threads(numCores);
+#endif
+	genome.buildObservedSynthesisRateMatrix(); // once for all chains, the genome is read only from here on
+
+	unsigned maximumIterations = samples * thining;
+	unsigned numRounds = (maximumIterations + swapInterval - 1u) / swapInterval;
+	chainInSlot.resize(numChains);
+	numSwapProposals.assign(numChains - 1u, 0u);
+	numSwapAccepts.assign(numChains - 1u, 0u);
+	rHatTrace.clear();
+	converged = false;
+
+	unsigned numColdChains = (unsigned)std::count(inverseTemperatures.begin(), inverseTemperatures.end(), 1.0);
+	if (numColdChains < 2u)
+	{
+#ifndef STANDALONE
+		Rprintf("R-hat needs at least two chains at inverse temperature 1 and is not calculated\n");
+#else
+		std::cout << "R-hat needs at least two chains at inverse temperature 1 and is not calculated\n";
+#endif
+	}
+
+#ifdef STANDALONE
+	// every chain gets its own stream, so the chains do not depend on which thread runs them
+	uint64_t chainSeed = (uint64_t)(Parameter::randUnif(0.0, 1.0) * 9007199254740992.0);
+#endif
+	for (unsigned c = 0u; c < numChains; c++)
+	{
+		Chain &chain = chains[c];
+		chain.mcmc = settings;
+		chain.mcmc.setConvergenceCriteria(0u); // the chains have to stay in step, they stop together on R-hat
+		if (writeRestartFile)
+		{
+			chain.mcmc.setRestartFileSettings(getChainFileName(c, file), fileWriteInterval, multipleFiles);
+		}
+		chain.slot = c;
+		chain.stopped = false;
+		chainInSlot[c] = c;
+		chain.model->setInverseTemperature(inverseTemperatures[c]);
+		chain.inverseTemperatureTrace.assign(numRounds, 0.0);
+		chain.logLikelihoodTrace.assign(numRounds, 0.0);
+#ifdef STANDALONE
+		chain.generator.setStream(chainSeed, 0u, c);
+		std::swap(Parameter::generator, chain.generator);
+#endif
+		// the traces open their files when they are initialized, the settings are restored afterwards so another run
+		// does not prefix them twice
+		Trace &trace = chain.model->getTraceObject();
+		std::string mappedTraceFilePrefix = trace.getMappedTraceFilePrefix();
+		std::string traceWriterFile = trace.getTraceWriterFile();
+		if (!mappedTraceFilePrefix.empty()) trace.setMappedTraceFilePrefix(getChainFileName(c, mappedTraceFilePrefix));
+		if (!traceWriterFile.empty())
+			trace.setTraceWriterSettings(getChainFileName(c, traceWriterFile), trace.getTraceWriterChunkSize());
+		chain.mcmc.initializeRun(genome, *chain.model, divergenceIterations);
+		trace.setMappedTraceFilePrefix(mappedTraceFilePrefix);
+		trace.setTraceWriterSettings(traceWriterFile, trace.getTraceWriterChunkSize());
+#ifdef STANDALONE
+		std::swap(Parameter::generator, chain.generator);
+#endif
+	}
+
+	bool stopped = false;
+	for (unsigned round = 0u; round < numRounds && !stopped; round++)
+	{
+		unsigned firstIteration = round * swapInterval + 1u;
+		unsigned lastIteration = std::min(firstIteration + swapInterval - 1u, maximumIterations);
+
+#if defined(STANDALONE) && !defined(__APPLE__)
+		// the parallel loops within a chain run on the thread of the chain, nested teams cost more than they gain
+		unsigned numChainThreads = std::min(std::max(numCores, 1u), numChains);
+		int maxActiveLevels = omp_get_max_active_levels();
+		omp_set_max_active_levels(1);
+#pragma omp parallel for schedule(dynamic) num_threads(numChainThreads)
+#endif
+		for (int c = 0; c < (int)numChains; c++)
+		{
+			runSegment(genome, (unsigned)c, firstIteration, lastIteration);
+		}
+#if defined(STANDALONE) && !defined(__APPLE__)
+		omp_set_max_active_levels(maxActiveLevels);
+#endif
+
+		for (unsigned c = 0u; c < numChains; c++)
+		{
+			chains[c].inverseTemperatureTrace[round] = chains[c].model->getInverseTemperature();
+			chains[c].logLikelihoodTrace[round] = chains[c].logLikelihood;
+			stopped = stopped || chains[c].stopped;
+		}
+		if (stopped)
+		{
+			std::cerr << "Log likelihood of a chain is NaN, stopping all chains at iteration " << lastIteration << std::endl;
+			break;
+		}
+
+		if (numColdChains >= 2u)
+		{
+			// log likelihood of the chains that ran at inverse temperature 1, per round in chain order
+			std::vector<std::vector<double>> coldTraces;
+			for (unsigned slot = 0u; slot < numColdChains; slot++)
+			{
+				coldTraces.push_back(std::vector<double>(round + 1u, 0.0));
+			}
+			for (unsigned r = 0u; r <= round; r++)
+			{
+				unsigned s = 0u;
+				for (unsigned c = 0u; c < numChains; c++)
+				{
+					if (chains[c].inverseTemperatureTrace[r] == 1.0) coldTraces[s++][r] = chains[c].logLikelihoodTrace[r];
+				}
+			}
+			// the first half of the rounds is discarded as burn in
+			rHatTrace.push_back(calculateRHat(coldTraces, (round + 1u) / 2u, round + 1u));
+			if (lastIteration / (50u * adaptiveWidth) != (firstIteration - 1u) / (50u * adaptiveWidth))
+			{
+#ifndef STANDALONE
+				Rprintf("##################################################\n");
+				Rprintf("R-hat of the log likelihood after %d iterations: %f\n", lastIteration, rHatTrace.back());
+				Rprintf("##################################################\n");
+#else
+				std::cout << "##################################################" << "\n";
+				std::cout << "R-hat of the log likelihood after " << lastIteration << " iterations: " << rHatTrace.back() << "\n";
+				std::cout << "##################################################" << "\n";
+#endif
+			}
+			if (rHatThreshold > 0.0 && lastIteration / thining >= minimumConvergenceSamples && rHatTrace.back() < rHatThreshold)
+			{
+#ifndef STANDALONE
+				Rprintf("Stopping run based on convergence after %d iterations\n\n", lastIteration);
+#else
+				std::cout << "Stopping run based on convergence after " << lastIteration << " iterations\n" << std::endl;
+#endif
+				converged = true;
+				for (unsigned c = 0u; c < numChains; c++)
+				{
+					chains[c].mcmc.truncateTraces(*chains[c].model, lastIteration / thining);
+					chains[c].inverseTemperatureTrace.resize(round + 1u);
+					chains[c].logLikelihoodTrace.resize(round + 1u);
+				}
+				break;
+			}
+		}
+
+		if (numChains > 1u) proposeSwaps(round);
+	}
+	for (unsigned c = 0u; c < numChains; c++)
+	{
+		chains[c].model->getTraceObject().flushTraceWriter();
+	}
+#ifndef STANDALONE
+	Rprintf("leaving multi chain MCMC loop\n");
+#else
+	std::cout << "leaving multi chain MCMC loop" << std::endl;
+#endif
+}
+
+
+// Runs the iterations of one chain with the chain's random stream and evaluates its untempered log likelihood.
+void MultiChainMCMC::runSegment(Genome& genome, unsigned chain, unsigned firstIteration, unsigned lastIteration)
+{
+	Chain &current = chains[chain];
+#ifdef STANDALONE
+	std::swap(Parameter::generator, current.generator);
+#endif
+	for (unsigned iteration = firstIteration; iteration <= lastIteration && !current.stopped; iteration++)
+	{
+		current.stopped = !current.mcmc.runIteration(genome, *current.model, iteration);
+	}
+#ifdef STANDALONE
+	std::swap(Parameter::generator, current.generator);
+#endif
+	current.logLikelihood = current.model->calculateLogLikelihood(genome);
+}
+
+
+// Neighbouring slots i and i + 1 of the ladder swap with probability
+// min(1, exp((beta_i - beta_i+1) * (logL_i+1 - logL_i))). Even rounds propose the pairs (0, 1), (2, 3), ...,
+// odd rounds the pairs (1, 2), (3, 4), ... The chains exchange their temperatures instead of their states.
+void MultiChainMCMC::proposeSwaps(unsigned round)
+{
+	for (unsigned slot = round % 2u; slot + 1u < chainInSlot.size(); slot += 2u)
+	{
+		Chain &colder = chains[chainInSlot[slot]];
+		Chain &hotter = chains[chainInSlot[slot + 1u]];
+		double logAcceptanceRatio = (inverseTemperatures[slot] - inverseTemperatures[slot + 1u])
+			* (hotter.logLikelihood - colder.logLikelihood);
+
+		numSwapProposals[slot]++;
+		if (-Parameter::randExp(1.0) < logAcceptanceRatio)
+		{
+			numSwapAccepts[slot]++;
+			std::swap(chainInSlot[slot], chainInSlot[slot + 1u]);
+			colder.slot = slot + 1u;
+			hotter.slot = slot;
+			colder.model->setInverseTemperature(inverseTemperatures[slot + 1u]);
+			hotter.model->setInverseTemperature(inverseTemperatures[slot]);
+		}
+	}
+}
+
+
+// Stops all chains once the split R-hat of the log likelihood of the chains at inverse temperature 1 falls below
+// threshold, but not before minimumSamples samples. The R-hat is evaluated after every swap round over the second
+// half of the rounds. A threshold of 0 never stops early.
+void MultiChainMCMC::setConvergenceCriteria(double threshold, unsigned minimumSamples)
+{
+	rHatThreshold = threshold;
+	minimumConvergenceSamples = minimumSamples;
+}
+
+
+bool MultiChainMCMC::isConverged()
+{
+	return converged;
+}
+
+
+void MultiChainMCMC::setEstimateMixtureAssignment(bool in)
+{
+	settings.setEstimateMixtureAssignment(in);
+}
+
+
+void MultiChainMCMC::setParallelSynthesisRateSweep(bool in)
+{
+	settings.setParallelSynthesisRateSweep(in);
+}
+
+
+void MultiChainMCMC::setBlockedCodonSpecificParameterUpdate(bool in)
+{
+	settings.setBlockedCodonSpecificParameterUpdate(in);
+}
+
+
+void MultiChainMCMC::setFusedIteration(bool in)
+{
+	settings.setFusedIteration(in);
+}
+
+
+void MultiChainMCMC::setStepsToAdapt(unsigned steps)
+{
+	settings.setStepsToAdapt(steps);
+}
+
+
+// Every chain writes its own restart files, named as given with "chain<index>_" in front of the file name.
+void MultiChainMCMC::setRestartFileSettings(std::string filename, unsigned interval, bool multiple)
+{
+	file = filename;
+	fileWriteInterval = interval;
+	multipleFiles = multiple;
+	writeRestartFile = true;
+}
+
+
+std::string MultiChainMCMC::getChainFileName(unsigned chain, std::string filename)
+{
+	std::size_t pos = filename.find_last_of("/\\");
+	pos = (pos == std::string::npos) ? 0u : pos + 1u;
+	std::ostringstream oss;
+	oss << "chain" << chain << "_";
+	return filename.insert(pos, oss.str());
+}
+
+
+
+
+
+//-----------------------------------------//
+//---------- Diagnostic Functions ---------//
+//-----------------------------------------//
+
+
+// Log likelihood trace of the chain as recorded by its MCMCAlgorithm, at whatever temperature the chain ran.
+std::vector<double> MultiChainMCMC::getLogLikelihoodTrace(unsigned chain)
+{
+	return chains[chain].mcmc.getLogLikelihoodTrace();
+}
+
+
+// Untempered codon log likelihood of the chain at the end of every swap round.
+std::vector<double> MultiChainMCMC::getUntemperedLogLikelihoodTrace(unsigned chain)
+{
+	return chains[chain].logLikelihoodTrace;
+}
+
+
+// Inverse temperature of the chain during every swap round. Samples taken at 1 are samples of the posterior.
+std::vector<double> MultiChainMCMC::getInverseTemperatureTrace(unsigned chain)
+{
+	return chains[chain].inverseTemperatureTrace;
+}
+
+
+// Fraction of accepted swaps between slot i and i + 1 of the ladder.
+std::vector<double> MultiChainMCMC::getSwapAcceptanceRates()
+{
+	std::vector<double> rates(numSwapProposals.size(), 0.0);
+	for (unsigned i = 0u; i < rates.size(); i++)
+	{
+		if (numSwapProposals[i] > 0u) rates[i] = (double)numSwapAccepts[i] / numSwapProposals[i];
+	}
+	return rates;
+}
+
+
+std::vector<double> MultiChainMCMC::getRHatTrace()
+{
+	return rHatTrace;
+}
+
+
+// Writes one csv file per chain (named as in setRestartFileSettings) with the inverse temperature and untempered
+// log likelihood of every swap round.
+void MultiChainMCMC::writeChainTraces(std::string filename)
+{
+	for (unsigned c = 0u; c < chains.size(); c++)
+	{
+		std::string chainFile = getChainFileName(c, filename);
+		std::ofstream out(chainFile.c_str());
+		if (!out)
+		{
+#ifndef STANDALONE
+			Rf_error("Error in MultiChainMCMC::writeChainTraces: Can not open output file %s\n", chainFile.c_str());
+#else
+			std::cerr << "Error in MultiChainMCMC::writeChainTraces: Can not open output file " << chainFile << "\n";
+			return;
+#endif
+		}
+		out.precision(17);
+		out << "iteration,inverseTemperature,logLikelihood\n";
+		for (unsigned r = 0u; r < chains[c].logLikelihoodTrace.size(); r++)
+		{
+			out << std::min((r + 1u) * swapInterval, samples * thining) << "," << chains[c].inverseTemperatureTrace[r] << ","
+				<< chains[c].logLikelihoodTrace[r] << "\n";
+		}
+	}
+}
+
+
+// Split R-hat (Gelman et al. 2013) of the traces between start and end (exclusive). Every trace is split into two
+// halves of n samples, so a chain that is still drifting also shows up as disagreement between its halves.
+// sqrt(((n - 1) / n * W + B / n) / W) with the mean within sequence variance W and the between sequence variance B.
+double MultiChainMCMC::calculateRHat(std::vector<std::vector<double>> &traces, unsigned start, unsigned end)
+{
+	unsigned halfLength = (end > start) ? (end - start) / 2u : 0u;
+	unsigned m = 2u * (unsigned)traces.size();
+	if (m < 4u || halfLength < 2u) return std::numeric_limits<double>::quiet_NaN();
+	double n = halfLength;
+
+	std::vector<double> means(m, 0.0);
+	double meanOfMeans = 0.0;
+	double W = 0.0;
+	for (unsigned j = 0u; j < m; j++)
+	{
+		std::vector<double> &trace = traces[j / 2u];
+		unsigned first = (j % 2u == 0u) ? start : end - halfLength;
+		for (unsigned i = first; i < first + halfLength; i++)
+		{
+			means[j] += trace[i];
+		}
+		means[j] /= n;
+		meanOfMeans += means[j];
+
+		double variance = 0.0;
+		for (unsigned i = first; i < first + halfLength; i++)
+		{
+			variance += (trace[i] - means[j]) * (trace[i] - means[j]);
+		}
+		W += variance / (n - 1.0);
+	}
+	meanOfMeans /= m;
+	W /= m;
+
+	double BoverN = 0.0;
+	for (unsigned j = 0u; j < m; j++)
+	{
+		BoverN += (means[j] - meanOfMeans) * (means[j] - meanOfMeans);
+	}
+	BoverN /= (m - 1.0);
+
+	return std::sqrt((((n - 1.0) / n) * W + BoverN) / W);
+}
+
+
+
+
+
+//---------------------------------//
+//---------- RCPP Module ----------//
+//---------------------------------//
+
+
+#ifndef STANDALONE
+RCPP_EXPOSED_CLASS(Genome)
+RCPP_EXPOSED_CLASS(Model)
+
+
+RCPP_MODULE(MultiChainMCMC_mod)
+{
+	class_<MultiChainMCMC>( "MultiChainMCMC" )
+
+		//Constructors & Destructors:
+		.constructor("empty constructor")
+		.constructor <unsigned, unsigned, unsigned, bool, bool, bool>()
+
+
+
+		//Chain Functions:
+		.method("addChain", &MultiChainMCMC::addChain)
+		.method("getNumChains", &MultiChainMCMC::getNumChains)
+		.method("setInverseTemperatures", &MultiChainMCMC::setInverseTemperatures)
+		.method("getInverseTemperatures", &MultiChainMCMC::getInverseTemperatures)
+		.method("setSwapInterval", &MultiChainMCMC::setSwapInterval)
+		.method("getSwapInterval", &MultiChainMCMC::getSwapInterval)
+
+
+
+		//MCMC Functions:
+		.method("run", &MultiChainMCMC::run)
+		.method("setEstimateMixtureAssignment", &MultiChainMCMC::setEstimateMixtureAssignment)
+		.method("setParallelSynthesisRateSweep", &MultiChainMCMC::setParallelSynthesisRateSweep)
+		.method("setBlockedCodonSpecificParameterUpdate", &MultiChainMCMC::setBlockedCodonSpecificParameterUpdate)
+		.method("setFusedIteration", &MultiChainMCMC::setFusedIteration)
+		.method("setStepsToAdapt", &MultiChainMCMC::setStepsToAdapt)
+		.method("setRestartFileSettings", &MultiChainMCMC::setRestartFileSettings)
+		.method("setConvergenceCriteria", &MultiChainMCMC::setConvergenceCriteria)
+		.method("isConverged", &MultiChainMCMC::isConverged)
+
+
+
+		//Diagnostic Functions:
+		.method("getLogLikelihoodTrace", &MultiChainMCMC::getLogLikelihoodTrace)
+		.method("getUntemperedLogLikelihoodTrace", &MultiChainMCMC::getUntemperedLogLikelihoodTrace)
+		.method("getInverseTemperatureTrace", &MultiChainMCMC::getInverseTemperatureTrace)
+		.method("getSwapAcceptanceRates", &MultiChainMCMC::getSwapAcceptanceRates)
+		.method("getRHatTrace", &MultiChainMCMC::getRHatTrace)
+		.method("writeChainTraces", &MultiChainMCMC::writeChainTraces)
+		;
+}
+#endif
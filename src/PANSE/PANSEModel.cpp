@@ -24,9 +24,10 @@ PANSEModel::~PANSEModel()
 double PANSEModel::calculateLogLikelihoodPerCodonPerGene(double currAlpha, double currLambdaPrime,
 	unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue)
 {
-	double logLikelihood = ((std::lgamma((currNumCodonsInMRNA * currAlpha) + currRFPObserved)) - (std::lgamma(currNumCodonsInMRNA * currAlpha)))
-		+ (currRFPObserved * (std::log(phiValue) - std::log(currLambdaPrime + phiValue))) + ((currNumCodonsInMRNA * currAlpha) * (std::log(currLambdaPrime) -
-					std::log(currLambdaPrime + phiValue)));
+	double alphaCount = currNumCodonsInMRNA * currAlpha;
+	double logLambdaPrimePhi = std::log(currLambdaPrime + phiValue);
+	double logLikelihood = Parameter::logGammaRatio(alphaCount, currRFPObserved)
+		+ (currRFPObserved * (std::log(phiValue) - logLambdaPrimePhi)) + (alphaCount * (std::log(currLambdaPrime) - logLambdaPrimePhi));
 
 	return logLikelihood;
 }
@@ -35,6 +36,13 @@ double PANSEModel::calculateLogLikelihoodPerCodonPerGene(double currAlpha, doubl
 void PANSEModel::setParameter(PANSEParameter &_parameter)
 {
 	parameter = &_parameter;
+
+	groupListCodonIndex.clear();
+	for (unsigned i = 0u; i < getGroupListSize(); i++)
+	{
+		std::string codon = getGrouping(i);
+		groupListCodonIndex.push_back(SequenceSummary::codonToIndex(codon));
+	}
 }
 
 
@@ -52,20 +60,21 @@ void PANSEModel::calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneInd
 	double phiValue = parameter->getSynthesisRate(geneIndex, synthesisRateCategory, false);
 	double phiValue_proposed = parameter->getSynthesisRate(geneIndex, synthesisRateCategory, true);
 
+	int numGroupings = (int)groupListCodonIndex.size();
 #ifndef __APPLE__
 #pragma omp parallel for reduction(+:logLikelihood,logLikelihood_proposed)
 #endif
-	for (unsigned index = 0; index < getGroupListSize(); index++) //number of codons, without the stop codons
+	for (int i = 0; i < numGroupings; i++) //number of codons, without the stop codons
 	{
-		std::string codon = getGrouping(index);
-
-		double currAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, codon, false);
-		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, codon, false);
-		unsigned currRFPObserved = gene.geneData.getRFPObserved(index);
+		unsigned index = groupListCodonIndex[i];
 
 		unsigned currNumCodonsInMRNA = gene.geneData.getCodonCountForCodon(index);
 		if (currNumCodonsInMRNA == 0) continue;
 
+		double currAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, index, false);
+		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, index, false);
+		unsigned currRFPObserved = gene.geneData.getRFPObserved(index);
+
 		logLikelihood += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue);
 		logLikelihood_proposed += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue_proposed);
 	}
@@ -109,11 +118,11 @@ void PANSEModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string g
 		if (currNumCodonsInMRNA == 0) continue;
 
 
-		double currAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, grouping, false);
-		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, grouping, false);
+		double currAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, index, false);
+		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, index, false);
 
-		double propAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, grouping, true);
-		double propLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, grouping, true);
+		double propAlpha = getParameterForCategory(alphaCategory, PANSEParameter::alp, index, true);
+		double propLambdaPrime = getParameterForCategory(lambdaPrimeCategory, PANSEParameter::lmPri, index, true);
 
 
 		logLikelihood += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue);
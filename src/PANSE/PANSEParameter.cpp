@@ -461,9 +461,15 @@ void PANSEParameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptatio
 
 
 double PANSEParameter::getParameterForCategory(unsigned category, unsigned paramType, std::string codon, bool proposal)
+{
+	return getParameterForCategory(category, paramType, SequenceSummary::codonToIndex(codon), proposal);
+}
+
+
+// Index based version for the likelihood loops, avoids the string to index lookup.
+double PANSEParameter::getParameterForCategory(unsigned category, unsigned paramType, unsigned codonIndex, bool proposal)
 {
 	double rv;
-	unsigned codonIndex = SequenceSummary::codonToIndex(codon);
 	if (paramType == PANSEParameter::alp)
 	{
 		rv = (proposal ? proposedAlphaParameter[category][codonIndex] : currentAlphaParameter[category][codonIndex]);
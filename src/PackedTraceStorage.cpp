@@ -0,0 +1,165 @@
+#include "include/PackedTraceStorage.h"
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+PackedTraceStorage::PackedTraceStorage()
+{
+	initialize(0u, 0u, 1u);
+}
+
+
+PackedTraceStorage::~PackedTraceStorage()
+{
+	//dtor
+}
+
+
+
+
+
+//---------------------------------------//
+//---------- Storage Functions ----------//
+//---------------------------------------//
+
+
+// Sizes the storage to numColumns traces of numSamples values in [0, numValues), all 0.
+void PackedTraceStorage::initialize(unsigned _numColumns, unsigned _numSamples, unsigned _numValues)
+{
+	numColumns = _numColumns;
+	numSamples = _numSamples;
+	numValues = (_numValues == 0u) ? 1u : _numValues;
+
+	bitsPerValue = 0u;
+	while (bitsPerValue < 32u && (1ull << bitsPerValue) < numValues) bitsPerValue++;
+	valuesPerWord = (bitsPerValue == 0u) ? 0u : 64u / bitsPerValue;
+	wordsPerColumn = (bitsPerValue == 0u) ? 0u : (numSamples + valuesPerWord - 1u) / valuesPerWord;
+
+	words.assign((std::size_t)numColumns * wordsPerColumn, 0u);
+	counts.assign((std::size_t)numColumns * numValues, 0u);
+	for (unsigned column = 0u; column < numColumns; column++)
+	{
+		counts[(std::size_t)column * numValues] = numSamples;
+	}
+}
+
+
+unsigned PackedTraceStorage::getNumColumns()
+{
+	return numColumns;
+}
+
+
+unsigned PackedTraceStorage::getNumSamples()
+{
+	return numSamples;
+}
+
+
+unsigned PackedTraceStorage::getNumValues()
+{
+	return numValues;
+}
+
+
+unsigned PackedTraceStorage::getBitsPerValue()
+{
+	return bitsPerValue;
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Access Functions ----------//
+//--------------------------------------//
+
+
+unsigned PackedTraceStorage::get(unsigned column, unsigned sample)
+{
+	if (bitsPerValue == 0u) return 0u;
+	uint64_t word = words[(std::size_t)column * wordsPerColumn + sample / valuesPerWord];
+	unsigned shift = (sample % valuesPerWord) * bitsPerValue;
+	return (unsigned)((word >> shift) & ((1ull << bitsPerValue) - 1u));
+}
+
+
+// value has to be smaller than the number of values the storage was initialized with.
+void PackedTraceStorage::set(unsigned column, unsigned sample, unsigned value)
+{
+	counts[(std::size_t)column * numValues + get(column, sample)]--;
+	counts[(std::size_t)column * numValues + value]++;
+	if (bitsPerValue == 0u) return;
+
+	uint64_t &word = words[(std::size_t)column * wordsPerColumn + sample / valuesPerWord];
+	unsigned shift = (sample % valuesPerWord) * bitsPerValue;
+	uint64_t mask = ((1ull << bitsPerValue) - 1u) << shift;
+	word = (word & ~mask) | (((uint64_t)value << shift) & mask);
+}
+
+
+std::vector<unsigned> PackedTraceStorage::getColumn(unsigned column)
+{
+	std::vector<unsigned> RV(numSamples);
+	for (unsigned i = 0u; i < numSamples; i++)
+	{
+		RV[i] = get(column, i);
+	}
+	return RV;
+}
+
+
+std::vector<std::vector<unsigned>> PackedTraceStorage::getColumns()
+{
+	std::vector<std::vector<unsigned>> RV(numColumns);
+	for (unsigned i = 0u; i < numColumns; i++)
+	{
+		RV[i] = getColumn(i);
+	}
+	return RV;
+}
+
+
+// Copies the trace into the column, cut or padded with 0 to the number of samples.
+void PackedTraceStorage::setColumn(unsigned column, const std::vector<unsigned> &trace)
+{
+	for (unsigned i = 0u; i < numSamples; i++)
+	{
+		set(column, i, (i < trace.size()) ? trace[i] : 0u);
+	}
+}
+
+
+// Number of samples in [firstSample, lastSample) of the column taking each value. The histogram gives the whole trace
+// directly, otherwise only the shorter of the range and the samples outside of it is counted.
+std::vector<unsigned> PackedTraceStorage::getCounts(unsigned column, unsigned firstSample, unsigned lastSample)
+{
+	if (lastSample > numSamples) lastSample = numSamples;
+	if (firstSample > lastSample) firstSample = lastSample;
+
+	std::vector<unsigned> RV(numValues, 0u);
+	if (lastSample - firstSample <= numSamples / 2u)
+	{
+		for (unsigned i = firstSample; i < lastSample; i++)
+		{
+			RV[get(column, i)]++;
+		}
+		return RV;
+	}
+
+	RV.assign(counts.begin() + (std::size_t)column * numValues, counts.begin() + (std::size_t)(column + 1u) * numValues);
+	for (unsigned i = 0u; i < firstSample; i++)
+	{
+		RV[get(column, i)]--;
+	}
+	for (unsigned i = lastSample; i < numSamples; i++)
+	{
+		RV[get(column, i)]--;
+	}
+	return RV;
+}
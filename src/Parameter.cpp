@@ -10,7 +10,15 @@ using namespace Rcpp;
 
 //C++ runs only
 #ifdef STANDALONE
-std::default_random_engine Parameter::generator( (unsigned) std::time(NULL));
+#include <atomic>
+#include <thread>
+
+// The seed is taken from the clock once, setSeed replaces it for a reproducible run. The main thread draws from stream 0
+// of the seed and every other thread from its own stream, numbered in the order the threads first draw.
+uint64_t Parameter::seed = (uint64_t) std::time(NULL);
+static const std::thread::id mainThreadId = std::this_thread::get_id();
+static std::atomic<uint32_t> nextThreadStream(1u);
+thread_local RandomStream Parameter::generator = Parameter::createThreadGenerator();
 #endif
 
 
@@ -25,6 +33,9 @@ const unsigned Parameter::dOmega = 1;
 const unsigned Parameter::alp = 0;
 const unsigned Parameter::lmPri = 1;
 
+// above this many terms two std::lgamma calls are cheaper than the recurrence in logGammaRatio
+const unsigned Parameter::logGammaRecurrenceLimit = 16;
+
 
 
 //--------------------------------------------------//
@@ -94,11 +105,8 @@ Parameter& Parameter::operator=(const Parameter& rhs)
 
   	// proposal bias and std for phi values
   	bias_phi = rhs.bias_phi;
-  	std_phi = rhs.std_phi;
 
-  	currentSynthesisRateLevel = rhs.currentSynthesisRateLevel;
-  	proposedSynthesisRateLevel = rhs.proposedSynthesisRateLevel;
-  	numAcceptForSynthesisRate = rhs.numAcceptForSynthesisRate;
+  	synthesisRateLevel = rhs.synthesisRateLevel;
 
   	numMutationCategories = rhs.numMutationCategories;
   	numSelectionCategories = rhs.numSelectionCategories;
@@ -183,24 +191,10 @@ void Parameter::initParameterSet(std::vector<double> _stdDevSynthesisRate, unsig
 
 	categoryProbabilities.resize(numMixtures, 1.0/(double)numMixtures);
 
-	currentSynthesisRateLevel.resize(numSelectionCategories);
-	proposedSynthesisRateLevel.resize(numSelectionCategories);
-
-	numAcceptForSynthesisRate.resize(numSelectionCategories);
-	std_phi.resize(numSelectionCategories);
-
+	synthesisRateLevel.resize(numSelectionCategories);
 	for (unsigned i = 0u; i < numSelectionCategories; i++)
 	{
-
-		std::vector<double> tempExpr(numGenes, 0.0);
-		currentSynthesisRateLevel[i] = tempExpr;
-		proposedSynthesisRateLevel[i] = tempExpr;
-
-		std::vector<unsigned> tempAccExpr(numGenes, 0u);
-		numAcceptForSynthesisRate[i] = tempAccExpr;
-
-		std::vector<double> tempStdPhi(numGenes, 1.0);
-		std_phi[i] = tempStdPhi;
+		synthesisRateLevel[i].resize(numGenes, 1.0);
 	}
 }
 
@@ -219,6 +213,8 @@ void Parameter::initBaseValuesFromFile(std::string filename)
 	}
 	else
 	{
+		std::vector<std::vector<double>> currentSynthesisRateLevel;
+		std::vector<std::vector<double>> std_phi;
 		int cat = 0;
 		std::vector<double> mat;
 		std::string tmp, variableName;
@@ -375,15 +371,22 @@ void Parameter::initBaseValuesFromFile(std::string filename)
 		bias_phi = 0;
 		obsPhiSets = 0;
 
-		numAcceptForSynthesisRate.resize(numSelectionCategories);
-		proposedSynthesisRateLevel.resize(numSelectionCategories);
+		synthesisRateLevel.resize(numSelectionCategories);
 		for (unsigned i = 0; i < numSelectionCategories; i++)
 		{
-			proposedSynthesisRateLevel[i] = currentSynthesisRateLevel[i];
-			std::vector <double> tmp(currentSynthesisRateLevel[i].size(), 0.1);
-	
-			std::vector <unsigned> tmp2(currentSynthesisRateLevel[i].size(), 0u);
-			numAcceptForSynthesisRate[i] = tmp2;
+			unsigned numGenes = (unsigned)currentSynthesisRateLevel[i].size();
+			synthesisRateLevel[i].resize(numGenes, 0.1);
+			double *width = synthesisRateLevel[i].getProposalWidths();
+			for (unsigned j = 0u; j < numGenes; j++)
+			{
+				synthesisRateLevel[i].setSynthesisRate(j, currentSynthesisRateLevel[i][j]);
+				if (j < std_phi[i].size()) width[j] = std_phi[i][j];
+			}
+			// the proposal starts out equal to the current state
+			std::copy(synthesisRateLevel[i].getSynthesisRates(), synthesisRateLevel[i].getSynthesisRates() + numGenes,
+					synthesisRateLevel[i].getSynthesisRates(true));
+			std::copy(synthesisRateLevel[i].getLogSynthesisRates(), synthesisRateLevel[i].getLogSynthesisRates() + numGenes,
+					synthesisRateLevel[i].getLogSynthesisRates(true));
 		}
 	}
 }
@@ -431,12 +434,13 @@ void Parameter::writeBasicRestartFile(std::string filename)
 		oss << ">std_stdDevSynthesisRate:\n" << std_stdDevSynthesisRate << "\n";
 		//maybe clear the buffer
 		oss << ">std_phi:\n";
-		for (i = 0; i < std_phi.size(); i++)
+		for (i = 0; i < synthesisRateLevel.size(); i++)
 		{
+			double *std_phi = synthesisRateLevel[i].getProposalWidths();
 			oss << "***\n";
-			for (j = 0; j < std_phi[i].size(); j++)
+			for (j = 0; j < synthesisRateLevel[i].size(); j++)
 			{
-				oss << std_phi[i][j];
+				oss << std_phi[j];
 				if ((j + 1) % 10 == 0) oss << "\n";
 				else oss <<" ";
 			}
@@ -491,12 +495,13 @@ void Parameter::writeBasicRestartFile(std::string filename)
 		}
 
 		oss << ">currentSynthesisRateLevel:\n";
-		for (i = 0; i < currentSynthesisRateLevel.size(); i++)
+		for (i = 0; i < synthesisRateLevel.size(); i++)
 		{
+			double *currentSynthesisRateLevel = synthesisRateLevel[i].getSynthesisRates();
 			oss << "***\n";
-			for (j = 0; j < currentSynthesisRateLevel[i].size(); j++)
+			for (j = 0; j < synthesisRateLevel[i].size(); j++)
 			{
-			oss << currentSynthesisRateLevel[i][j];
+			oss << currentSynthesisRateLevel[j];
 			if ((j + 1) % 10 == 0) oss << "\n";
 			else oss <<" ";
 			}
@@ -580,10 +585,10 @@ void Parameter::InitializeSynthesisRate(Genome& genome, double sd_phi)
 	{
 		for(unsigned j = 0u; j < genomeSize; j++)
 		{
-			currentSynthesisRateLevel[category][index[j]] = expression[j];
-			//std::cout << currentSynthesisRateLevel[category][j] <<"\n";
-			std_phi[category][j] = 0.1;
-			numAcceptForSynthesisRate[category][j] = 0u;
+			synthesisRateLevel[category].setSynthesisRate(index[j], expression[j]);
+			//std::cout << synthesisRateLevel[category].getSynthesisRates()[j] <<"\n";
+			synthesisRateLevel[category].getProposalWidths()[j] = 0.1;
+			synthesisRateLevel[category].getNumAccept()[j] = 0u;
 		}
 	}
 
@@ -595,14 +600,14 @@ void Parameter::InitializeSynthesisRate(Genome& genome, double sd_phi)
 
 void Parameter::InitializeSynthesisRate(double sd_phi)
 {
-	unsigned numGenes = currentSynthesisRateLevel[1].size();
+	unsigned numGenes = synthesisRateLevel[0].size();
 	for(unsigned category = 0u; category < numSelectionCategories; category++)
 	{
 		for(unsigned i = 0u; i < numGenes; i++)
 		{
-			currentSynthesisRateLevel[category][i] = Parameter::randLogNorm(-(sd_phi * sd_phi) / 2, sd_phi);
-			std_phi[category][i] = 0.1;
-			numAcceptForSynthesisRate[category][i] = 0u;
+			synthesisRateLevel[category].setSynthesisRate(i, Parameter::randLogNorm(-(sd_phi * sd_phi) / 2, sd_phi));
+			synthesisRateLevel[category].getProposalWidths()[i] = 0.1;
+			synthesisRateLevel[category].getNumAccept()[i] = 0u;
 		}
 	}
 }
@@ -610,14 +615,14 @@ void Parameter::InitializeSynthesisRate(double sd_phi)
 
 void Parameter::InitializeSynthesisRate(std::vector<double> expression)
 {
-	unsigned numGenes = currentSynthesisRateLevel[0].size();
+	unsigned numGenes = synthesisRateLevel[0].size();
 	for(unsigned category = 0u; category < numSelectionCategories; category++)
 	{
 		for(unsigned i = 0u; i < numGenes; i++)
 		{
-			currentSynthesisRateLevel[category][i] = expression[i];
-			std_phi[category][i] = 0.1;
-			numAcceptForSynthesisRate[category][i] = 0u;
+			synthesisRateLevel[category].setSynthesisRate(i, expression[i]);
+			synthesisRateLevel[category].getProposalWidths()[i] = 0.1;
+			synthesisRateLevel[category].getNumAccept()[i] = 0u;
 		}
 	}
 }
@@ -768,13 +773,13 @@ unsigned Parameter::getSynthesisRateCategory(unsigned mixtureElement)
 }
 
 
-std::vector<unsigned> Parameter::getMixtureElementsOfMutationCategory(unsigned category)
+std::vector<unsigned>& Parameter::getMixtureElementsOfMutationCategory(unsigned category)
 {
 	return mutationIsInMixture[category];
 }
 
 
-std::vector<unsigned> Parameter::getMixtureElementsOfSelectionCategory(unsigned category)
+std::vector<unsigned>& Parameter::getMixtureElementsOfSelectionCategory(unsigned category)
 {
 	return selectionIsInMixture[category];
 }
@@ -886,33 +891,44 @@ void Parameter::updateStdDevSynthesisRate()
 double Parameter::getSynthesisRate(unsigned geneIndex, unsigned mixtureElement, bool proposed)
 {
 	unsigned category = getSelectionCategory(mixtureElement);
-	return (proposed ? proposedSynthesisRateLevel[category][geneIndex] : currentSynthesisRateLevel[category][geneIndex]);
+	return synthesisRateLevel[category].getSynthesisRates(proposed)[geneIndex];
+}
+
+
+// Same as getSynthesisRate but returns log(phi). The log is cached alongside every phi value,
+// so the per-gene likelihood and prior evaluations do not have to call std::log again.
+double Parameter::getLogSynthesisRate(unsigned geneIndex, unsigned mixtureElement, bool proposed)
+{
+	unsigned category = getSelectionCategory(mixtureElement);
+	return synthesisRateLevel[category].getLogSynthesisRates(proposed)[geneIndex];
 }
 
 
 double Parameter::getCurrentSynthesisRateProposalWidth(unsigned expressionCategory, unsigned geneIndex)
 {
-	return std_phi[expressionCategory][geneIndex];
+	return synthesisRateLevel[expressionCategory].getProposalWidths()[geneIndex];
 }
 
 
 double Parameter::getSynthesisRateProposalWidth(unsigned geneIndex, unsigned mixtureElement)
 {
 	unsigned category = getSelectionCategory(mixtureElement);
-	return std_phi[category][geneIndex];
+	return synthesisRateLevel[category].getProposalWidths()[geneIndex];
 }
 
 
+// The standard normals of a category are drawn as one block (gene by gene, category by category,
+// as the random number generators are sequential). The log-normal transformation then runs over
+// each category block at once, see SynthesisRateBlock::propose.
 void Parameter::proposeSynthesisRateLevels()
 {
-	unsigned numSynthesisRateLevels = (unsigned) currentSynthesisRateLevel[0].size();
+	unsigned numSynthesisRateLevels = synthesisRateLevel[0].size();
+	std::vector<double> standardNormals(numSynthesisRateLevels);
 	for(unsigned category = 0; category < numSelectionCategories; category++)
 	{
-		for(unsigned i = 0u; i < numSynthesisRateLevels; i++)
-		{
-			// avoid adjusting probabilities for asymmetry of distribution
-			proposedSynthesisRateLevel[category][i] = std::exp( randNorm( std::log(currentSynthesisRateLevel[category][i]) , std_phi[category][i]) );
-		}
+		// avoid adjusting probabilities for asymmetry of distribution
+		randNormVector(numSynthesisRateLevels, 0.0, 1.0, standardNormals.data());
+		synthesisRateLevel[category].propose(standardNormals.data());
 	}
 }
 
@@ -920,7 +936,7 @@ void Parameter::proposeSynthesisRateLevels()
 void Parameter::setSynthesisRate(double phi, unsigned geneIndex, unsigned mixtureElement)
 {
 	unsigned category = getSelectionCategory(mixtureElement);
-	currentSynthesisRateLevel[category][geneIndex] = phi;
+	synthesisRateLevel[category].setSynthesisRate(geneIndex, phi);
 }
 
 
@@ -928,8 +944,7 @@ void Parameter::updateSynthesisRate(unsigned geneIndex)
 {
 	for(unsigned category = 0; category < numSelectionCategories; category++)
 	{
-		numAcceptForSynthesisRate[category][geneIndex]++;
-		currentSynthesisRateLevel[category][geneIndex] = proposedSynthesisRateLevel[category][geneIndex];
+		synthesisRateLevel[category].acceptProposal(geneIndex);
 	}
 }
 
@@ -937,8 +952,7 @@ void Parameter::updateSynthesisRate(unsigned geneIndex)
 void Parameter::updateSynthesisRate(unsigned geneIndex, unsigned mixtureElement)
 {
 	unsigned category = getSelectionCategory(mixtureElement);
-	numAcceptForSynthesisRate[category][geneIndex]++;
-	currentSynthesisRateLevel[category][geneIndex] = proposedSynthesisRateLevel[category][geneIndex];
+	synthesisRateLevel[category].acceptProposal(geneIndex);
 }
 
 
@@ -1063,6 +1077,30 @@ void Parameter::setTraceObject(Trace _trace)
 }
 
 
+void Parameter::setMappedTraceFilePrefix(std::string prefix)
+{
+	traces.setMappedTraceFilePrefix(prefix);
+}
+
+
+void Parameter::setTracePrecision(std::string family, std::string precision)
+{
+	traces.setTracePrecision(family, precision);
+}
+
+
+void Parameter::setPosteriorWindow(unsigned samples)
+{
+	traces.setPosteriorWindow(samples);
+}
+
+
+void Parameter::setTraceWriterSettings(std::string filename, unsigned chunkSize)
+{
+	traces.setTraceWriterSettings(filename, chunkSize);
+}
+
+
 void Parameter::updateStdDevSynthesisRateTrace(unsigned sample)
 {
 	for (unsigned i = 0u; i < numSelectionCategories; i++)
@@ -1074,7 +1112,7 @@ void Parameter::updateStdDevSynthesisRateTrace(unsigned sample)
 
 void Parameter::updateSynthesisRateTrace(unsigned sample, unsigned geneIndex)
 {
-	traces.updateSynthesisRateTrace(sample, geneIndex, currentSynthesisRateLevel);
+	traces.updateSynthesisRateTrace(sample, geneIndex, synthesisRateLevel);
 }
 
 
@@ -1118,22 +1156,24 @@ void Parameter::adaptSynthesisRateProposalWidth(unsigned adaptationWidth, bool a
 
 	for (unsigned cat = 0u; cat < numSelectionCategories; cat++)
 	{
-		unsigned numGenes = (unsigned)numAcceptForSynthesisRate[cat].size();
+		unsigned numGenes = synthesisRateLevel[cat].size();
+		unsigned *numAcceptForSynthesisRate = synthesisRateLevel[cat].getNumAccept();
+		double *std_phi = synthesisRateLevel[cat].getProposalWidths();
 		for (unsigned i = 0; i < numGenes; i++)
 		{
-			double acceptanceLevel = (double)numAcceptForSynthesisRate[cat][i] / (double)adaptationWidth;
+			double acceptanceLevel = (double)numAcceptForSynthesisRate[i] / (double)adaptationWidth;
 			traces.updateSynthesisRateAcceptanceRatioTrace(cat, i, acceptanceLevel);
 			if (adapt) {
 				if (acceptanceLevel < 0.225) {
-					std_phi[cat][i] *= 0.8;
+					std_phi[i] *= 0.8;
 					if (acceptanceLevel < 0.2) acceptanceUnder++;
 				}
 				if (acceptanceLevel > 0.275) {
-					std_phi[cat][i] *= 1.2;
+					std_phi[i] *= 1.2;
 					if (acceptanceLevel > 0.3) acceptanceOver++;
 				}
 			}
-			numAcceptForSynthesisRate[cat][i] = 0u;
+			numAcceptForSynthesisRate[i] = 0u;
 		}
 	}
 #ifndef STANDALONE
@@ -1151,7 +1191,6 @@ void Parameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptationWidt
 {
 	adaptiveStepPrev = adaptiveStepCurr;
 	adaptiveStepCurr = lastIteration;
-	unsigned samples = adaptiveStepCurr - adaptiveStepPrev;
 
 #ifndef STANDALONE
 	Rprintf("Acceptance rate for Codon Specific Parameter\n");
@@ -1181,14 +1220,14 @@ void Parameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptationWidt
                     for (unsigned k = aaStart; k < aaEnd; k++)
 					   covarianceMatrix[aaIndex] *= 0.8;
 				else 
-					covarianceMatrix[aaIndex].calculateSampleCovariance(*traces.getCodonSpecificParameterTrace(), aa, samples, adaptiveStepCurr);
+					covarianceMatrix[aaIndex].calculateSampleCovariance();
 
 				covarianceMatrix[aaIndex].choleskiDecomposition();
 				for (unsigned k = aaStart; k < aaEnd; k++)
 					std_csp[k] *= 0.8;
 			}
 			if (acceptanceLevel > 0.3) {
-				//covarianceMatrix[aaIndex].calculateSampleCovariance(*traces.getCodonSpecificParameterTrace(), aa, samples, adaptiveStepCurr);
+				//covarianceMatrix[aaIndex].calculateSampleCovariance();
 				covarianceMatrix[aaIndex] *= 1.2;
 				covarianceMatrix[aaIndex].choleskiDecomposition();
 				for (unsigned k = aaStart; k < aaEnd; k++)
@@ -1217,6 +1256,7 @@ void Parameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptationWidt
 			}
 		}
 		numAcceptForCodonSpecificParameters[aaIndex] = 0u;
+		covarianceMatrix[aaIndex].clearSamples(); // the sample covariance covers the samples since the last adaptation
 	}
 #ifndef STANDALONE
 	Rprintf("\n");
@@ -1225,6 +1265,32 @@ void Parameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptationWidt
 #endif
 }
 
+
+// Adds the current codon specific parameters of the grouping, of all parameter types and categories, as one sample
+// to the running covariance of its proposal covariance matrix (see adaptCodonSpecificParameterProposalWidth).
+// Called with every sample of the trace, so the adaptation does not have to read the trace back.
+void Parameter::updateCodonSpecificParameterCovariance(std::string grouping)
+{
+	unsigned aaIndex = SequenceSummary::AAToAAIndex(grouping);
+	unsigned aaStart;
+	unsigned aaEnd;
+	SequenceSummary::AAToCodonRange(grouping, aaStart, aaEnd, true);
+	std::vector<double> sample;
+	sample.reserve((unsigned)covarianceMatrix[aaIndex].getNumVariates());
+	for (unsigned paramType = 0u; paramType < currentCodonSpecificParameter.getNumParameterTypes(); paramType++)
+	{
+		CodonSpecificParameterSet::ParameterTypeView current = currentCodonSpecificParameter[paramType];
+		for (unsigned category = 0u; category < current.size(); category++)
+		{
+			for (unsigned i = aaStart; i < aaEnd; i++)
+			{
+				sample.push_back(current[category][i]);
+			}
+		}
+	}
+	covarianceMatrix[aaIndex].addSample(sample);
+}
+
 // ------------------------------------------------------------------//
 // ---------- Posterior, Variance, and Estimates Functions ----------//
 // ------------------------------------------------------------------//
@@ -1262,7 +1328,6 @@ double Parameter::getSynthesisRatePosteriorMean(unsigned samples, unsigned geneI
 {
 	unsigned expressionCategory = getSynthesisRateCategory(mixtureElement);
 	double posteriorMean = 0.0;
-	std::vector<double> synthesisRateTrace = traces.getSynthesisRateTraceByMixtureElementForGene(mixtureElement, geneIndex);
 	unsigned traceLength = lastIteration + 1;
 
 	if (samples > lastIteration)
@@ -1278,8 +1343,13 @@ double Parameter::getSynthesisRatePosteriorMean(unsigned samples, unsigned geneI
 		samples = traceLength;
 	}
 	unsigned start = traceLength - samples;
+	PosteriorAccumulator all, assigned;
+	if (traces.getSynthesisRateAccumulators(mixtureElement, geneIndex, start, traceLength, all, assigned))
+		return assigned.getMean();
+
 	unsigned category;
 	unsigned usedSamples = 0u;
+	std::vector<double> synthesisRateTrace = traces.getSynthesisRateTraceByMixtureElementForGene(mixtureElement, geneIndex);
 	std::vector<unsigned> mixtureAssignmentTrace = traces.getMixtureAssignmentTraceForGene(geneIndex);
 	for (unsigned i = start; i < traceLength; i++)
 	{
@@ -1295,13 +1365,49 @@ double Parameter::getSynthesisRatePosteriorMean(unsigned samples, unsigned geneI
 	return posteriorMean / (double)usedSamples;
 }
 
+
+// Posterior mean of log(phi), i.e. the log of the geometric mean, over the samples the gene was in the category.
+double Parameter::getLogSynthesisRatePosteriorMean(unsigned samples, unsigned geneIndex, unsigned mixtureElement)
+{
+	unsigned expressionCategory = getSynthesisRateCategory(mixtureElement);
+	double posteriorMean = 0.0;
+	unsigned traceLength = lastIteration + 1;
+
+	if (samples > lastIteration)
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in Parameter::getLogSynthesisRatePosteriorMean throws: Number of anticipated samples (%d) is greater than the length of the available trace (%d). Whole trace is used for posterior estimate! \n",
+			samples, traceLength);
+#else
+		std::cerr << "Warning in Parameter::getLogSynthesisRatePosteriorMean throws: Number of anticipated samples ("
+			<< samples << ") is greater than the length of the available trace (" << traceLength << ")."
+			<< "Whole trace is used for posterior estimate! \n";
+#endif
+		samples = traceLength;
+	}
+	unsigned start = traceLength - samples;
+	PosteriorAccumulator all, assigned;
+	if (traces.getSynthesisRateAccumulators(mixtureElement, geneIndex, start, traceLength, all, assigned))
+		return assigned.getLogMean();
+
+	unsigned usedSamples = 0u;
+	std::vector<double> synthesisRateTrace = traces.getSynthesisRateTraceByMixtureElementForGene(mixtureElement, geneIndex);
+	std::vector<unsigned> mixtureAssignmentTrace = traces.getMixtureAssignmentTraceForGene(geneIndex);
+	for (unsigned i = start; i < traceLength; i++)
+	{
+		if (getSynthesisRateCategory(mixtureAssignmentTrace[i]) == expressionCategory)
+		{
+			posteriorMean += std::log(synthesisRateTrace[i]);
+			usedSamples++;
+		}
+	}
+	return posteriorMean / (double)usedSamples;
+}
+
 double Parameter::getCodonSpecificPosteriorMean(unsigned mixtureElement, unsigned samples, std::string &codon, unsigned paramType,
 	bool withoutReference)
 {
 	double posteriorMean = 0.0;
-	std::vector<double> mutationParameterTrace = traces.getCodonSpecificParameterTraceByMixtureElementForCodon(
-		mixtureElement, codon, paramType, withoutReference);
-
 	unsigned traceLength = lastIteration + 1;
 
 	if (samples > traceLength)
@@ -1317,6 +1423,12 @@ double Parameter::getCodonSpecificPosteriorMean(unsigned mixtureElement, unsigne
 		samples = traceLength;
 	}
 	unsigned start = traceLength - samples;
+	PosteriorAccumulator accumulator;
+	if (traces.getCodonSpecificParameterAccumulator(mixtureElement, codon, paramType, withoutReference, start, traceLength,
+		accumulator)) return accumulator.getMean();
+
+	std::vector<double> mutationParameterTrace = traces.getCodonSpecificParameterTraceByMixtureElementForCodon(
+		mixtureElement, codon, paramType, withoutReference);
 	for (unsigned i = start; i < traceLength; i++)
 	{
 		posteriorMean += mutationParameterTrace[i];
@@ -1360,8 +1472,6 @@ double Parameter::getStdDevSynthesisRateVariance(unsigned samples, unsigned mixt
 double Parameter::getSynthesisRateVariance(unsigned samples, unsigned geneIndex, unsigned mixtureElement,
 	bool unbiased)
 {
-	std::vector<double> synthesisRateTrace = traces.getSynthesisRateTraceByMixtureElementForGene(mixtureElement,
-		geneIndex);
 	unsigned traceLength = lastIteration + 1;
 	if (samples > traceLength)
 	{
@@ -1382,11 +1492,21 @@ double Parameter::getSynthesisRateVariance(unsigned samples, unsigned geneIndex,
 	if (!std::isnan(posteriorMean))
 	{
 		unsigned start = traceLength - samples;
-		double difference;
-		for (unsigned i = start; i < traceLength; i++)
+		PosteriorAccumulator all, assigned;
+		if (traces.getSynthesisRateAccumulators(mixtureElement, geneIndex, start, traceLength, all, assigned))
 		{
-			difference = synthesisRateTrace[i] - posteriorMean;
-			posteriorVariance += difference * difference;
+			posteriorVariance = all.getSumOfSquaredDeviations(posteriorMean);
+		}
+		else
+		{
+			std::vector<double> synthesisRateTrace = traces.getSynthesisRateTraceByMixtureElementForGene(mixtureElement,
+				geneIndex);
+			double difference;
+			for (unsigned i = start; i < traceLength; i++)
+			{
+				difference = synthesisRateTrace[i] - posteriorMean;
+				posteriorVariance += difference * difference;
+			}
 		}
 	}
 	double normalizationTerm = unbiased ? (1 / ((double)samples - 1.0)) : (1 / (double)samples);
@@ -1397,8 +1517,6 @@ double Parameter::getSynthesisRateVariance(unsigned samples, unsigned geneIndex,
 double Parameter::getCodonSpecificVariance(unsigned mixtureElement, unsigned samples, std::string &codon, unsigned paramType, bool unbiased,
 	bool withoutReference)
 {
-	std::vector<double> parameterTrace = traces.getCodonSpecificParameterTraceByMixtureElementForCodon(
-		mixtureElement, codon, paramType, withoutReference);
 	unsigned traceLength = lastIteration + 1;
 	if (samples > traceLength)
 	{
@@ -1418,11 +1536,22 @@ double Parameter::getCodonSpecificVariance(unsigned mixtureElement, unsigned sam
 	double posteriorVariance = 0.0;
 
 	unsigned start = traceLength - samples;
-	double difference;
-	for (unsigned i = start; i < traceLength; i++)
+	PosteriorAccumulator accumulator;
+	if (traces.getCodonSpecificParameterAccumulator(mixtureElement, codon, paramType, withoutReference, start, traceLength,
+		accumulator))
 	{
-		difference = parameterTrace[i] - posteriorMean;
-		posteriorVariance += difference * difference;
+		posteriorVariance = accumulator.getSumOfSquaredDeviations(posteriorMean);
+	}
+	else
+	{
+		std::vector<double> parameterTrace = traces.getCodonSpecificParameterTraceByMixtureElementForCodon(
+			mixtureElement, codon, paramType, withoutReference);
+		double difference;
+		for (unsigned i = start; i < traceLength; i++)
+		{
+			difference = parameterTrace[i] - posteriorMean;
+			posteriorVariance += difference * difference;
+		}
 	}
 	double normalizationTerm = unbiased ? (1 / ((double)samples - 1.0)) : (1 / (double)samples);
 	return normalizationTerm * posteriorVariance;
@@ -1449,7 +1578,6 @@ unsigned Parameter::getEstimatedMixtureAssignment(unsigned samples, unsigned gen
 
 std::vector<double> Parameter::getEstimatedMixtureAssignmentProbabilities(unsigned samples, unsigned geneIndex)
 {
-	std::vector<unsigned> mixtureAssignmentTrace = traces.getMixtureAssignmentTraceForGene(geneIndex);
 	std::vector<double> probabilities(numMixtures, 0.0);
 	unsigned traceLength = lastIteration + 1;
 
@@ -1468,15 +1596,10 @@ std::vector<double> Parameter::getEstimatedMixtureAssignmentProbabilities(unsign
 	}
 
 	unsigned start = traceLength - samples;
-	for (unsigned i = start; i < traceLength; i++)
+	std::vector<unsigned> counts = traces.getMixtureAssignmentCounts(geneIndex, start, traceLength);
+	for (unsigned i = 0; i < numMixtures && i < counts.size(); i++)
 	{
-		unsigned value = mixtureAssignmentTrace[i];
-		probabilities[value]++;
-	}
-
-	for (unsigned i = 0; i < numMixtures; i++)
-	{
-		probabilities[i] /= (double)samples;
+		probabilities[i] = counts[i] / (double)samples;
 	}
 	return probabilities;
 }
@@ -1631,6 +1754,24 @@ double Parameter::calculateSCUO(Gene& gene, unsigned maxAA)
 }
 
 
+#ifdef STANDALONE
+// Seeds the generator of the calling thread (stream 0, as the main thread) and the default streams of threads that
+// start drawing afterwards. R runs use set.seed instead.
+void Parameter::setSeed(uint64_t _seed)
+{
+	seed = _seed;
+	generator.seed(seed);
+}
+
+
+RandomStream Parameter::createThreadGenerator()
+{
+	uint32_t stream = (std::this_thread::get_id() == mainThreadId) ? 0u : nextThreadStream++;
+	return RandomStream(seed, 0u, stream);
+}
+#endif
+
+
 void Parameter::drawIidRandomVector(unsigned draws, double mean, double sd, double (*proposal)(double a, double b), double* randomNumbers)
 {
 	for(unsigned i = 0u; i < draws; i++)
@@ -1658,8 +1799,7 @@ double Parameter::randNorm(double mean, double sd)
 	xx = rnorm(1, mean, sd);
 	rv = xx[0];
 #else
-	std::normal_distribution<double> distribution(mean, sd);
-	rv = distribution(generator);
+	rv = mean + sd * generator.nextNorm();
 #endif
 	return rv;
 }
@@ -1674,8 +1814,7 @@ double Parameter::randLogNorm(double m, double s)
 	xx = rlnorm(1, m, s);
 	rv = xx[0];
 #else
-	std::lognormal_distribution<double> distribution(m, s);
-	rv = distribution(generator);
+	rv = std::exp(m + s * generator.nextNorm());
 #endif
 	return rv;
 }
@@ -1690,8 +1829,7 @@ double Parameter::randExp(double r)
 	xx = rexp(1, r);
 	rv = xx[0];
 #else
-	std::exponential_distribution<double> distribution(r);
-	rv = distribution(generator);
+	rv = generator.nextExp() / r;
 #endif
 	return rv;
 }
@@ -1755,8 +1893,7 @@ double Parameter::randUnif(double minVal, double maxVal)
 	xx = runif(1, minVal, maxVal);
 	rv = xx[0];
 #else
-	std::uniform_real_distribution<double> distribution(minVal, maxVal);
-	rv = distribution(generator);
+	rv = minVal + (maxVal - minVal) * generator.nextUnif();
 #endif
 	return rv;
 }
@@ -1764,15 +1901,6 @@ double Parameter::randUnif(double minVal, double maxVal)
 
 unsigned Parameter::randMultinom(double* probabilities, unsigned mixtureElements)
 {
-	// calculate cummulative sum to determine group boundaries
-	double* cumsum = new double[mixtureElements]();
-	//std::vector<double> cumsum(groups);
-	cumsum[0] = probabilities[0];
-
-	for(unsigned i = 1u; i < mixtureElements; i++)
-	{
-		cumsum[i] = cumsum[i-1u] + probabilities[i];
-	}
 	// draw random number from U(0,1)
 	double referenceValue;
 #ifndef STANDALONE
@@ -1781,24 +1909,70 @@ unsigned Parameter::randMultinom(double* probabilities, unsigned mixtureElements
 	xx = runif(1, 0, 1);
 	referenceValue = xx[0];
 #else
-	std::uniform_real_distribution<double> distribution(0, 1);
-	referenceValue = distribution(generator);
+	referenceValue = generator.nextUnif();
 #endif
-	// check in which category the element falls
+	return randMultinom(probabilities, mixtureElements, referenceValue);
+}
+
+
+// Same as above for a U(0,1) number that has already been drawn, e.g. with randUnifVector.
+unsigned Parameter::randMultinom(double* probabilities, unsigned mixtureElements, double referenceValue)
+{
+	// check in which category the element falls, using the cummulative sum as group boundaries
+	double cumsum = 0.0;
 	unsigned returnValue = 0u;
 	for (unsigned i = 0u; i < mixtureElements; i++)
 	{
-		if (referenceValue <= cumsum[i])
+		cumsum += probabilities[i];
+		if (referenceValue <= cumsum)
 		{
 			returnValue = i;
 			break;
 		}
 	}
-	delete [] cumsum;
 	return returnValue;
 }
 
 
+// Batched versions of randNorm, randExp and randUnif. They fill draws values with a single call
+// into the generator (one RNGScope for R), which is much cheaper than draws scalar calls.
+// The values are the same as the scalar calls would give in that order.
+void Parameter::randNormVector(unsigned draws, double mean, double sd, double* randomNumbers)
+{
+#ifndef STANDALONE
+	RNGScope scope;
+	NumericVector xx = rnorm(draws, mean, sd);
+	std::copy(xx.begin(), xx.end(), randomNumbers);
+#else
+	generator.fillNorm(randomNumbers, draws, mean, sd);
+#endif
+}
+
+
+void Parameter::randExpVector(unsigned draws, double r, double* randomNumbers)
+{
+#ifndef STANDALONE
+	RNGScope scope;
+	NumericVector xx = rexp(draws, r);
+	std::copy(xx.begin(), xx.end(), randomNumbers);
+#else
+	generator.fillExp(randomNumbers, draws, r);
+#endif
+}
+
+
+void Parameter::randUnifVector(unsigned draws, double minVal, double maxVal, double* randomNumbers)
+{
+#ifndef STANDALONE
+	RNGScope scope;
+	NumericVector xx = runif(draws, minVal, maxVal);
+	std::copy(xx.begin(), xx.end(), randomNumbers);
+#else
+	generator.fillUnif(randomNumbers, draws, minVal, maxVal);
+#endif
+}
+
+
 double Parameter::densityNorm(double x, double mean, double sd, bool log)
 {
 	const double inv_sqrt_2pi = 0.3989422804014327;
@@ -1824,6 +1998,50 @@ double Parameter::densityLogNorm(double x, double mean, double sd, bool log)
 }
 
 
+// densityLogNorm for a value already given on the log scale (logX = log(x)).
+// Saves the std::log(x) call when log(x) is cached, e.g. for the synthesis rates.
+double Parameter::densityLogNormLogScale(double logX, double mean, double sd, bool log)
+{
+	const double inv_sqrt_2pi = 0.3989422804014327;
+	const double log_sqrt_2pi = 0.9189385332046727;
+	double a = (logX - mean) / sd;
+	return log ? (-logX - std::log(sd) - log_sqrt_2pi - (0.5 * a * a)) : ((inv_sqrt_2pi / (std::exp(logX) * sd)) * std::exp(-0.5 * a * a));
+}
+
+
+// Returns lgamma(x + n) - lgamma(x) for integer n.
+// For small n the recurrence lgamma(x + 1) = lgamma(x) + log(x) is used, multiplying up
+// to eight factors before taking a log so the product can not overflow for any sensible x.
+// Relative error is within a few ulp of the difference of two std::lgamma calls.
+double Parameter::logGammaRatio(double x, unsigned n)
+{
+	if (n > logGammaRecurrenceLimit || x > 1e6)
+		return std::lgamma(x + n) - std::lgamma(x);
+
+	double returnValue = 0.0;
+	unsigned k = 0u;
+	for (; k + 8u <= n; k += 8u)
+	{
+		double y = x + k;
+		returnValue += std::log(y * (y + 1.0) * (y + 2.0) * (y + 3.0) * (y + 4.0) * (y + 5.0) * (y + 6.0) * (y + 7.0));
+	}
+	double product = 1.0;
+	for (; k < n; k++)
+		product *= x + k;
+	return returnValue + std::log(product);
+}
+
+
+// Same as above but with lgamma(x) already known (e.g. from a table), so the fallback
+// for large n only needs a single std::lgamma call.
+double Parameter::logGammaRatio(double x, unsigned n, double lgammaX)
+{
+	if (n > logGammaRecurrenceLimit || x > 1e6)
+		return std::lgamma(x + n) - lgammaX;
+	return logGammaRatio(x, n);
+}
+
+
 
 
 
@@ -1965,6 +2183,11 @@ void Parameter::setNumSelectionCategories(unsigned _numSelectionCategories)
 
 std::vector<std::vector<double>> Parameter::getSynthesisRateR()
 {
+	std::vector<std::vector<double>> currentSynthesisRateLevel(synthesisRateLevel.size());
+	for (unsigned category = 0u; category < synthesisRateLevel.size(); category++)
+	{
+		currentSynthesisRateLevel[category] = synthesisRateLevel[category].getSynthesisRateVector();
+	}
 	return currentSynthesisRateLevel;
 }
 
@@ -1983,7 +2206,7 @@ std::vector<double> Parameter::getCurrentSynthesisRateForMixture(unsigned mixtur
 		std::cerr << "WARNING: Mixture element " << mixture << " NOT found. Mixture element 1 is returned instead. \n";
 #endif
 	}
-	return currentSynthesisRateLevel[exprCat];
+	return synthesisRateLevel[exprCat].getSynthesisRateVector();
 }
 
 
@@ -2036,6 +2259,20 @@ double Parameter::getSynthesisRatePosteriorMeanByMixtureElementForGene(unsigned
 }
 
 
+double Parameter::getLogSynthesisRatePosteriorMeanByMixtureElementForGene(unsigned samples, unsigned geneIndex,
+	unsigned mixtureElement)
+{
+	double rv = std::numeric_limits<double>::quiet_NaN();
+	bool checkGene = checkIndex(geneIndex, 1, (unsigned) mixtureAssignment.size());
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, numMixtures);
+	if (checkGene && checkMixtureElement)
+	{
+		rv = getLogSynthesisRatePosteriorMean(samples, geneIndex - 1, mixtureElement - 1);
+	}
+	return rv;
+}
+
+
 double Parameter::getSynthesisRateVarianceByMixtureElementForGene(unsigned samples, unsigned geneIndex, unsigned mixtureElement, bool unbiased)
 {
 	double rv = -1.0;
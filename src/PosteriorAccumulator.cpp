@@ -0,0 +1,94 @@
+#include "include/PosteriorAccumulator.h"
+
+#include <cmath>
+#include <limits>
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+PosteriorAccumulator::PosteriorAccumulator()
+{
+	clear();
+}
+
+
+PosteriorAccumulator::~PosteriorAccumulator()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Update Functions ----------//
+//--------------------------------------//
+
+
+void PosteriorAccumulator::clear()
+{
+	numSamples = 0u;
+	mean = 0.0;
+	sumOfSquaredDeviations = 0.0;
+	sumOfLogs = 0.0;
+}
+
+
+void PosteriorAccumulator::add(double x)
+{
+	numSamples++;
+	double delta = x - mean;
+	mean += delta / numSamples;
+	sumOfSquaredDeviations += delta * (x - mean);
+	sumOfLogs += std::log(x);
+}
+
+
+
+
+
+//-----------------------------------------//
+//---------- Posterior Functions ----------//
+//-----------------------------------------//
+
+
+unsigned PosteriorAccumulator::getNumSamples()
+{
+	return numSamples;
+}
+
+
+// NaN without samples.
+double PosteriorAccumulator::getMean()
+{
+	if (numSamples == 0u) return std::numeric_limits<double>::quiet_NaN();
+	return mean;
+}
+
+
+// Mean of the log values, NaN without samples or if a value was not positive.
+double PosteriorAccumulator::getLogMean()
+{
+	if (numSamples == 0u) return std::numeric_limits<double>::quiet_NaN();
+	return sumOfLogs / numSamples;
+}
+
+
+double PosteriorAccumulator::getVariance(bool unbiased)
+{
+	double normalizationTerm = unbiased ? (1 / ((double)numSamples - 1.0)) : (1 / (double)numSamples);
+	return normalizationTerm * sumOfSquaredDeviations;
+}
+
+
+// Sum of (x - center)^2 over the samples.
+double PosteriorAccumulator::getSumOfSquaredDeviations(double center)
+{
+	double difference = mean - center;
+	return sumOfSquaredDeviations + numSamples * difference * difference;
+}
@@ -12,6 +12,8 @@ RCPP_EXPOSED_CLASS(Genome)
 RCPP_MODULE(Model_mod)
 {
 	class_<Model>("Model")
+		.method("getInverseTemperature", &Model::getInverseTemperature)
+		.method("setInverseTemperature", &Model::setInverseTemperature)
 		;
 
 	class_<ROCModel>( "ROCModel" )
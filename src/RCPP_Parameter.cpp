@@ -43,6 +43,10 @@ RCPP_MODULE(Parameter_mod)
 		//Trace Functions:
 		.method("getTraceObject", &Parameter::getTraceObject) //TODO: only used in R?
 		.method("setTraceObject", &Parameter::setTraceObject)
+		.method("setMappedTraceFilePrefix", &Parameter::setMappedTraceFilePrefix)
+		.method("setTraceWriterSettings", &Parameter::setTraceWriterSettings)
+		.method("setTracePrecision", &Parameter::setTracePrecision)
+		.method("setPosteriorWindow", &Parameter::setPosteriorWindow)
 
 		//Synthesis Rate Functions:
 		.method("getSynthesisRate", &Parameter::getSynthesisRateR)
@@ -54,6 +58,7 @@ RCPP_MODULE(Parameter_mod)
 
 		//Posterior, Variance, and Estimates Functions:
 		.method("getSynthesisRatePosteriorMeanByMixtureElementForGene", &Parameter::getSynthesisRatePosteriorMeanByMixtureElementForGene)
+		.method("getLogSynthesisRatePosteriorMeanByMixtureElementForGene", &Parameter::getLogSynthesisRatePosteriorMeanByMixtureElementForGene)
 		.method("getSynthesisRateVarianceByMixtureElementForGene", &Parameter::getSynthesisRateVarianceByMixtureElementForGene)
 		.method("getEstimatedMixtureAssignmentForGene", &Parameter::getEstimatedMixtureAssignmentForGene, "returns the mixture assignment for a given gene")
 		.method("getEstimatedMixtureAssignmentProbabilitiesForGene", &Parameter::getEstimatedMixtureAssignmentProbabilitiesForGene, "returns the probabilities assignment for a given gene")
@@ -27,6 +27,25 @@ RCPP_MODULE(Trace_mod)
     .method("getMixtureProbabilitiesTraceForMixture", &Trace::getMixtureProbabilitiesTraceForMixtureR)
     .method("getStdDevSynthesisRateTraces", &Trace::getStdDevSynthesisRateTraces)
     .method("getNumberOfMixtures", &Trace::getNumberOfMixtures)
+    .method("getMappedTraceFilePrefix", &Trace::getMappedTraceFilePrefix)
+    .method("getTraceWriterFile", &Trace::getTraceWriterFile)
+    .method("getTracePrecision", &Trace::getTracePrecision)
+
+
+    //Statistics Functions:
+    .method("getStdDevSynthesisRateEffectiveSampleSize", &Trace::getStdDevSynthesisRateEffectiveSampleSizeR)
+    .method("getStdDevSynthesisRateMonteCarloStandardError", &Trace::getStdDevSynthesisRateMonteCarloStandardErrorR)
+    .method("getSynthesisRateEffectiveSampleSize", &Trace::getSynthesisRateEffectiveSampleSizeR)
+    .method("getSynthesisRateMonteCarloStandardError", &Trace::getSynthesisRateMonteCarloStandardErrorR)
+    .method("getMixtureProbabilitiesEffectiveSampleSize", &Trace::getMixtureProbabilitiesEffectiveSampleSizeR)
+    .method("getMixtureProbabilitiesMonteCarloStandardError", &Trace::getMixtureProbabilitiesMonteCarloStandardErrorR)
+    .method("getCodonSpecificParameterEffectiveSampleSize", &Trace::getCodonSpecificParameterEffectiveSampleSizeR)
+    .method("getCodonSpecificParameterMonteCarloStandardError", &Trace::getCodonSpecificParameterMonteCarloStandardErrorR)
+    .method("getSynthesisOffsetEffectiveSampleSize", &Trace::getSynthesisOffsetEffectiveSampleSizeR)
+    .method("getSynthesisOffsetMonteCarloStandardError", &Trace::getSynthesisOffsetMonteCarloStandardErrorR)
+    .method("getObservedSynthesisNoiseEffectiveSampleSize", &Trace::getObservedSynthesisNoiseEffectiveSampleSizeR)
+    .method("getObservedSynthesisNoiseMonteCarloStandardError", &Trace::getObservedSynthesisNoiseMonteCarloStandardErrorR)
+    .method("getMinimumEffectiveSampleSize", &Trace::getMinimumEffectiveSampleSize)
     
 
     //Setter Functions:
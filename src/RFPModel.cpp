@@ -1,5 +1,7 @@
 #include "include/RFP/RFPModel.h"
 
+#include <algorithm>
+
 //R runs only
 #ifndef STANDALONE
 #include <Rcpp.h>
@@ -29,12 +31,20 @@ RFPModel::~RFPModel()
 
 
 
+// lgamma(n * alpha + RFPObserved) - lgamma(n * alpha) is evaluated by Parameter::logGammaRatio.
+// If lgammaAlphaTable is given it has to hold lgamma(n * currAlpha) for n < lgammaTableSize,
+// which saves one std::lgamma call whenever the RFP count is too large for the recurrence.
 double RFPModel::calculateLogLikelihoodPerCodonPerGene(double currAlpha, double currLambdaPrime,
-													   unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue)
+													   unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue, double logPhiValue,
+													   const double *lgammaAlphaTable)
 {
-	double logLikelihood = ((std::lgamma((currNumCodonsInMRNA * currAlpha) + currRFPObserved)) - (std::lgamma(currNumCodonsInMRNA * currAlpha)))
-						   + (currRFPObserved * (std::log(phiValue) - std::log(currLambdaPrime + phiValue))) + ((currNumCodonsInMRNA * currAlpha) * (std::log(currLambdaPrime) -
-																																					 std::log(currLambdaPrime + phiValue)));
+	double alphaCount = currNumCodonsInMRNA * currAlpha;
+	double logLambdaPrimePhi = std::log(currLambdaPrime + phiValue);
+	double logGammaTerm = (lgammaAlphaTable != NULL && currNumCodonsInMRNA < lgammaTableSize)
+		? Parameter::logGammaRatio(alphaCount, currRFPObserved, lgammaAlphaTable[currNumCodonsInMRNA])
+		: Parameter::logGammaRatio(alphaCount, currRFPObserved);
+	double logLikelihood = logGammaTerm + (currRFPObserved * (logPhiValue - logLambdaPrimePhi))
+						   + (alphaCount * (std::log(currLambdaPrime) - logLambdaPrimePhi));
 
 	return logLikelihood;
 }
@@ -61,34 +71,44 @@ void RFPModel::calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneIndex
 
 	double phiValue = parameter->getSynthesisRate(geneIndex, synthesisRateCategory, false);
 	double phiValue_proposed = parameter->getSynthesisRate(geneIndex, synthesisRateCategory, true);
+	double logPhiValue = parameter->getLogSynthesisRate(geneIndex, synthesisRateCategory, false);
+	double logPhiValue_proposed = parameter->getLogSynthesisRate(geneIndex, synthesisRateCategory, true);
 
+	int numGroupings = (int)groupListCodonIndex.size();
+	// the codon terms are added up in grouping order after the loop, so the result does not depend on the number of threads
+	double groupingLogLikelihoods[2 * maxGroupings] = {0.0};
 #ifndef __APPLE__
-#pragma omp parallel for reduction(+:logLikelihood,logLikelihood_proposed)
+#pragma omp parallel for
 #endif
-	for (int index = 0; index < getGroupListSize(); index++) //number of codons, without the stop codons
+	for (int i = 0; i < numGroupings; i++) //number of codons, without the stop codons
 	{
-		std::string codon = getGrouping(index);
-
-		double currAlpha = getParameterForCategory(alphaCategory, RFPParameter::alp, codon, false);
-		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, RFPParameter::lmPri, codon, false);
-		unsigned currRFPObserved = gene.geneData.getRFPObserved(index);
+		unsigned index = groupListCodonIndex[i];
 
 		unsigned currNumCodonsInMRNA = gene.geneData.getCodonCountForCodon(index);
 		if (currNumCodonsInMRNA == 0) continue;
 
-		logLikelihood += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue);
-		logLikelihood_proposed += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue_proposed);
+		double currAlpha = getParameterForCategory(alphaCategory, RFPParameter::alp, index, false);
+		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, RFPParameter::lmPri, index, false);
+		unsigned currRFPObserved = gene.geneData.getRFPObserved(index);
+
+		groupingLogLikelihoods[2 * i] = calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue, logPhiValue);
+		groupingLogLikelihoods[2 * i + 1] = calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue_proposed, logPhiValue_proposed);
+	}
+	for (int i = 0; i < numGroupings; i++)
+	{
+		logLikelihood += groupingLogLikelihoods[2 * i];
+		logLikelihood_proposed += groupingLogLikelihoods[2 * i + 1];
 	}
 
 	double stdDevSynthesisRate = parameter->getStdDevSynthesisRate(false);
-	double logPhiProbability = Parameter::densityLogNorm(phiValue, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
-	double logPhiProbability_proposed = Parameter::densityLogNorm(phiValue_proposed, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
-	double currentLogLikelihood = (logLikelihood + logPhiProbability);
-	double proposedLogLikelihood = (logLikelihood_proposed + logPhiProbability_proposed);
-
-	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (std::log(phiValue) - std::log(phiValue_proposed));
-	logProbabilityRatio[1] = currentLogLikelihood - std::log(phiValue_proposed);
-	logProbabilityRatio[2] = proposedLogLikelihood - std::log(phiValue);
+	double logPhiProbability = Parameter::densityLogNormLogScale(logPhiValue, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
+	double logPhiProbability_proposed = Parameter::densityLogNormLogScale(logPhiValue_proposed, (-(stdDevSynthesisRate * stdDevSynthesisRate) / 2), stdDevSynthesisRate, true);
+	double currentLogLikelihood = (inverseTemperature * logLikelihood + logPhiProbability);
+	double proposedLogLikelihood = (inverseTemperature * logLikelihood_proposed + logPhiProbability_proposed);
+
+	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (logPhiValue - logPhiValue_proposed);
+	logProbabilityRatio[1] = currentLogLikelihood - logPhiValue_proposed;
+	logProbabilityRatio[2] = proposedLogLikelihood - logPhiValue;
 	logProbabilityRatio[3] = currentLogLikelihood;
 	logProbabilityRatio[4] = proposedLogLikelihood;
 }
@@ -101,13 +121,43 @@ void RFPModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string gro
 	Gene *gene;
 	unsigned index = SequenceSummary::codonToIndex(grouping);
 
+	// the parameters only depend on the category for this codon, look them up once for all genes
+	// and tabulate lgamma(n * alpha) for the current and proposed alpha
+	unsigned numAlphaCategories = parameter->getNumMutationCategories();
+	unsigned numLambdaPrimeCategories = parameter->getNumSelectionCategories();
+	std::vector<double> currAlpha(numAlphaCategories), propAlpha(numAlphaCategories);
+	std::vector<double> currLambdaPrime(numLambdaPrimeCategories), propLambdaPrime(numLambdaPrimeCategories);
+	std::vector<double> lgammaCurrAlpha(numAlphaCategories * lgammaTableSize, 0.0);
+	std::vector<double> lgammaPropAlpha(numAlphaCategories * lgammaTableSize, 0.0);
+	for (unsigned category = 0u; category < numAlphaCategories; category++)
+	{
+		currAlpha[category] = getParameterForCategory(category, RFPParameter::alp, index, false);
+		propAlpha[category] = getParameterForCategory(category, RFPParameter::alp, index, true);
+		for (unsigned n = 1u; n < lgammaTableSize; n++)
+		{
+			lgammaCurrAlpha[category * lgammaTableSize + n] = std::lgamma(n * currAlpha[category]);
+			lgammaPropAlpha[category * lgammaTableSize + n] = std::lgamma(n * propAlpha[category]);
+		}
+	}
+	for (unsigned category = 0u; category < numLambdaPrimeCategories; category++)
+	{
+		currLambdaPrime[category] = getParameterForCategory(category, RFPParameter::lmPri, index, false);
+		propLambdaPrime[category] = getParameterForCategory(category, RFPParameter::lmPri, index, true);
+	}
 
+	// the gene terms are added up in gene order after the loop, so the result does not depend on the number of threads
+	int numGenes = genome.getGenomeSize();
+	std::vector<double> geneLogLikelihoods(2 * numGenes, 0.0);
 #ifndef __APPLE__
-#pragma omp parallel for private(gene) reduction(+:logLikelihood,logLikelihood_proposed)
+#pragma omp parallel for private(gene)
 #endif
-	for (int i = 0u; i < genome.getGenomeSize(); i++)
+	for (int i = 0u; i < numGenes; i++)
 	{
 		gene = &genome.getGene(i);
+		unsigned currNumCodonsInMRNA = gene->geneData.getCodonCountForCodon(index);
+		if (currNumCodonsInMRNA == 0) continue;
+		unsigned currRFPObserved = gene->geneData.getRFPObserved(index);
+
 		// which mixture element does this gene belong to
 		unsigned mixtureElement = parameter->getMixtureAssignment(i);
 		// how is the mixture element defined. Which categories make it up
@@ -116,29 +166,138 @@ void RFPModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string gro
 		unsigned synthesisRateCategory = parameter->getSynthesisRateCategory(mixtureElement);
 		// get non codon specific values, calculate likelihood conditional on these
 		double phiValue = parameter->getSynthesisRate(i, synthesisRateCategory, false);
-		unsigned currRFPObserved = gene->geneData.getRFPObserved(index);
-		unsigned currNumCodonsInMRNA = gene->geneData.getCodonCountForCodon(index);
-		if (currNumCodonsInMRNA == 0) continue;
+		double logPhiValue = parameter->getLogSynthesisRate(i, synthesisRateCategory, false);
 
+		geneLogLikelihoods[2 * i] = calculateLogLikelihoodPerCodonPerGene(currAlpha[alphaCategory], currLambdaPrime[lambdaPrimeCategory],
+				currRFPObserved, currNumCodonsInMRNA, phiValue, logPhiValue, &lgammaCurrAlpha[alphaCategory * lgammaTableSize]);
+		geneLogLikelihoods[2 * i + 1] = calculateLogLikelihoodPerCodonPerGene(propAlpha[alphaCategory], propLambdaPrime[lambdaPrimeCategory],
+				currRFPObserved, currNumCodonsInMRNA, phiValue, logPhiValue, &lgammaPropAlpha[alphaCategory * lgammaTableSize]);
+	}
+	for (int i = 0; i < numGenes; i++)
+	{
+		logLikelihood += geneLogLikelihoods[2 * i];
+		logLikelihood_proposed += geneLogLikelihoods[2 * i + 1];
+	}
+	logAcceptanceRatioForAllMixtures = inverseTemperature * (logLikelihood_proposed - logLikelihood);
+}
 
-		double currAlpha = getParameterForCategory(alphaCategory, RFPParameter::alp, grouping, false);
-		double currLambdaPrime = getParameterForCategory(lambdaPrimeCategory, RFPParameter::lmPri, grouping, false);
 
-		double propAlpha = getParameterForCategory(alphaCategory, RFPParameter::alp, grouping, true);
-		double propLambdaPrime = getParameterForCategory(lambdaPrimeCategory, RFPParameter::lmPri, grouping, true);
+// Blocked version of calculateLogLikelihoodRatioPerGroupingPerCategory: the codons are independent given
+// phi and the mixture assignment, so every gene is visited once and contributes to the ratios of all codons.
+// The genes are split into chunks of codonSpecificChunkSize genes with their own partial sums, which are
+// added up in chunk order, so the result does not depend on the number of threads.
+void RFPModel::calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios)
+{
+	prepareCodonSpecificParameterTables();
 
+	unsigned numGroupings = (unsigned)groupListCodonIndex.size();
+	int numGenes = genome.getGenomeSize();
+	int numChunks = (numGenes + codonSpecificChunkSize - 1) / codonSpecificChunkSize;
+	std::vector<double> chunkLogLikelihoods(numChunks * 2 * numGroupings, 0.0);
 
-		logLikelihood += calculateLogLikelihoodPerCodonPerGene(currAlpha, currLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue);
-		logLikelihood_proposed += calculateLogLikelihoodPerCodonPerGene(propAlpha, propLambdaPrime, currRFPObserved, currNumCodonsInMRNA, phiValue);
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int c = 0; c < numChunks; c++)
+	{
+		int end = std::min((c + 1) * (int)codonSpecificChunkSize, numGenes);
+		for (int i = c * codonSpecificChunkSize; i < end; i++)
+		{
+			addGeneToCodonSpecificLogLikelihoods(genome.getGene(i), i, &chunkLogLikelihoods[c * 2 * numGroupings]);
+		}
+	}
+
+	logAcceptanceRatios.assign(numGroupings, 0.0);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		double logLikelihood = 0.0;
+		double logLikelihood_proposed = 0.0;
+		for (int c = 0; c < numChunks; c++)
+		{
+			logLikelihood += chunkLogLikelihoods[(c * numGroupings + g) * 2];
+			logLikelihood_proposed += chunkLogLikelihoods[(c * numGroupings + g) * 2 + 1];
+		}
+		logAcceptanceRatios[g] = inverseTemperature * (logLikelihood_proposed - logLikelihood);
+	}
+}
+
+
+// Looks up the current and proposed alpha and lambda prime of every grouping and category once per
+// update instead of once per gene, together with the lgamma tables of calculateLogLikelihoodPerCodonPerGene.
+void RFPModel::prepareCodonSpecificParameterTables()
+{
+	unsigned numGroupings = (unsigned)groupListCodonIndex.size();
+	unsigned numAlphaCategories = parameter->getNumMutationCategories();
+	unsigned numLambdaPrimeCategories = parameter->getNumSelectionCategories();
+
+	tableAlpha.resize(numGroupings * numAlphaCategories);
+	tableAlpha_proposed.resize(numGroupings * numAlphaCategories);
+	tableLambdaPrime.resize(numGroupings * numLambdaPrimeCategories);
+	tableLambdaPrime_proposed.resize(numGroupings * numLambdaPrimeCategories);
+	tableLgammaAlpha.assign(numGroupings * numAlphaCategories * lgammaTableSize, 0.0);
+	tableLgammaAlpha_proposed.assign(numGroupings * numAlphaCategories * lgammaTableSize, 0.0);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		unsigned index = groupListCodonIndex[g];
+		for (unsigned category = 0u; category < numAlphaCategories; category++)
+		{
+			unsigned c = g * numAlphaCategories + category;
+			tableAlpha[c] = getParameterForCategory(category, RFPParameter::alp, index, false);
+			tableAlpha_proposed[c] = getParameterForCategory(category, RFPParameter::alp, index, true);
+			for (unsigned n = 1u; n < lgammaTableSize; n++)
+			{
+				tableLgammaAlpha[c * lgammaTableSize + n] = std::lgamma(n * tableAlpha[c]);
+				tableLgammaAlpha_proposed[c * lgammaTableSize + n] = std::lgamma(n * tableAlpha_proposed[c]);
+			}
+		}
+		for (unsigned category = 0u; category < numLambdaPrimeCategories; category++)
+		{
+			unsigned c = g * numLambdaPrimeCategories + category;
+			tableLambdaPrime[c] = getParameterForCategory(category, RFPParameter::lmPri, index, false);
+			tableLambdaPrime_proposed[c] = getParameterForCategory(category, RFPParameter::lmPri, index, true);
+		}
+	}
+}
+
+
+// Adds the gene to the current (2 * grouping) and proposed (2 * grouping + 1) log likelihood of every grouping,
+// using the tables of prepareCodonSpecificParameterTables.
+void RFPModel::addGeneToCodonSpecificLogLikelihoods(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods)
+{
+	unsigned numAlphaCategories = parameter->getNumMutationCategories();
+	unsigned numLambdaPrimeCategories = parameter->getNumSelectionCategories();
+
+	// which mixture element does this gene belong to
+	unsigned mixtureElement = parameter->getMixtureAssignment(geneIndex);
+	// how is the mixture element defined. Which categories make it up
+	unsigned alphaCategory = parameter->getMutationCategory(mixtureElement);
+	unsigned lambdaPrimeCategory = parameter->getSelectionCategory(mixtureElement);
+	unsigned synthesisRateCategory = parameter->getSynthesisRateCategory(mixtureElement);
+	// get non codon specific values, calculate likelihood conditional on these
+	double phiValue = parameter->getSynthesisRate(geneIndex, synthesisRateCategory, false);
+	double logPhiValue = parameter->getLogSynthesisRate(geneIndex, synthesisRateCategory, false);
+
+	for (unsigned g = 0u; g < groupListCodonIndex.size(); g++)
+	{
+		unsigned index = groupListCodonIndex[g];
+		unsigned currNumCodonsInMRNA = gene.geneData.getCodonCountForCodon(index);
+		if (currNumCodonsInMRNA == 0) continue;
+		unsigned currRFPObserved = gene.geneData.getRFPObserved(index);
+
+		unsigned a = g * numAlphaCategories + alphaCategory;
+		unsigned l = g * numLambdaPrimeCategories + lambdaPrimeCategory;
+		codonSpecificLogLikelihoods[2 * g] += calculateLogLikelihoodPerCodonPerGene(tableAlpha[a], tableLambdaPrime[l],
+				currRFPObserved, currNumCodonsInMRNA, phiValue, logPhiValue, &tableLgammaAlpha[a * lgammaTableSize]);
+		codonSpecificLogLikelihoods[2 * g + 1] += calculateLogLikelihoodPerCodonPerGene(tableAlpha_proposed[a], tableLambdaPrime_proposed[l],
+				currRFPObserved, currNumCodonsInMRNA, phiValue, logPhiValue, &tableLgammaAlpha_proposed[a * lgammaTableSize]);
 	}
-	logAcceptanceRatioForAllMixtures = logLikelihood_proposed - logLikelihood;
 }
 
 
 void RFPModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration, std::vector <double> & logProbabilityRatio)
 {
 
-	double lpr = 0.0; // this variable is only needed because OpenMP doesn't allow variables in reduction clause to be reference
+	double lpr = 0.0;
 
 	unsigned selectionCategory = getNumSynthesisRateCategories();
 	std::vector<double> currentStdDevSynthesisRate(selectionCategory, 0.0);
@@ -162,22 +321,31 @@ void RFPModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, uns
 
 
 	logProbabilityRatio.resize(1);
+	// the gene terms are added up in gene order after the loop, so the result does not depend on the number of threads
+	int numGenes = genome.getGenomeSize();
+	std::vector<double> geneLogProbabilityRatios(numGenes, 0.0);
 #ifndef __APPLE__
-#pragma omp parallel for reduction(+:lpr)
+#pragma omp parallel for
 #endif
-	for (int i = 0u; i < genome.getGenomeSize(); i++)
+	for (int i = 0u; i < numGenes; i++)
 	{
 		unsigned mixture = getMixtureAssignment(i);
 		mixture = getSynthesisRateCategory(mixture);
-		double phi = getSynthesisRate(i, mixture, false);
+		double logPhi = getLogSynthesisRate(i, mixture, false);
 		if (i == 0) {
 	//	std::cout <<"proposed: " << Parameter::densityLogNorm(phi, proposedMPhi[mixture], proposedStdDevSynthesisRate[mixture], false) <<"\n";
 		//std::cout <<"current: " << Parameter::densityLogNorm(phi, currentMPhi, currentStdDevSynthesisRate, false) <<"\n";
 		}
-		lpr += Parameter::densityLogNorm(phi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true) -
-				Parameter::densityLogNorm(phi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
+		geneLogProbabilityRatios[i] = Parameter::densityLogNormLogScale(logPhi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true) -
+				Parameter::densityLogNormLogScale(logPhi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
 		//std::cout <<"LPR: " << lpr <<"\n";
 	}
+	double geneLpr = 0.0;
+	for (int i = 0; i < numGenes; i++)
+	{
+		geneLpr += geneLogProbabilityRatios[i];
+	}
+	lpr += geneLpr;
 
 	logProbabilityRatio[0] = lpr;
 }
@@ -186,6 +354,80 @@ void RFPModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, uns
 
 
 
+
+//-----------------------------------------------//
+//---------- Fused Iteration Functions ----------//
+//-----------------------------------------------//
+
+
+bool RFPModel::isFusedIterationSupported()
+{
+	return true;
+}
+
+
+unsigned RFPModel::getNumHyperParameterLogRatios()
+{
+	return 1u;
+}
+
+
+void RFPModel::prepareFusedIteration(Genome& genome)
+{
+	prepareCodonSpecificParameterTables();
+
+	unsigned numSynthesisRateCategories = getNumSynthesisRateCategories();
+	fusedStdDevSynthesisRate.resize(numSynthesisRateCategories);
+	fusedStdDevSynthesisRate_proposed.resize(numSynthesisRateCategories);
+	for (unsigned i = 0u; i < numSynthesisRateCategories; i++)
+	{
+		fusedStdDevSynthesisRate[i] = getStdDevSynthesisRate(i, false);
+		fusedStdDevSynthesisRate_proposed[i] = getStdDevSynthesisRate(i, true);
+	}
+}
+
+
+// Gene terms of calculateLogLikelihoodRatioPerGroupingPerCategory and calculateLogLikelihoodRatioForHyperParameters.
+void RFPModel::addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+		double *hyperParameterLogRatios)
+{
+	addGeneToCodonSpecificLogLikelihoods(gene, geneIndex, codonSpecificLogLikelihoods);
+
+	unsigned mixture = getSynthesisRateCategory(getMixtureAssignment(geneIndex));
+	double logPhi = getLogSynthesisRate(geneIndex, mixture, false);
+	double stdDevSynthesisRate = fusedStdDevSynthesisRate[mixture];
+	double stdDevSynthesisRate_proposed = fusedStdDevSynthesisRate_proposed[mixture];
+	double mPhi = -((stdDevSynthesisRate * stdDevSynthesisRate) / 2);
+	double mPhi_proposed = -((stdDevSynthesisRate_proposed * stdDevSynthesisRate_proposed) / 2);
+	hyperParameterLogRatios[0] += Parameter::densityLogNormLogScale(logPhi, mPhi_proposed, stdDevSynthesisRate_proposed, true) -
+			Parameter::densityLogNormLogScale(logPhi, mPhi, stdDevSynthesisRate, true);
+}
+
+
+void RFPModel::completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+		std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios)
+{
+	unsigned numGroupings = (unsigned)groupListCodonIndex.size();
+	codonSpecificLogRatios.resize(numGroupings);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		codonSpecificLogRatios[g] = inverseTemperature * (codonSpecificLogLikelihoods[2 * g + 1] - codonSpecificLogLikelihoods[2 * g]);
+	}
+
+	for (unsigned i = 0u; i < fusedStdDevSynthesisRate.size(); i++)
+	{
+		// take the jacobian into account for the non-linear transformation from logN to N distribution
+		hyperParameterLogRatios[0] -= (std::log(fusedStdDevSynthesisRate[i]) - std::log(fusedStdDevSynthesisRate_proposed[i]));
+		// take prior into account
+		hyperParameterLogRatios[0] -= Parameter::densityNorm(fusedStdDevSynthesisRate[i], 1.0, 0.1, true)
+				- Parameter::densityNorm(fusedStdDevSynthesisRate_proposed[i], 1.0, 0.1, true);
+	}
+}
+
+
+
+
+
 //----------------------------------------------------------//
 //---------- Initialization and Restart Functions ----------//
 //----------------------------------------------------------//
@@ -236,7 +478,7 @@ unsigned RFPModel::getSynthesisRateCategory(unsigned mixture)
 }
 
 
-std::vector<unsigned> RFPModel::getMixtureElementsOfSelectionCategory(unsigned k)
+std::vector<unsigned>& RFPModel::getMixtureElementsOfSelectionCategory(unsigned k)
 {
 	return parameter->getMixtureElementsOfSelectionCategory(k);
 }
@@ -302,6 +544,12 @@ double RFPModel::getSynthesisRate(unsigned index, unsigned mixture, bool propose
 }
 
 
+double RFPModel::getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed)
+{
+	return parameter->getLogSynthesisRate(index, mixture, proposed);
+}
+
+
 void RFPModel::updateSynthesisRate(unsigned i, unsigned k)
 {
 	parameter->updateSynthesisRate(i, k);
@@ -389,6 +637,12 @@ void RFPModel::updateTracesWithInitialValues(Genome & genome)
 }
 
 
+Trace& RFPModel::getTraceObject()
+{
+	return parameter->getTraceObject();
+}
+
+
 
 
 
@@ -569,6 +823,13 @@ void RFPModel::printHyperParameters()
 void RFPModel::setParameter(RFPParameter &_parameter)
 {
 	parameter = &_parameter;
+
+	groupListCodonIndex.clear();
+	for (unsigned i = 0u; i < parameter->getGroupListSize(); i++)
+	{
+		std::string codon = parameter->getGrouping(i);
+		groupListCodonIndex.push_back(SequenceSummary::codonToIndex(codon));
+	}
 }
 
 
@@ -578,12 +839,50 @@ double RFPModel::calculateAllPriors()
 }
 
 
+// Untempered codon log likelihood of the current state. Summed in chunk order as in
+// calculateLogLikelihoodRatioForAllGroupings, so the result does not depend on the number of threads.
+double RFPModel::calculateLogLikelihood(Genome& genome)
+{
+	prepareCodonSpecificParameterTables();
+
+	unsigned numGroupings = (unsigned)groupListCodonIndex.size();
+	int numGenes = genome.getGenomeSize();
+	int numChunks = (numGenes + codonSpecificChunkSize - 1) / codonSpecificChunkSize;
+	std::vector<double> chunkLogLikelihoods(numChunks * 2 * numGroupings, 0.0);
+
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int c = 0; c < numChunks; c++)
+	{
+		int end = std::min((c + 1) * (int)codonSpecificChunkSize, numGenes);
+		for (int i = c * codonSpecificChunkSize; i < end; i++)
+		{
+			addGeneToCodonSpecificLogLikelihoods(genome.getGene(i), i, &chunkLogLikelihoods[c * 2 * numGroupings]);
+		}
+	}
+
+	double logLikelihood = 0.0;
+	for (unsigned k = 0u; k < chunkLogLikelihoods.size(); k += 2u)
+	{
+		logLikelihood += chunkLogLikelihoods[k];
+	}
+	return logLikelihood;
+}
+
+
 double RFPModel::getParameterForCategory(unsigned category, unsigned param, std::string codon, bool proposal)
 {
 	return parameter->getParameterForCategory(category, param, codon, proposal);
 }
 
 
+double RFPModel::getParameterForCategory(unsigned category, unsigned param, unsigned codonIndex, bool proposal)
+{
+	return parameter->getParameterForCategory(category, param, codonIndex, proposal);
+}
+
+
 
 
 
@@ -14,15 +14,15 @@ RFPParameter::RFPParameter() : Parameter()
 {
 	//ctor
 	bias_csp = 0;
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 }
 
 
 RFPParameter::RFPParameter(std::string filename) : Parameter(64)
 {
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 	initFromRestartFile(filename);
 	numParam = 61;
 }
@@ -72,27 +72,19 @@ void RFPParameter::initRFPParameterSet()
 	unsigned alphaCategories = getNumMutationCategories();
 	unsigned lambdaPrimeCategories = getNumSelectionCategories();
 
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	numParam = 61;
+	currentCodonSpecificParameter.initialize(2, numParam);
+	proposedCodonSpecificParameter.initialize(2, numParam);
 
-	currentCodonSpecificParameter[alp].resize(alphaCategories);
-	proposedCodonSpecificParameter[alp].resize(alphaCategories);
-	currentCodonSpecificParameter[lmPri].resize(lambdaPrimeCategories);
-	proposedCodonSpecificParameter[lmPri].resize(lambdaPrimeCategories);
+	currentCodonSpecificParameter.resizeParameterType(alp, alphaCategories, 1.0);
+	proposedCodonSpecificParameter.resizeParameterType(alp, alphaCategories, 1.0);
+	currentCodonSpecificParameter.resizeParameterType(lmPri, lambdaPrimeCategories, 1.0);
+	proposedCodonSpecificParameter.resizeParameterType(lmPri, lambdaPrimeCategories, 1.0);
 	lambdaValues.resize(lambdaPrimeCategories);
-	numParam = 61;
 
-	for (unsigned i = 0; i < alphaCategories; i++)
-	{
-		std::vector <double> tmp(numParam,1.0);
-		currentCodonSpecificParameter[alp][i] = tmp;
-		proposedCodonSpecificParameter[alp][i] = tmp;
-	}
 	for (unsigned i = 0; i < lambdaPrimeCategories; i++)
 	{
 		std::vector <double> tmp(numParam,1.0);
-		currentCodonSpecificParameter[lmPri][i] = tmp;
-		proposedCodonSpecificParameter[lmPri][i] = tmp;
 		lambdaValues[i] = tmp; //Maybe we don't initialize this one? or we do it differently?
 	}
 
@@ -112,6 +104,8 @@ void RFPParameter::initRFPParameterSet()
 void RFPParameter::initRFPValuesFromFile(std::string filename)
 {
 	std::ifstream input;
+	std::vector<std::vector<double>> alphaValues;
+	std::vector<std::vector<double>> lambdaPrimeValues;
 	input.open(filename.c_str());
 	if (input.fail())
 	{
@@ -152,7 +146,7 @@ void RFPParameter::initRFPValuesFromFile(std::string filename)
 			{
 				if (tmp == "***")
 				{
-					currentCodonSpecificParameter[alp].resize(currentCodonSpecificParameter[alp].size() + 1);
+					alphaValues.resize(alphaValues.size() + 1);
 					cat++;
 				}
 				else if (tmp == "\n")
@@ -163,7 +157,7 @@ void RFPParameter::initRFPValuesFromFile(std::string filename)
 					iss.str(tmp);
 					while (iss >> val)
 					{
-						currentCodonSpecificParameter[alp][cat - 1].push_back(val);
+						alphaValues[cat - 1].push_back(val);
 					}
 				}
 			}
@@ -171,7 +165,7 @@ void RFPParameter::initRFPValuesFromFile(std::string filename)
 			{
 				if (tmp == "***")
 				{
-					currentCodonSpecificParameter[lmPri].resize(currentCodonSpecificParameter[lmPri].size() + 1);
+					lambdaPrimeValues.resize(lambdaPrimeValues.size() + 1);
 					cat++;
 				}
 				else if (tmp == "\n")
@@ -182,7 +176,7 @@ void RFPParameter::initRFPValuesFromFile(std::string filename)
 					iss.str(tmp);
 					while (iss >> val)
 					{
-						currentCodonSpecificParameter[lmPri][cat - 1].push_back(val);
+						lambdaPrimeValues[cat - 1].push_back(val);
 					}
 				}
 			}
@@ -200,16 +194,9 @@ void RFPParameter::initRFPValuesFromFile(std::string filename)
 	input.close();
 
 	bias_csp = 0;
-	proposedCodonSpecificParameter[alp].resize(numMutationCategories);
-	proposedCodonSpecificParameter[lmPri].resize(numSelectionCategories);
-	for (unsigned i = 0; i < numMutationCategories; i++)
-	{
-		proposedCodonSpecificParameter[alp][i] = currentCodonSpecificParameter[alp][i];
-	}
-	for (unsigned i = 0; i < numSelectionCategories; i++)
-	{
-		proposedCodonSpecificParameter[lmPri][i] = currentCodonSpecificParameter[lmPri][i];
-	}
+	currentCodonSpecificParameter.setParameterType(alp, alphaValues);
+	currentCodonSpecificParameter.setParameterType(lmPri, lambdaPrimeValues);
+	proposedCodonSpecificParameter = currentCodonSpecificParameter;
 }
 
 
@@ -238,7 +225,7 @@ void RFPParameter::writeRFPRestartFile(std::string filename)
 	for (i = 0; i < currentCodonSpecificParameter[alp].size(); i++)
 	{
 		oss << "***\n";
-		for (j = 0; j < currentCodonSpecificParameter[alp][i].size(); j++)
+		for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
 		{
 			oss << currentCodonSpecificParameter[alp][i][j];
 			if ((j + 1) % 10 == 0)
@@ -254,7 +241,7 @@ void RFPParameter::writeRFPRestartFile(std::string filename)
 	for (i = 0; i < currentCodonSpecificParameter[lmPri].size(); i++)
 	{
 		oss << "***\n";
-		for (j = 0; j < currentCodonSpecificParameter[lmPri][i].size(); j++)
+		for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
 		{
 			oss << currentCodonSpecificParameter[lmPri][i][j];
 			if ((j + 1) % 10 == 0)
@@ -356,14 +343,14 @@ void RFPParameter::initMutationSelectionCategories(std::vector<std::string> file
 		{
 			if (paramType == RFPParameter::alp && categories[j].delM == i)
 			{
-				currentCodonSpecificParameter[alp][j] = temp;
-				proposedCodonSpecificParameter[alp][j] = temp;
+				std::copy(temp.begin(), temp.end(), currentCodonSpecificParameter[alp][j]);
+				std::copy(temp.begin(), temp.end(), proposedCodonSpecificParameter[alp][j]);
 				altered++;
 			}
 			else if (paramType == RFPParameter::lmPri && categories[j].delEta == i)
 			{
-				currentCodonSpecificParameter[lmPri][j] = temp;
-				proposedCodonSpecificParameter[lmPri][j] = temp;
+				std::copy(temp.begin(), temp.end(), currentCodonSpecificParameter[lmPri][j]);
+				std::copy(temp.begin(), temp.end(), proposedCodonSpecificParameter[lmPri][j]);
 				altered++;
 			}
 			if (altered == numCategories)
@@ -406,8 +393,8 @@ double RFPParameter::getCurrentCodonSpecificProposalWidth(unsigned index)
 
 void RFPParameter::proposeCodonSpecificParameter()
 {
-	unsigned numAlpha = (unsigned)currentCodonSpecificParameter[alp][0].size();
-	unsigned numLambdaPrime = (unsigned)currentCodonSpecificParameter[lmPri][0].size();
+	unsigned numAlpha = currentCodonSpecificParameter.getNumCodons();
+	unsigned numLambdaPrime = currentCodonSpecificParameter.getNumCodons();
 
 	for (unsigned i = 0; i < numMutationCategories; i++)
 	{
@@ -432,14 +419,7 @@ void RFPParameter::updateCodonSpecificParameter(std::string grouping)
 	unsigned i = SequenceSummary::codonToIndex(grouping);
 	numAcceptForCodonSpecificParameters[i]++;
 
-	for(unsigned k = 0u; k < numMutationCategories; k++)
-	{
-		currentCodonSpecificParameter[alp][k][i] = proposedCodonSpecificParameter[alp][k][i];
-	}
-	for(unsigned k = 0u; k < numSelectionCategories; k++)
-	{
-		currentCodonSpecificParameter[lmPri][k][i] = proposedCodonSpecificParameter[lmPri][k][i];
-	}
+	currentCodonSpecificParameter.copyCodonRange(proposedCodonSpecificParameter, i, i + 1);
 }
 
 
@@ -479,11 +459,14 @@ void RFPParameter::adaptCodonSpecificParameterProposalWidth(unsigned adaptationW
 
 double RFPParameter::getParameterForCategory(unsigned category, unsigned paramType, std::string codon, bool proposal)
 {
-	double rv;
-	unsigned codonIndex = SequenceSummary::codonToIndex(codon);
-	rv = (proposal ? proposedCodonSpecificParameter[paramType][category][codonIndex] : currentCodonSpecificParameter[paramType][category][codonIndex]);
+	return getParameterForCategory(category, paramType, SequenceSummary::codonToIndex(codon), proposal);
+}
 
-	return rv;
+
+// Index based version for the likelihood loops, avoids the string to index lookup.
+double RFPParameter::getParameterForCategory(unsigned category, unsigned paramType, unsigned codonIndex, bool proposal)
+{
+	return (proposal ? proposedCodonSpecificParameter[paramType][category][codonIndex] : currentCodonSpecificParameter[paramType][category][codonIndex]);
 }
 
 
@@ -653,49 +636,49 @@ void RFPParameter::initMutationSelectionCategoriesR(std::vector<std::string> fil
 
 std::vector<std::vector<double>> RFPParameter::getProposedAlphaParameter()
 {
-	return proposedCodonSpecificParameter[alp];
+	return proposedCodonSpecificParameter.getParameterType(alp);
 }
 
 
 std::vector<std::vector<double>> RFPParameter::getProposedLambdaPrimeParameter()
 {
-	return proposedCodonSpecificParameter[lmPri];
+	return proposedCodonSpecificParameter.getParameterType(lmPri);
 }
 
 
 std::vector<std::vector<double>> RFPParameter::getCurrentAlphaParameter()
 {
-	return currentCodonSpecificParameter[alp];
+	return currentCodonSpecificParameter.getParameterType(alp);
 }
 
 
 std::vector<std::vector<double>> RFPParameter::getCurrentLambdaPrimeParameter()
 {
-	return currentCodonSpecificParameter[lmPri];
+	return currentCodonSpecificParameter.getParameterType(lmPri);
 }
 
 
 void RFPParameter::setProposedAlphaParameter(std::vector<std::vector<double>> alpha)
 {
-	proposedCodonSpecificParameter[alp] = alpha;
+	proposedCodonSpecificParameter.setParameterType(alp, alpha);
 }
 
 
 void RFPParameter::setProposedLambdaPrimeParameter(std::vector<std::vector<double>> lambdaPrime)
 {
-	proposedCodonSpecificParameter[lmPri] = lambdaPrime;
+	proposedCodonSpecificParameter.setParameterType(lmPri, lambdaPrime);
 }
 
 
 void RFPParameter::setCurrentAlphaParameter(std::vector<std::vector<double>> alpha)
 {
-	currentCodonSpecificParameter[alp] = alpha;
+	currentCodonSpecificParameter.setParameterType(alp, alpha);
 }
 
 
 void RFPParameter::setCurrentLambdaPrimeParameter(std::vector<std::vector<double>> lambdaPrime)
 {
-	currentCodonSpecificParameter[lmPri] = lambdaPrime;
+	currentCodonSpecificParameter.setParameterType(lmPri, lambdaPrime);
 }
 
 
@@ -1,5 +1,7 @@
 #include "include/ROC/ROCModel.h"
 
+#include <algorithm>
+
 
 //--------------------------------------------------//
 //----------- Constructors & Destructors ---------- //
@@ -10,6 +12,9 @@ ROCModel::ROCModel(bool _withPhi) : Model()
 {
 	parameter = 0;
 	withPhi = _withPhi;
+	fusedLogObservedPhi = 0;
+	fusedObservedPhiMask = 0;
+	fusedNumPhiSets = 0u;
 }
 
 
@@ -18,20 +23,71 @@ ROCModel::~ROCModel()
 	//dtor
 }
 
-double ROCModel::calculateLogLikelihoodPerAAPerGene(unsigned numCodons, int codonCount[], double mutation[], double selection[], double phiValue)
+// Log likelihood of one amino acid for a block of genes which share the same codon specific parameters.
+// codonCount is ordered codon by codon, stride apart, so the loops over the genes are contiguous and can be vectorized.
+// The likelihood is evaluated in log space, sum_i c_i * log(p_i) = sum_i c_i * x_i - n * log(sum_i exp(x_i)),
+// which needs one log per gene instead of one per codon. The reference codon is shifted as in calculateCodonProbabilityVector.
+double ROCModel::calculateLogLikelihoodPerAAForGeneBlock(unsigned numCodons, unsigned numGenes, unsigned stride,
+			const unsigned codonCount[], const double phi[], double mutation[], double selection[], double logLikelihood[])
 {
-	double logLikelihood = 0.0;
-	// calculate codon probabilities
-	double codonProbabilities[6];
-	calculateCodonProbabilityVector(numCodons, mutation, selection, phiValue, codonProbabilities);
+	unsigned minIndexVal = 0u;
+	for (unsigned i = 1u; i < (numCodons - 1); i++)
+	{
+		if (selection[minIndexVal] > selection[i])
+		{
+			minIndexVal = i;
+		}
+	}
+	double refMutation = 0.0;
+	double refSelection = 0.0;
+	if (selection[minIndexVal] < 0.0)
+	{
+		refMutation = mutation[minIndexVal];
+		refSelection = selection[minIndexVal];
+	}
+
+	double denominator[geneBlockSize];
+	double aaCount[geneBlockSize];
 
-	// calculate likelihood for current AA for this combination of selection and mutation category
-	for(unsigned i = 0; i < numCodons; i++)
+	// alphabetically last codon is reference codon!
+	const unsigned *referenceCount = codonCount + (numCodons - 1) * stride;
+#ifndef __APPLE__
+#pragma omp simd
+#endif
+	for (unsigned g = 0u; g < numGenes; g++)
 	{
-		if (codonCount[i] == 0) continue;
-		logLikelihood += std::log(codonProbabilities[i]) * codonCount[i];
+		double x = refMutation + refSelection * phi[g];
+		denominator[g] = std::exp(x);
+		logLikelihood[g] = referenceCount[g] * x;
+		aaCount[g] = referenceCount[g];
 	}
-	return logLikelihood;
+	for (unsigned i = 0u; i < (numCodons - 1); i++)
+	{
+		double deltaMutation = mutation[i] - refMutation;
+		double deltaSelection = selection[i] - refSelection;
+		const unsigned *count = codonCount + i * stride;
+#ifndef __APPLE__
+#pragma omp simd
+#endif
+		for (unsigned g = 0u; g < numGenes; g++)
+		{
+			double x = -deltaMutation - deltaSelection * phi[g];
+			denominator[g] += std::exp(x);
+			logLikelihood[g] += count[g] * x;
+			aaCount[g] += count[g];
+		}
+	}
+
+	double sum = 0.0;
+#ifndef __APPLE__
+#pragma omp simd reduction(+:sum)
+#endif
+	for (unsigned g = 0u; g < numGenes; g++)
+	{
+		logLikelihood[g] -= aaCount[g] * std::log(denominator[g]);
+		sum += logLikelihood[g];
+	}
+	return sum;
 }
 
 
@@ -56,23 +112,6 @@ double ROCModel::calculateMutationPrior(std::string grouping, bool proposed)
 }
 
 
-void ROCModel::obtainCodonCount(SequenceSummary *seqsum, std::string curAA, int codonCount[])
-{
-	unsigned aaStart;
-	unsigned aaEnd;
-	SequenceSummary::AAToCodonRange(curAA, aaStart, aaEnd, false);
-	// get codon counts for AA
-	unsigned j = 0u;
-	for(unsigned i = aaStart; i < aaEnd; i++, j++)
-	{
-		codonCount[j] = seqsum->getCodonCountForCodon(i);
-	}
-}
-
-
-
-
-
 //------------------------------------------------//
 //---------- Likelihood Ratio Functions ----------//
 //------------------------------------------------//
@@ -92,55 +131,73 @@ void ROCModel::calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneIndex
 
 	double phiValue = parameter->getSynthesisRate(geneIndex, expressionCategory, false);
 	double phiValue_proposed = parameter->getSynthesisRate(geneIndex, expressionCategory, true);
+	double logPhiValue = parameter->getLogSynthesisRate(geneIndex, expressionCategory, false);
+	double logPhiValue_proposed = parameter->getLogSynthesisRate(geneIndex, expressionCategory, true);
 
+	// current and proposed phi are evaluated as a block of two with the same codon counts
+	double phi[2] = {phiValue, phiValue_proposed};
 	double mutation[5];
 	double selection[5];
-	int codonCount[6];
+	unsigned codonCount[12];
+	double aaLogLikelihood[2];
+	int numGroupings = (int)groupListAAIndex.size();
+	// the amino acid terms are added up in grouping order after the loop, so the result does not depend on the number of threads
+	double groupingLogLikelihoods[2 * maxGroupings] = {0.0};
 #ifndef __APPLE__
-#pragma omp parallel for private(mutation, selection, codonCount) reduction(+:logLikelihood,logLikelihood_proposed)
+#pragma omp parallel for private(mutation, selection, codonCount, aaLogLikelihood)
 #endif
-	for(int i = 0; i < getGroupListSize(); i++)
+	for(int i = 0; i < numGroupings; i++)
 	{
-		std::string curAA = getGrouping(i);
+		unsigned aaIndex = groupListAAIndex[i];
 
 		// skip amino acids which do not occur in current gene. Avoid useless calculations and multiplying by 0
-		if(seqsum->getAACountForAA(i) == 0) continue;
+		if(seqsum->getAACountForAA(aaIndex) == 0) continue;
 
 		// get number of codons for AA (total number not parameter->count)
-		unsigned numCodons = seqsum->GetNumCodonsForAA(curAA);
+		unsigned numCodons = SequenceSummary::GetNumCodonsForAAIndex(aaIndex);
 		// get mutation and selection parameter->for gene
-		parameter->getParameterForCategory(mutationCategory, ROCParameter::dM, curAA, false, mutation);
-		parameter->getParameterForCategory(selectionCategory, ROCParameter::dEta, curAA, false, selection);
+		parameter->getParameterForCategory(mutationCategory, ROCParameter::dM, aaIndex, false, mutation);
+		parameter->getParameterForCategory(selectionCategory, ROCParameter::dEta, aaIndex, false, selection);
 		// get codon occurence in sequence
-		obtainCodonCount(seqsum, curAA, codonCount);
+		unsigned aaStart = SequenceSummary::codonRangeForAAIndex[aaIndex][0];
+		for (unsigned j = 0u; j < numCodons; j++)
+		{
+			codonCount[2 * j] = codonCount[2 * j + 1] = seqsum->getCodonCountForCodon(aaStart + j);
+		}
 
-		logLikelihood += calculateLogLikelihoodPerAAPerGene(numCodons, codonCount, mutation, selection, phiValue);
-		logLikelihood_proposed += calculateLogLikelihoodPerAAPerGene(numCodons, codonCount, mutation, selection, phiValue_proposed);
+		calculateLogLikelihoodPerAAForGeneBlock(numCodons, 2u, 2u, codonCount, phi, mutation, selection, aaLogLikelihood);
+		groupingLogLikelihoods[2 * i] = aaLogLikelihood[0];
+		groupingLogLikelihoods[2 * i + 1] = aaLogLikelihood[1];
+	}
+	for (int i = 0; i < numGroupings; i++)
+	{
+		logLikelihood += groupingLogLikelihoods[2 * i];
+		logLikelihood_proposed += groupingLogLikelihoods[2 * i + 1];
 	}
 	unsigned mixture = getMixtureAssignment(geneIndex);
 	mixture = getSynthesisRateCategory(mixture);
 	double stdDevSynthesisRate = parameter->getStdDevSynthesisRate(mixture, false);
 	double mPhi = (-(stdDevSynthesisRate * stdDevSynthesisRate) * 0.5); // X * 0.5 = X / 2
-	double logPhiProbability = Parameter::densityLogNorm(phiValue, mPhi, stdDevSynthesisRate, true);
-	double logPhiProbability_proposed = Parameter::densityLogNorm(phiValue_proposed, mPhi, stdDevSynthesisRate, true);
+	double logPhiProbability = Parameter::densityLogNormLogScale(logPhiValue, mPhi, stdDevSynthesisRate, true);
+	double logPhiProbability_proposed = Parameter::densityLogNormLogScale(logPhiValue_proposed, mPhi, stdDevSynthesisRate, true);
 
 	// TODO: make this work for more than one phi value, or for genes that don't have phi values
 	if (withPhi) {
 		for (unsigned i = 0; i < parameter->getNumObservedPhiSets(); i++) {
 			double obsPhi = gene.getObservedSynthesisRate(i);
 			if (obsPhi > -1.0) {
-				logPhiProbability += Parameter::densityLogNorm(obsPhi, std::log(phiValue) + getNoiseOffset(i), getObservedSynthesisNoise(i), true);
-				logPhiProbability_proposed += Parameter::densityLogNorm(obsPhi, std::log(phiValue_proposed) + getNoiseOffset(i), getObservedSynthesisNoise(i), true);
+				logPhiProbability += Parameter::densityLogNorm(obsPhi, logPhiValue + getNoiseOffset(i), getObservedSynthesisNoise(i), true);
+				logPhiProbability_proposed += Parameter::densityLogNorm(obsPhi, logPhiValue_proposed + getNoiseOffset(i), getObservedSynthesisNoise(i), true);
 			}
 		}
 	}
 
-	double currentLogLikelihood = (logLikelihood + logPhiProbability);
-	double proposedLogLikelihood = (logLikelihood_proposed + logPhiProbability_proposed);
+	double currentLogLikelihood = (inverseTemperature * logLikelihood + logPhiProbability);
+	double proposedLogLikelihood = (inverseTemperature * logLikelihood_proposed + logPhiProbability_proposed);
 
-	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (std::log(phiValue) - std::log(phiValue_proposed));
-	logProbabilityRatio[1] = currentLogLikelihood - std::log(phiValue_proposed);
-	logProbabilityRatio[2] = proposedLogLikelihood - std::log(phiValue);
+	logProbabilityRatio[0] = (proposedLogLikelihood - currentLogLikelihood) - (logPhiValue - logPhiValue_proposed);
+	logProbabilityRatio[1] = currentLogLikelihood - logPhiValue_proposed;
+	logProbabilityRatio[2] = proposedLogLikelihood - logPhiValue;
 	logProbabilityRatio[3] = currentLogLikelihood;
 	logProbabilityRatio[4] = proposedLogLikelihood;
 
@@ -149,57 +206,181 @@ void ROCModel::calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneIndex
 
 void ROCModel::calculateLogLikelihoodRatioPerGroupingPerCategory(std::string grouping, Genome& genome, double& logAcceptanceRatioForAllMixtures)
 {
-	int numGenes = genome.getGenomeSize();
-	int numCodons = SequenceSummary::GetNumCodonsForAA(grouping);
-	double likelihood = 0.0;
-	double likelihood_proposed = 0.0;
+	std::vector<unsigned> aaIndices(1, SequenceSummary::AAToAAIndex(grouping));
+	std::vector<double> likelihood;
+	std::vector<double> likelihood_proposed;
+	calculateLogLikelihoodsPerAA(genome, aaIndices, likelihood, likelihood_proposed);
 
-	double mutation[5];
-	double selection[5];
-	double mutation_proposed[5];
-	double selection_proposed[5];
+	likelihood_proposed[0] = inverseTemperature * likelihood_proposed[0] + calculateMutationPrior(grouping, true);
+	likelihood[0] = inverseTemperature * likelihood[0] + calculateMutationPrior(grouping, false);
+
+	logAcceptanceRatioForAllMixtures = (likelihood_proposed[0] - likelihood[0]);
+}
+
+
+// Blocked version of calculateLogLikelihoodRatioPerGroupingPerCategory: the amino acids are independent
+// given phi and the mixture assignment, so the ratios of all groupings are evaluated in one parallel pass.
+void ROCModel::calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios)
+{
+	std::vector<double> likelihood;
+	std::vector<double> likelihood_proposed;
+	calculateLogLikelihoodsPerAA(genome, groupListAAIndex, likelihood, likelihood_proposed);
+
+	unsigned numGroupings = (unsigned)groupListAAIndex.size();
+	logAcceptanceRatios.resize(numGroupings);
+	for (unsigned k = 0u; k < numGroupings; k++)
+	{
+		std::string grouping = getGrouping(k);
+		likelihood_proposed[k] = inverseTemperature * likelihood_proposed[k] + calculateMutationPrior(grouping, true);
+		likelihood[k] = inverseTemperature * likelihood[k] + calculateMutationPrior(grouping, false);
+		logAcceptanceRatios[k] = (likelihood_proposed[k] - likelihood[k]);
+	}
+}
+
+
+// Current and proposed log likelihood (without prior) of the codon specific parameters of every amino acid in aaIndices.
+// The genes in which an amino acid occurs are split into chunks of codonSpecificChunkSize genes and the chunks of all
+// amino acids are evaluated in a single parallel loop. The chunk results are summed per amino acid in chunk order,
+// so the result does not depend on the number of threads.
+void ROCModel::calculateLogLikelihoodsPerAA(Genome& genome, std::vector<unsigned> &aaIndices, std::vector<double> &likelihood,
+			std::vector<double> &likelihood_proposed)
+{
+	unsigned numAA = (unsigned)aaIndices.size();
+	unsigned numMixtures = parameter->getNumMixtureElements();
+
+	// the codon specific parameters only depend on the category, look them up once instead of once per gene
+	unsigned numMutationCategories = parameter->getNumMutationCategories();
+	unsigned numSelectionCategories = parameter->getNumSelectionCategories();
+	std::vector<double> mutation(numAA * numMutationCategories * 5, 0.0);
+	std::vector<double> mutation_proposed(numAA * numMutationCategories * 5, 0.0);
+	std::vector<double> selection(numAA * numSelectionCategories * 5, 0.0);
+	std::vector<double> selection_proposed(numAA * numSelectionCategories * 5, 0.0);
+
+	std::vector<unsigned> chunkAA; // position in aaIndices
+	std::vector<unsigned> chunkStart; // first entry of the amino acid's gene list
+	for (unsigned a = 0u; a < numAA; a++)
+	{
+		unsigned aaIndex = aaIndices[a];
+		for (unsigned category = 0u; category < numMutationCategories; category++)
+		{
+			unsigned offset = (a * numMutationCategories + category) * 5;
+			parameter->getParameterForCategory(category, ROCParameter::dM, aaIndex, false, &mutation[offset]);
+			parameter->getParameterForCategory(category, ROCParameter::dM, aaIndex, true, &mutation_proposed[offset]);
+		}
+		for (unsigned category = 0u; category < numSelectionCategories; category++)
+		{
+			unsigned offset = (a * numSelectionCategories + category) * 5;
+			parameter->getParameterForCategory(category, ROCParameter::dEta, aaIndex, false, &selection[offset]);
+			parameter->getParameterForCategory(category, ROCParameter::dEta, aaIndex, true, &selection_proposed[offset]);
+		}
+
+		unsigned numGenesWithAA = (unsigned)genome.getGenesWithAA(aaIndex).size();
+		for (unsigned start = 0u; start < numGenesWithAA; start += codonSpecificChunkSize)
+		{
+			chunkAA.push_back(a);
+			chunkStart.push_back(start);
+		}
+	}
+
+	int numChunks = (int)chunkAA.size();
+	std::vector<double> chunkLikelihood(numChunks, 0.0);
+	std::vector<double> chunkLikelihood_proposed(numChunks, 0.0);
 
-	int codonCount[6];
-	Gene *gene;
-	SequenceSummary *seqsum;
-	unsigned aaIndex = SequenceSummary::AAToAAIndex(grouping);
 #ifndef __APPLE__
-#pragma omp parallel for private(mutation, selection, mutation_proposed, selection_proposed, codonCount, gene, seqsum) reduction(+:likelihood,likelihood_proposed)
+#pragma omp parallel
 #endif
-	for(int i = 0; i < numGenes; i++)
 	{
-		gene = &genome.getGene(i);
-		seqsum = gene->getSequenceSummary();
-		if(seqsum->getAACountForAA(aaIndex) == 0) continue;
+		// genes are collected into one block per mixture element, so all genes of a block share their codon specific parameters
+		std::vector<double> blockPhi(numMixtures * geneBlockSize);
+		std::vector<unsigned> blockCodonCounts(numMixtures * 6 * geneBlockSize);
+		std::vector<unsigned> blockSize(numMixtures, 0u);
+		double blockLogLikelihood[geneBlockSize];
 
-		// which mixture element does this gene belong to
-		unsigned mixtureElement = parameter->getMixtureAssignment(i);
-		// how is the mixture element defined. Which categories make it up
-		unsigned mutationCategory = parameter->getMutationCategory(mixtureElement);
-		unsigned selectionCategory = parameter->getSelectionCategory(mixtureElement);
-		unsigned expressionCategory = parameter->getSynthesisRateCategory(mixtureElement);
-		// get phi value, calculate likelihood conditional on phi
-		double phiValue = parameter->getSynthesisRate(i, expressionCategory, false);
+#ifndef __APPLE__
+#pragma omp for schedule(dynamic)
+#endif
+		for (int c = 0; c < numChunks; c++)
+		{
+			unsigned a = chunkAA[c];
+			unsigned aaIndex = aaIndices[a];
+			int numCodons = SequenceSummary::GetNumCodonsForAAIndex(aaIndex);
+			double *mutationOfAA = &mutation[a * numMutationCategories * 5];
+			double *mutation_proposedOfAA = &mutation_proposed[a * numMutationCategories * 5];
+			double *selectionOfAA = &selection[a * numSelectionCategories * 5];
+			double *selection_proposedOfAA = &selection_proposed[a * numSelectionCategories * 5];
+
+			// only genes in which the amino acid occurs contribute, their codon counts for it are stored back to back
+			const std::vector<unsigned> &genesWithAA = genome.getGenesWithAA(aaIndex);
+			const unsigned *codonCountsForAA = genome.getCodonCountsForAA(aaIndex);
+			unsigned end = std::min(chunkStart[c] + codonSpecificChunkSize, (unsigned)genesWithAA.size());
+
+			double sum = 0.0;
+			double sum_proposed = 0.0;
+			for (unsigned n = chunkStart[c]; n < end; n++)
+			{
+				unsigned i = genesWithAA[n];
+				const unsigned *codonCounts = codonCountsForAA + n * numCodons;
+
+				// which mixture element does this gene belong to
+				unsigned mixtureElement = parameter->getMixtureAssignment(i);
+				unsigned expressionCategory = parameter->getSynthesisRateCategory(mixtureElement);
+				double *phi = &blockPhi[mixtureElement * geneBlockSize];
+				unsigned *codonCount = &blockCodonCounts[mixtureElement * 6 * geneBlockSize];
+				unsigned b = blockSize[mixtureElement]++;
+
+				// get phi value, calculate likelihood conditional on phi
+				phi[b] = parameter->getSynthesisRate(i, expressionCategory, false);
+				for (int j = 0; j < numCodons; j++)
+				{
+					codonCount[j * geneBlockSize + b] = codonCounts[j];
+				}
 
-		// get current mutation and selection parameter
-		parameter->getParameterForCategory(mutationCategory, ROCParameter::dM, grouping, false, mutation);
-		parameter->getParameterForCategory(selectionCategory, ROCParameter::dEta, grouping, false, selection);
-		// get proposed mutation and selection parameter
-		parameter->getParameterForCategory(mutationCategory, ROCParameter::dM, grouping, true, mutation_proposed);
-		parameter->getParameterForCategory(selectionCategory, ROCParameter::dEta, grouping, true, selection_proposed);
+				if (blockSize[mixtureElement] == geneBlockSize)
+				{
+					// how is the mixture element defined. Which categories make it up
+					unsigned mutationCategory = parameter->getMutationCategory(mixtureElement);
+					unsigned selectionCategory = parameter->getSelectionCategory(mixtureElement);
+					sum += calculateLogLikelihoodPerAAForGeneBlock(numCodons, geneBlockSize, geneBlockSize, codonCount, phi,
+								&mutationOfAA[mutationCategory * 5], &selectionOfAA[selectionCategory * 5], blockLogLikelihood);
+					sum_proposed += calculateLogLikelihoodPerAAForGeneBlock(numCodons, geneBlockSize, geneBlockSize, codonCount, phi,
+								&mutation_proposedOfAA[mutationCategory * 5], &selection_proposedOfAA[selectionCategory * 5], blockLogLikelihood);
+					blockSize[mixtureElement] = 0u;
+				}
+			}
 
-		obtainCodonCount(seqsum, grouping, codonCount);
-		likelihood += calculateLogLikelihoodPerAAPerGene(numCodons, codonCount, mutation, selection, phiValue);
-		likelihood_proposed += calculateLogLikelihoodPerAAPerGene(numCodons, codonCount, mutation_proposed, selection_proposed, phiValue);
-	}
+			// evaluate partially filled blocks
+			for (unsigned mixtureElement = 0u; mixtureElement < numMixtures; mixtureElement++)
+			{
+				if (blockSize[mixtureElement] == 0u) continue;
+				double *phi = &blockPhi[mixtureElement * geneBlockSize];
+				unsigned *codonCount = &blockCodonCounts[mixtureElement * 6 * geneBlockSize];
+				unsigned mutationCategory = parameter->getMutationCategory(mixtureElement);
+				unsigned selectionCategory = parameter->getSelectionCategory(mixtureElement);
+				sum += calculateLogLikelihoodPerAAForGeneBlock(numCodons, blockSize[mixtureElement], geneBlockSize, codonCount,
+							phi, &mutationOfAA[mutationCategory * 5], &selectionOfAA[selectionCategory * 5], blockLogLikelihood);
+				sum_proposed += calculateLogLikelihoodPerAAForGeneBlock(numCodons, blockSize[mixtureElement], geneBlockSize, codonCount,
+							phi, &mutation_proposedOfAA[mutationCategory * 5], &selection_proposedOfAA[selectionCategory * 5], blockLogLikelihood);
+				blockSize[mixtureElement] = 0u;
+			}
 
-	likelihood_proposed = likelihood_proposed + calculateMutationPrior(grouping, true);
-	likelihood = likelihood + calculateMutationPrior(grouping, false);
+			chunkLikelihood[c] = sum;
+			chunkLikelihood_proposed[c] = sum_proposed;
+		}
+	}
 
-	logAcceptanceRatioForAllMixtures = (likelihood_proposed - likelihood);
+	likelihood.assign(numAA, 0.0);
+	likelihood_proposed.assign(numAA, 0.0);
+	for (int c = 0; c < numChunks; c++)
+	{
+		likelihood[chunkAA[c]] += chunkLikelihood[c];
+		likelihood_proposed[chunkAA[c]] += chunkLikelihood_proposed[c];
+	}
 }
 
 
+// All hyper parameter ratios are evaluated in one parallel pass over the genes. The genes are split into chunks of
+// hyperParameterChunkSize genes with their own partial sums, which are added up in chunk order, so the result does
+// not depend on the number of threads. The observed phi values are read from the log matrix of the genome.
 void ROCModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration, std::vector <double> &logProbabilityRatio)
 {
 	double lpr = 0.0;
@@ -222,58 +403,237 @@ void ROCModel::calculateLogLikelihoodRatioForHyperParameters(Genome &genome, uns
 
 	if (withPhi) {
 		// one for each noiseOffset, and one for stdDevSynthesisRate
-		logProbabilityRatio.resize(getNumPhiGroupings()+1);
+		logProbabilityRatio.assign(getNumPhiGroupings()+1, 0.0);
 	}
 	else {
-		logProbabilityRatio.resize(1);
+		logProbabilityRatio.assign(1, 0.0);
 	}
+
+	unsigned numPhiSets = genome.getNumObservedSynthesisRateSets();
+	unsigned numNoiseOffsets = withPhi ? std::min(parameter->getNumObservedPhiSets(), numPhiSets) : 0u;
+	const double *logObservedPhi = genome.getLogObservedSynthesisRates();
+	const unsigned char *observedPhiMask = genome.getObservedSynthesisRateMask();
+	std::vector<double> noiseOffset(numNoiseOffsets), noiseOffset_proposed(numNoiseOffsets), observedSynthesisNoise(numNoiseOffsets);
+	for (unsigned i = 0u; i < numNoiseOffsets; i++)
+	{
+		noiseOffset[i] = getNoiseOffset(i, false);
+		noiseOffset_proposed[i] = getNoiseOffset(i, true);
+		observedSynthesisNoise[i] = getObservedSynthesisNoise(i);
+	}
+
+	int numGenes = genome.getGenomeSize();
+	int numChunks = (numGenes + hyperParameterChunkSize - 1) / hyperParameterChunkSize;
+	unsigned numRatios = 1u + numNoiseOffsets;
+	std::vector<double> chunkRatios(numChunks * numRatios, 0.0);
+	std::vector<unsigned char> chunkFinite(numChunks, 1u);
+
 #ifndef __APPLE__
-//#pragma omp parallel for reduction(+:lpr)
+#pragma omp parallel for schedule(static)
 #endif
-	for (int i = 0; i < genome.getGenomeSize(); i++)
+	for (int c = 0; c < numChunks; c++)
+	{
+		double *ratios = &chunkRatios[c * numRatios];
+		int end = std::min((c + 1) * (int)hyperParameterChunkSize, numGenes);
+		for (int i = c * hyperParameterChunkSize; i < end; i++)
+		{
+			unsigned mixture = getMixtureAssignment(i);
+			mixture = getSynthesisRateCategory(mixture);
+			if (!std::isfinite(getSynthesisRate(i, mixture, false))) chunkFinite[c] = 0u;
+
+			double logPhi = getLogSynthesisRate(i, mixture, false);
+			ratios[0] += Parameter::densityLogNormLogScale(logPhi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true)
+				   - Parameter::densityLogNormLogScale(logPhi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
+
+			const double *logobsPhi = logObservedPhi + i * numPhiSets;
+			const unsigned char *observed = observedPhiMask + i * numPhiSets;
+			for (unsigned j = 0u; j < numNoiseOffsets; j++)
+			{
+				if (!observed[j]) continue;
+				double proposed = Parameter::densityNorm(logobsPhi[j], logPhi + noiseOffset_proposed[j], observedSynthesisNoise[j], true);
+				double current = Parameter::densityNorm(logobsPhi[j], logPhi + noiseOffset[j], observedSynthesisNoise[j], true);
+				ratios[j + 1] += proposed - current;
+			}
+		}
+	}
+
+	// R can not be called from the worker threads, so non finite phi values are reported afterwards
+	for (int c = 0; c < numChunks; c++)
 	{
-		unsigned mixture = getMixtureAssignment(i);
-		mixture = getSynthesisRateCategory(mixture);
-		double phi = getSynthesisRate(i, mixture, false);
-		if (!std::isfinite(phi))
+		if (chunkFinite[c]) continue;
+		int end = std::min((c + 1) * (int)hyperParameterChunkSize, numGenes);
+		for (int i = c * hyperParameterChunkSize; i < end; i++)
 		{
+			double phi = getSynthesisRate(i, getSynthesisRateCategory(getMixtureAssignment(i)), false);
+			if (!std::isfinite(phi))
+			{
 #ifndef STANDALONE
-			Rf_error("Phi value for gene %d is not finite (%f)!", i, phi);
+				Rf_error("Phi value for gene %d is not finite (%f)!", i, phi);
 #else
-			std::cerr << "phi " << i << " not finite! " << phi << "\n";
+				std::cerr << "phi " << i << " not finite! " << phi << "\n";
 #endif
+			}
 		}
-		lpr += Parameter::densityLogNorm(phi, proposedMphi[mixture], proposedStdDevSynthesisRate[mixture], true)
-			   - Parameter::densityLogNorm(phi, currentMphi[mixture], currentStdDevSynthesisRate[mixture], true);
 	}
 
 	// TODO: USE CONSTANTS INSTEAD OF 0
 	logProbabilityRatio[0] = lpr;
+	for (int c = 0; c < numChunks; c++)
+	{
+		for (unsigned j = 0u; j < numRatios; j++)
+		{
+			logProbabilityRatio[j] += chunkRatios[c * numRatios + j];
+		}
+	}
+}
+
+
+
+
+
+//-----------------------------------------------//
+//---------- Fused Iteration Functions ----------//
+//-----------------------------------------------//
+
+
+bool ROCModel::isFusedIterationSupported()
+{
+	return true;
+}
+
+
+// one for stdDevSynthesisRate and one for each noiseOffset, see calculateLogLikelihoodRatioForHyperParameters
+unsigned ROCModel::getNumHyperParameterLogRatios()
+{
+	return withPhi ? getNumPhiGroupings() + 1 : 1;
+}
 
-	if (withPhi)
+
+void ROCModel::prepareFusedIteration(Genome& genome)
+{
+	unsigned numGroupings = (unsigned)groupListAAIndex.size();
+	unsigned numMutationCategories = parameter->getNumMutationCategories();
+	unsigned numSelectionCategories = parameter->getNumSelectionCategories();
+	fusedMutation.assign(numGroupings * numMutationCategories * 5, 0.0);
+	fusedMutation_proposed.assign(numGroupings * numMutationCategories * 5, 0.0);
+	fusedSelection.assign(numGroupings * numSelectionCategories * 5, 0.0);
+	fusedSelection_proposed.assign(numGroupings * numSelectionCategories * 5, 0.0);
+	for (unsigned g = 0u; g < numGroupings; g++)
 	{
-		for (unsigned i = 0; i < parameter->getNumObservedPhiSets(); i++) {
-			lpr = 0.0;
-			double noiseOffset = getNoiseOffset(i, false);
-			double noiseOffset_proposed = getNoiseOffset(i, true);
-			double observedSynthesisNoise = getObservedSynthesisNoise(i);
-#ifndef __APPLE__
-//#pragma omp parallel for reduction(+:lpr)
-#endif
-			for (int j = 0; j < genome.getGenomeSize(); j++) {
-				unsigned mixtureAssignment = getMixtureAssignment(j);
-				mixtureAssignment = getSynthesisRateCategory(mixtureAssignment);
-				double logphi = std::log(getSynthesisRate(j, mixtureAssignment, false));
-				double obsPhi = genome.getGene(j).getObservedSynthesisRate(i);
-				if (obsPhi > -1.0) {
-					double logobsPhi = std::log(obsPhi);
-					double proposed = Parameter::densityNorm(logobsPhi, logphi + noiseOffset_proposed, observedSynthesisNoise, true);
-					double current = Parameter::densityNorm(logobsPhi, logphi + noiseOffset, observedSynthesisNoise, true);
-					lpr += proposed - current;
-				}
-			}
-			logProbabilityRatio[i+1] = lpr;
+		unsigned aaIndex = groupListAAIndex[g];
+		for (unsigned category = 0u; category < numMutationCategories; category++)
+		{
+			unsigned offset = (g * numMutationCategories + category) * 5;
+			parameter->getParameterForCategory(category, ROCParameter::dM, aaIndex, false, &fusedMutation[offset]);
+			parameter->getParameterForCategory(category, ROCParameter::dM, aaIndex, true, &fusedMutation_proposed[offset]);
+		}
+		for (unsigned category = 0u; category < numSelectionCategories; category++)
+		{
+			unsigned offset = (g * numSelectionCategories + category) * 5;
+			parameter->getParameterForCategory(category, ROCParameter::dEta, aaIndex, false, &fusedSelection[offset]);
+			parameter->getParameterForCategory(category, ROCParameter::dEta, aaIndex, true, &fusedSelection_proposed[offset]);
+		}
+	}
+
+	unsigned numSynthesisRateCategories = getNumSynthesisRateCategories();
+	fusedStdDevSynthesisRate.resize(numSynthesisRateCategories);
+	fusedStdDevSynthesisRate_proposed.resize(numSynthesisRateCategories);
+	for (unsigned i = 0u; i < numSynthesisRateCategories; i++)
+	{
+		fusedStdDevSynthesisRate[i] = getStdDevSynthesisRate(i, false);
+		fusedStdDevSynthesisRate_proposed[i] = getStdDevSynthesisRate(i, true);
+	}
+
+	fusedNumPhiSets = genome.getNumObservedSynthesisRateSets();
+	fusedLogObservedPhi = genome.getLogObservedSynthesisRates();
+	fusedObservedPhiMask = genome.getObservedSynthesisRateMask();
+	unsigned numNoiseOffsets = withPhi ? std::min(parameter->getNumObservedPhiSets(), fusedNumPhiSets) : 0u;
+	fusedNoiseOffset.resize(numNoiseOffsets);
+	fusedNoiseOffset_proposed.resize(numNoiseOffsets);
+	fusedObservedSynthesisNoise.resize(numNoiseOffsets);
+	for (unsigned i = 0u; i < numNoiseOffsets; i++)
+	{
+		fusedNoiseOffset[i] = getNoiseOffset(i, false);
+		fusedNoiseOffset_proposed[i] = getNoiseOffset(i, true);
+		fusedObservedSynthesisNoise[i] = getObservedSynthesisNoise(i);
+	}
+}
+
+
+// Gene terms of calculateLogLikelihoodRatioPerGroupingPerCategory and calculateLogLikelihoodRatioForHyperParameters.
+void ROCModel::addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+			double *hyperParameterLogRatios)
+{
+	SequenceSummary *seqsum = gene.getSequenceSummary();
+
+	// which mixture element does this gene belong to
+	unsigned mixtureElement = parameter->getMixtureAssignment(geneIndex);
+	// how is the mixture element defined. Which categories make it up
+	unsigned mutationCategory = parameter->getMutationCategory(mixtureElement);
+	unsigned selectionCategory = parameter->getSelectionCategory(mixtureElement);
+	unsigned expressionCategory = parameter->getSynthesisRateCategory(mixtureElement);
+	double phi = parameter->getSynthesisRate(geneIndex, expressionCategory, false);
+	double logPhi = parameter->getLogSynthesisRate(geneIndex, expressionCategory, false);
+
+	unsigned numMutationCategories = parameter->getNumMutationCategories();
+	unsigned numSelectionCategories = parameter->getNumSelectionCategories();
+	unsigned codonCount[6];
+	double logLikelihood[1];
+	for (unsigned g = 0u; g < groupListAAIndex.size(); g++)
+	{
+		unsigned aaIndex = groupListAAIndex[g];
+		unsigned numCodons = SequenceSummary::GetNumCodonsForAAIndex(aaIndex);
+		unsigned aaStart = SequenceSummary::codonRangeForAAIndex[aaIndex][0];
+		unsigned aaCount = 0u;
+		for (unsigned j = 0u; j < numCodons; j++)
+		{
+			codonCount[j] = seqsum->getCodonCountForCodon(aaStart + j);
+			aaCount += codonCount[j];
 		}
+		if (aaCount == 0u) continue;
+
+		unsigned m = (g * numMutationCategories + mutationCategory) * 5;
+		unsigned s = (g * numSelectionCategories + selectionCategory) * 5;
+		codonSpecificLogLikelihoods[2 * g] += calculateLogLikelihoodPerAAForGeneBlock(numCodons, 1u, 1u, codonCount, &phi,
+					&fusedMutation[m], &fusedSelection[s], logLikelihood);
+		codonSpecificLogLikelihoods[2 * g + 1] += calculateLogLikelihoodPerAAForGeneBlock(numCodons, 1u, 1u, codonCount, &phi,
+					&fusedMutation_proposed[m], &fusedSelection_proposed[s], logLikelihood);
+	}
+
+	double stdDevSynthesisRate = fusedStdDevSynthesisRate[expressionCategory];
+	double stdDevSynthesisRate_proposed = fusedStdDevSynthesisRate_proposed[expressionCategory];
+	double mPhi = -(stdDevSynthesisRate * stdDevSynthesisRate) * 0.5;
+	double mPhi_proposed = -(stdDevSynthesisRate_proposed * stdDevSynthesisRate_proposed) * 0.5;
+	hyperParameterLogRatios[0] += Parameter::densityLogNormLogScale(logPhi, mPhi_proposed, stdDevSynthesisRate_proposed, true)
+			- Parameter::densityLogNormLogScale(logPhi, mPhi, stdDevSynthesisRate, true);
+
+	const double *logobsPhi = fusedLogObservedPhi + geneIndex * fusedNumPhiSets;
+	const unsigned char *observed = fusedObservedPhiMask + geneIndex * fusedNumPhiSets;
+	for (unsigned i = 0u; i < fusedNoiseOffset.size(); i++)
+	{
+		if (!observed[i]) continue;
+		hyperParameterLogRatios[i + 1] += Parameter::densityNorm(logobsPhi[i], logPhi + fusedNoiseOffset_proposed[i], fusedObservedSynthesisNoise[i], true)
+				- Parameter::densityNorm(logobsPhi[i], logPhi + fusedNoiseOffset[i], fusedObservedSynthesisNoise[i], true);
+	}
+}
+
+
+void ROCModel::completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+			std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios)
+{
+	unsigned numGroupings = (unsigned)groupListAAIndex.size();
+	codonSpecificLogRatios.resize(numGroupings);
+	for (unsigned g = 0u; g < numGroupings; g++)
+	{
+		std::string grouping = getGrouping(g);
+		double likelihood = inverseTemperature * codonSpecificLogLikelihoods[2 * g] + calculateMutationPrior(grouping, false);
+		double likelihood_proposed = inverseTemperature * codonSpecificLogLikelihoods[2 * g + 1] + calculateMutationPrior(grouping, true);
+		codonSpecificLogRatios[g] = likelihood_proposed - likelihood;
+	}
+
+	// take the jacobian into account for the non-linear transformation from logN to N distribution
+	for (unsigned i = 0u; i < fusedStdDevSynthesisRate.size(); i++)
+	{
+		hyperParameterLogRatios[0] -= (std::log(fusedStdDevSynthesisRate[i]) - std::log(fusedStdDevSynthesisRate_proposed[i]));
 	}
 }
 
@@ -331,7 +691,7 @@ unsigned ROCModel::getSynthesisRateCategory(unsigned mixture)
 }
 
 
-std::vector<unsigned> ROCModel::getMixtureElementsOfSelectionCategory(unsigned k)
+std::vector<unsigned>& ROCModel::getMixtureElementsOfSelectionCategory(unsigned k)
 {
 	return parameter->getMixtureElementsOfSelectionCategory(k);
 }
@@ -397,6 +757,12 @@ double ROCModel::getSynthesisRate(unsigned index, unsigned mixture, bool propose
 }
 
 
+double ROCModel::getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed)
+{
+	return parameter->getLogSynthesisRate(index, mixture, proposed);
+}
+
+
 void ROCModel::updateSynthesisRate(unsigned i, unsigned k)
 {
 	parameter->updateSynthesisRate(i,k);
@@ -488,6 +854,12 @@ void ROCModel::updateTracesWithInitialValues(Genome &genome)
 }
 
 
+Trace& ROCModel::getTraceObject()
+{
+	return parameter->getTraceObject();
+}
+
+
 
 
 
@@ -605,15 +977,17 @@ void ROCModel::updateGibbsSampledHyperParameters(Genome &genome)
 	// TODO: Fix this for any numbers of phi values
 	if (withPhi) {
 		double shape = ((double)genome.getGenomeSize() - 1.0) / 2.0;
-		for (unsigned i = 0; i < parameter->getNumObservedPhiSets(); i++) {
+		unsigned numPhiSets = genome.getNumObservedSynthesisRateSets();
+		const double *logObservedPhi = genome.getLogObservedSynthesisRates();
+		const unsigned char *observedPhiMask = genome.getObservedSynthesisRateMask();
+		for (unsigned i = 0; i < std::min(parameter->getNumObservedPhiSets(), numPhiSets); i++) {
 			double rate = 0.0;
 			unsigned mixtureAssignment;
 			double noiseOffset = getNoiseOffset(i);
 			for (unsigned j = 0; j < genome.getGenomeSize(); j++) {
 				mixtureAssignment = getMixtureAssignment(j);
-				double obsPhi = genome.getGene(j).getObservedSynthesisRate(i);
-				if (obsPhi > -1.0) {
-					double sum = std::log(obsPhi) - noiseOffset - std::log(getSynthesisRate(j, mixtureAssignment, false));
+				if (observedPhiMask[j * numPhiSets + i]) {
+					double sum = logObservedPhi[j * numPhiSets + i] - noiseOffset - getLogSynthesisRate(j, mixtureAssignment, false);
 					//double sum = std::log(obsPhi) - std::log(getSynthesisRate(j, mixtureAssignment, false));
 					rate += sum * sum;
 				}
@@ -775,6 +1149,12 @@ void ROCModel::printHyperParameters()
 void ROCModel::setParameter(ROCParameter &_parameter)
 {
 	parameter = &_parameter;
+
+	groupListAAIndex.clear();
+	for (unsigned i = 0u; i < parameter->getGroupListSize(); i++)
+	{
+		groupListAAIndex.push_back(SequenceSummary::AAToAAIndex(parameter->getGrouping(i)));
+	}
 }
 
 
@@ -795,6 +1175,22 @@ double ROCModel::calculateAllPriors()
 }
 
 
+// Untempered codon log likelihood of the current state, sum over all amino acids and genes.
+double ROCModel::calculateLogLikelihood(Genome& genome)
+{
+	std::vector<double> likelihood;
+	std::vector<double> likelihood_proposed;
+	calculateLogLikelihoodsPerAA(genome, groupListAAIndex, likelihood, likelihood_proposed);
+
+	double logLikelihood = 0.0;
+	for (unsigned k = 0u; k < likelihood.size(); k++)
+	{
+		logLikelihood += likelihood[k];
+	}
+	return logLikelihood;
+}
+
+
 void ROCModel::calculateCodonProbabilityVector(unsigned numCodons, double mutation[], double selection[], double phi, double codonProb[])
 {
 	// calculate numerator and denominator for codon probabilities
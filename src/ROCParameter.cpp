@@ -15,15 +15,15 @@ ROCParameter::ROCParameter() : Parameter()
 	//CTOR
 	bias_csp = 0;
 	mutation_prior_sd = 0.35;
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 }
 
 
 ROCParameter::ROCParameter(std::string filename) : Parameter(22)
 {
-	currentCodonSpecificParameter.resize(2);
-	proposedCodonSpecificParameter.resize(2);
+	currentCodonSpecificParameter.initialize(2, 0u);
+	proposedCodonSpecificParameter.initialize(2, 0u);
 	initFromRestartFile(filename);
 }
 
@@ -91,28 +91,14 @@ void ROCParameter::initROCParameterSet()
 
 	//may need getter fcts
 
-	proposedCodonSpecificParameter.resize(2);
-	currentCodonSpecificParameter.resize(2);
+	proposedCodonSpecificParameter.initialize(2, numParam);
+	currentCodonSpecificParameter.initialize(2, numParam);
 
-	currentCodonSpecificParameter[dM].resize(numMutationCategories);
-	proposedCodonSpecificParameter[dM].resize(numMutationCategories);
+	currentCodonSpecificParameter.resizeParameterType(dM, numMutationCategories);
+	proposedCodonSpecificParameter.resizeParameterType(dM, numMutationCategories);
 
-	for (unsigned i = 0u; i < numMutationCategories; i++)
-	{
-		std::vector<double> tmp(numParam, 0.0);
-		currentCodonSpecificParameter[dM][i] = tmp;
-		proposedCodonSpecificParameter[dM][i] = tmp;
-	}
-
-	currentCodonSpecificParameter[dEta].resize(numSelectionCategories);
-	proposedCodonSpecificParameter[dEta].resize(numSelectionCategories);
-
-	for (unsigned i = 0u; i < numSelectionCategories; i++)
-	{
-		std::vector<double> tmp(numParam, 0.0);
-		proposedCodonSpecificParameter[dEta][i] = tmp;
-		currentCodonSpecificParameter[dEta][i] = tmp;
-	}
+	currentCodonSpecificParameter.resizeParameterType(dEta, numSelectionCategories);
+	proposedCodonSpecificParameter.resizeParameterType(dEta, numSelectionCategories);
 
   for (unsigned i = 0; i < maxGrouping; i++)
   {
@@ -130,6 +116,8 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 	std::ifstream input;
 	covarianceMatrix.resize(maxGrouping);
 	std::vector <double> mat;
+	std::vector<std::vector<double>> mutationValues;
+	std::vector<std::vector<double>> selectionValues;
 	input.open(filename.c_str());
 	if (input.fail())
 	{
@@ -186,7 +174,7 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 				{
 					if (tmp == "***")
 					{
-						currentCodonSpecificParameter[dM].resize(currentCodonSpecificParameter[dM].size() + 1);
+						mutationValues.resize(mutationValues.size() + 1);
 						cat++;
 					}
 					else if (tmp == "\n")
@@ -197,7 +185,7 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 						iss.str(tmp);
 						while (iss >> val)
 						{
-							currentCodonSpecificParameter[dM][cat - 1].push_back(val);
+							mutationValues[cat - 1].push_back(val);
 						}
 					}
 				}
@@ -205,7 +193,7 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 				{
 					if (tmp == "***")
 					{
-						currentCodonSpecificParameter[dEta].resize(currentCodonSpecificParameter[dEta].size() + 1);
+						selectionValues.resize(selectionValues.size() + 1);
 						cat++;
 					}
 					else if (tmp == "\n")
@@ -216,7 +204,7 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 						iss.str(tmp);
 						while (iss >> val)
 						{
-							currentCodonSpecificParameter[dEta][cat - 1].push_back(val);
+							selectionValues[cat - 1].push_back(val);
 						}
 					}
 				}
@@ -278,16 +266,9 @@ void ROCParameter::initROCValuesFromFile(std::string filename)
 
 	//init other values
 	bias_csp = 0;
-	proposedCodonSpecificParameter[dM].resize(numMutationCategories);
-	proposedCodonSpecificParameter[dEta].resize(numSelectionCategories);
-	for (unsigned i = 0; i < numMutationCategories; i++)
-	{
-		proposedCodonSpecificParameter[dM][i] = currentCodonSpecificParameter[dM][i];
-	}
-	for (unsigned i = 0; i < numSelectionCategories; i++)
-	{
-		proposedCodonSpecificParameter[dEta][i] = currentCodonSpecificParameter[dEta][i];
-	}
+	currentCodonSpecificParameter.setParameterType(dM, mutationValues);
+	currentCodonSpecificParameter.setParameterType(dEta, selectionValues);
+	proposedCodonSpecificParameter = currentCodonSpecificParameter;
 }
 
 
@@ -365,7 +346,7 @@ void ROCParameter::writeROCRestartFile(std::string filename)
 		for (unsigned i = 0; i < currentCodonSpecificParameter[dM].size(); i++)
 		{
 			oss << "***\n";
-			for (j = 0; j < currentCodonSpecificParameter[dM][i].size(); j++)
+			for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
 			{
 				oss << currentCodonSpecificParameter[dM][i][j];
 				if ((j + 1) % 10 == 0)
@@ -381,7 +362,7 @@ void ROCParameter::writeROCRestartFile(std::string filename)
 		for (unsigned i = 0; i < currentCodonSpecificParameter[dEta].size(); i++)
 		{
 			oss << "***\n";
-			for (j = 0; j < currentCodonSpecificParameter[dEta][i].size(); j++)
+			for (j = 0; j < currentCodonSpecificParameter.getNumCodons(); j++)
 			{
 				oss << currentCodonSpecificParameter[dEta][i][j];
 				if ((j + 1) % 10 == 0)
@@ -537,6 +518,7 @@ void ROCParameter::updateCodonSpecificParameterTrace(unsigned sample, std::strin
 {
 	traces.updateCodonSpecificParameterTraceForAA(sample, grouping, currentCodonSpecificParameter[dM], dM);
 	traces.updateCodonSpecificParameterTraceForAA(sample, grouping, currentCodonSpecificParameter[dEta], dEta);
+	if (sample > 0u) updateCodonSpecificParameterCovariance(grouping);
 }
 
 
@@ -636,16 +618,13 @@ void ROCParameter::proposeCodonSpecificParameter()
 
 	for (unsigned k = 0; k < getGroupListSize(); k++)
 	{
-		std::vector<double> iidProposed;
 		std::string aa = getGrouping(k);
 		unsigned aaStart;
 		unsigned aaEnd;
 		SequenceSummary::AAToCodonRange(aa, aaStart, aaEnd, true);
 		unsigned numCodons = aaEnd - aaStart;
-		for (unsigned i = 0u; i < (numCodons * (numMutationCategories + numSelectionCategories)); i++)
-		{
-			iidProposed.push_back(randNorm(0.0, 1.0));
-		}
+		std::vector<double> iidProposed(numCodons * (numMutationCategories + numSelectionCategories));
+		randNormVector((unsigned)iidProposed.size(), 0.0, 1.0, iidProposed.data());
 
 		std::vector<double> covaryingNums;
 		covaryingNums = covarianceMatrix[SequenceSummary::AAToAAIndex(aa)].transformIidNumersIntoCovaryingNumbers(
@@ -677,20 +656,7 @@ void ROCParameter::updateCodonSpecificParameter(std::string grouping)
 	unsigned aaIndex = SequenceSummary::aaToIndex.find(grouping)->second;
 	numAcceptForCodonSpecificParameters[aaIndex]++;
 
-	for (unsigned k = 0u; k < numMutationCategories; k++)
-	{
-		for (unsigned i = aaStart; i < aaEnd; i++)
-		{
-			currentCodonSpecificParameter[dM][k][i] = proposedCodonSpecificParameter[dM][k][i];
-		}
-	}
-	for (unsigned k = 0u; k < numSelectionCategories; k++)
-	{
-		for (unsigned i = aaStart; i < aaEnd; i++)
-		{
-			currentCodonSpecificParameter[dEta][k][i] = proposedCodonSpecificParameter[dEta][k][i];
-		}
-	}
+	currentCodonSpecificParameter.copyCodonRange(proposedCodonSpecificParameter, aaStart, aaEnd);
 }
 
 
@@ -821,8 +787,7 @@ void ROCParameter::setNumObservedPhiSets(unsigned _phiGroupings)
 void ROCParameter::getParameterForCategory(unsigned category, unsigned paramType, std::string aa, bool proposal,
 										   double *returnSet)
 {
-	std::vector<double> *tempSet;
-	tempSet = (proposal ? &proposedCodonSpecificParameter[paramType][category] : &currentCodonSpecificParameter[paramType][category]);
+	double *tempSet = (proposal ? proposedCodonSpecificParameter[paramType][category] : currentCodonSpecificParameter[paramType][category]);
 
 	unsigned aaStart;
 	unsigned aaEnd;
@@ -831,7 +796,23 @@ void ROCParameter::getParameterForCategory(unsigned category, unsigned paramType
 	unsigned j = 0u;
 	for (unsigned i = aaStart; i < aaEnd; i++, j++)
 	{
-		returnSet[j] = tempSet->at(i);
+		returnSet[j] = tempSet[i];
+	}
+}
+
+
+void ROCParameter::getParameterForCategory(unsigned category, unsigned paramType, unsigned aaIndex, bool proposal,
+										   double *returnSet)
+{
+	double *tempSet = (proposal ? proposedCodonSpecificParameter[paramType][category] : currentCodonSpecificParameter[paramType][category]);
+
+	unsigned aaStart = SequenceSummary::codonRangeForAAIndexParameter[aaIndex][0];
+	unsigned aaEnd = SequenceSummary::codonRangeForAAIndexParameter[aaIndex][1];
+
+	unsigned j = 0u;
+	for (unsigned i = aaStart; i < aaEnd; i++, j++)
+	{
+		returnSet[j] = tempSet[i];
 	}
 }
 
@@ -964,49 +945,49 @@ void ROCParameter::initSelection(std::vector<double> selectionValues, unsigned m
 
 std::vector<std::vector<double>> ROCParameter::getProposedMutationParameter()
 {
-	return proposedCodonSpecificParameter[dM];
+	return proposedCodonSpecificParameter.getParameterType(dM);
 }
 
 
 std::vector<std::vector<double>> ROCParameter::getCurrentMutationParameter()
 {
-	return currentCodonSpecificParameter[dM];
+	return currentCodonSpecificParameter.getParameterType(dM);
 }
 
 
 std::vector<std::vector<double>> ROCParameter::getProposedSelectionParameter()
 {
-	return proposedCodonSpecificParameter[dEta];
+	return proposedCodonSpecificParameter.getParameterType(dEta);
 }
 
 
 std::vector<std::vector<double>> ROCParameter::getCurrentSelectionParameter()
 {
-	return currentCodonSpecificParameter[dEta];
+	return currentCodonSpecificParameter.getParameterType(dEta);
 }
 
 
 void ROCParameter::setProposedMutationParameter(std::vector<std::vector<double>> _proposedMutationParameter)
 {
-	proposedCodonSpecificParameter[dM] = _proposedMutationParameter;
+	proposedCodonSpecificParameter.setParameterType(dM, _proposedMutationParameter);
 }
 
 
 void ROCParameter::setCurrentMutationParameter(std::vector<std::vector<double>> _currentMutationParameter)
 {
-	currentCodonSpecificParameter[dM] = _currentMutationParameter;
+	currentCodonSpecificParameter.setParameterType(dM, _currentMutationParameter);
 }
 
 
 void ROCParameter::setProposedSelectionParameter(std::vector<std::vector<double>> _proposedSelectionParameter)
 {
-	proposedCodonSpecificParameter[dEta] = _proposedSelectionParameter;
+	proposedCodonSpecificParameter.setParameterType(dEta, _proposedSelectionParameter);
 }
 
 
 void ROCParameter::setCurrentSelectionParameter(std::vector<std::vector<double>> _currentSelectionParameter)
 {
-	currentCodonSpecificParameter[dEta] = _currentSelectionParameter;
+	currentCodonSpecificParameter.setParameterType(dEta, _currentSelectionParameter);
 }
 
 
@@ -0,0 +1,254 @@
+#include "include/RandomStream.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+const unsigned RandomStream::fillBlockSize;
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+RandomStream::RandomStream()
+{
+	setStream(0u, 0u, 0u);
+}
+
+
+RandomStream::RandomStream(uint64_t seed, uint32_t iteration, uint32_t gene)
+{
+	setStream(seed, iteration, gene);
+}
+
+
+RandomStream::~RandomStream()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Stream Functions ----------//
+//--------------------------------------//
+
+
+// Same as std engines: reseeds and restarts the stream. Used for the main stream.
+void RandomStream::seed(uint64_t seed)
+{
+	setStream(seed, 0u, 0u);
+}
+
+
+void RandomStream::setStream(uint64_t seed, uint32_t iteration, uint32_t gene)
+{
+	key[0] = (uint32_t)seed;
+	key[1] = (uint32_t)(seed >> 32);
+	counter[0] = 0u;
+	counter[1] = 0u;
+	counter[2] = gene;
+	counter[3] = iteration;
+	position = 4u;
+	hasSavedNorm = false;
+	savedNorm = 0.0;
+}
+
+
+// Skips z 32 bit words. Jumping ahead is just a change of the counter.
+void RandomStream::discard(unsigned long long z)
+{
+	while (z > 0u && position < 4u)
+	{
+		position++;
+		z--;
+	}
+	unsigned long long blocks = z / 4u;
+	uint64_t blockIndex = ((uint64_t)counter[1] << 32 | counter[0]) + blocks;
+	counter[0] = (uint32_t)blockIndex;
+	counter[1] = (uint32_t)(blockIndex >> 32);
+	if (z % 4u != 0u)
+	{
+		nextBlock();
+		position = (unsigned)(z % 4u);
+	}
+}
+
+
+RandomStream::result_type RandomStream::operator()()
+{
+	if (position == 4u) nextBlock();
+	return block[position++];
+}
+
+
+void RandomStream::nextBlock()
+{
+	philox(key, counter, block);
+	position = 0u;
+	if (++counter[0] == 0u) counter[1]++;
+}
+
+
+
+
+
+//------------------------------------//
+//---------- Draw Functions ----------//
+//------------------------------------//
+
+
+// Uniform on the open interval (0, 1) with 53 random bits, so log(u) is always finite.
+double RandomStream::nextUnif()
+{
+	uint64_t a = (*this)() >> 5; // 27 bits
+	uint64_t b = (*this)() >> 6; // 26 bits
+	return ((double)(a << 26 | b) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+
+// Standard normal by the Box-Muller transformation.
+double RandomStream::nextNorm()
+{
+	if (hasSavedNorm)
+	{
+		hasSavedNorm = false;
+		return savedNorm;
+	}
+	double r = std::sqrt(-2.0 * std::log(nextUnif()));
+	double theta = 6.283185307179586 * nextUnif();
+	savedNorm = r * std::sin(theta);
+	hasSavedNorm = true;
+	return r * std::cos(theta);
+}
+
+
+// Standard exponential by inversion.
+double RandomStream::nextExp()
+{
+	return -std::log(nextUnif());
+}
+
+
+void RandomStream::fillUnif(double *output, unsigned n, double minVal, double maxVal)
+{
+	double range = maxVal - minVal;
+	for (unsigned i = 0u; i < n; i++)
+	{
+		output[i] = minVal + range * nextUnif();
+	}
+}
+
+
+// Box-Muller on blocks of pairs: the uniforms of a block are drawn first, then the transformation
+// runs over the whole block without any dependency between pairs, so the compiler can vectorize
+// it. Gives exactly the values n calls of nextNorm would give.
+void RandomStream::fillNorm(double *output, unsigned n, double mean, double sd)
+{
+	double u[2u * fillBlockSize];
+	unsigned i = 0u;
+	if (n > 0u && hasSavedNorm)
+	{
+		output[i++] = mean + sd * nextNorm();
+	}
+	while (n - i >= 2u)
+	{
+		unsigned pairs = std::min((n - i) / 2u, fillBlockSize);
+		for (unsigned j = 0u; j < 2u * pairs; j++)
+		{
+			u[j] = nextUnif();
+		}
+		double *out = output + i;
+#ifndef __APPLE__
+#pragma omp simd
+#endif
+		for (unsigned j = 0u; j < pairs; j++)
+		{
+			double r = std::sqrt(-2.0 * std::log(u[2u * j]));
+			double theta = 6.283185307179586 * u[2u * j + 1u];
+			out[2u * j] = mean + sd * (r * std::cos(theta));
+			out[2u * j + 1u] = mean + sd * (r * std::sin(theta));
+		}
+		i += 2u * pairs;
+	}
+	if (i < n)
+	{
+		output[i] = mean + sd * nextNorm();
+	}
+}
+
+
+// Inversion on blocks, see fillNorm.
+void RandomStream::fillExp(double *output, unsigned n, double rate)
+{
+	double u[fillBlockSize];
+	for (unsigned i = 0u; i < n; i += fillBlockSize)
+	{
+		unsigned count = std::min(n - i, fillBlockSize);
+		for (unsigned j = 0u; j < count; j++)
+		{
+			u[j] = nextUnif();
+		}
+		double *out = output + i;
+#ifndef __APPLE__
+#pragma omp simd
+#endif
+		for (unsigned j = 0u; j < count; j++)
+		{
+			out[j] = -std::log(u[j]) / rate;
+		}
+	}
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Static Functions ----------//
+//--------------------------------------//
+
+
+// Ten Philox rounds on one 128 bit counter.
+void RandomStream::philox(const uint32_t key[2], const uint32_t counter[4], uint32_t output[4])
+{
+	const uint32_t M0 = 0xD2511F53u;
+	const uint32_t M1 = 0xCD9E8D57u;
+	const uint32_t W0 = 0x9E3779B9u;
+	const uint32_t W1 = 0xBB67AE85u;
+
+	uint32_t k0 = key[0];
+	uint32_t k1 = key[1];
+	uint32_t c0 = counter[0];
+	uint32_t c1 = counter[1];
+	uint32_t c2 = counter[2];
+	uint32_t c3 = counter[3];
+
+	for (unsigned round = 0u; round < 10u; round++)
+	{
+		uint64_t product0 = (uint64_t)M0 * c0;
+		uint64_t product1 = (uint64_t)M1 * c2;
+		uint32_t hi0 = (uint32_t)(product0 >> 32);
+		uint32_t lo0 = (uint32_t)product0;
+		uint32_t hi1 = (uint32_t)(product1 >> 32);
+		uint32_t lo1 = (uint32_t)product1;
+
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = lo1;
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = lo0;
+
+		k0 += W0;
+		k1 += W1;
+	}
+
+	output[0] = c0;
+	output[1] = c1;
+	output[2] = c2;
+	output[3] = c3;
+}
@@ -33,6 +33,15 @@ const std::map<std::string, unsigned> SequenceSummary::aaToIndex = {{"A", 0}, {"
 	{"G", 5}, {"H", 6}, {"I", 7}, {"K", 8}, {"L", 9}, {"M", 10}, {"N", 11}, {"P", 12}, {"Q", 13}, {"R", 14}, {"S", 15},
 	{"T", 16}, {"V", 17}, {"W", 18}, {"Y", 19}, {SequenceSummary::Ser2, 20}, {"X", 21}};
 
+// Same ranges as the switch in AAToCodonRange, but addressable by amino acid index for the likelihood loops.
+const unsigned SequenceSummary::codonRangeForAAIndex[22][2] = {{0, 4}, {4, 6}, {6, 8}, {8, 10}, {10, 12}, {12, 16},
+	{16, 18}, {18, 21}, {21, 23}, {23, 29}, {29, 30}, {30, 32}, {32, 36}, {36, 38}, {38, 44}, {44, 48}, {48, 52},
+	{52, 56}, {56, 57}, {57, 59}, {59, 61}, {61, 64}};
+
+const unsigned SequenceSummary::codonRangeForAAIndexParameter[22][2] = {{0, 3}, {3, 4}, {4, 5}, {5, 6}, {6, 7},
+	{7, 10}, {10, 11}, {11, 13}, {13, 14}, {14, 19}, {19, 19}, {19, 20}, {20, 23}, {23, 24}, {24, 29}, {29, 32},
+	{32, 35}, {35, 38}, {38, 38}, {38, 39}, {39, 40}, {40, 40}};
+
 const std::map<std::string, unsigned> SequenceSummary::codonToIndexWithReference = {{"GCA", 0}, {"GCC", 1}, {"GCG", 2},
 	{"GCT", 3}, {"TGC", 4}, {"TGT", 5}, {"GAC", 6}, {"GAT", 7}, {"GAA", 8}, {"GAG", 9}, {"TTC", 10}, {"TTT", 11},
 	{"GGA", 12}, {"GGC", 13}, {"GGG", 14}, {"GGT", 15}, {"CAC", 16}, {"CAT", 17}, {"ATA", 18}, {"ATC", 19}, {"ATT", 20},
@@ -273,8 +282,9 @@ unsigned SequenceSummary::AAToAAIndex(std::string aa)
 
 void SequenceSummary::AAIndexToCodonRange(unsigned aaIndex, unsigned& startAAIndex, unsigned& endAAIndex, bool forParamVector)
 {
-	std::string aa = indexToAA(aaIndex);
-	AAToCodonRange(aa, startAAIndex, endAAIndex, forParamVector);
+	const unsigned *range = forParamVector ? codonRangeForAAIndexParameter[aaIndex] : codonRangeForAAIndex[aaIndex];
+	startAAIndex = range[0];
+	endAAIndex = range[1];
 }
 
 //std::array<unsigned, 2>
@@ -614,6 +624,13 @@ unsigned SequenceSummary::GetNumCodonsForAA(std::string& aa, bool forParamVector
 }
 
 
+unsigned SequenceSummary::GetNumCodonsForAAIndex(unsigned aaIndex, bool forParamVector)
+{
+	unsigned ncodon = codonRangeForAAIndex[aaIndex][1] - codonRangeForAAIndex[aaIndex][0];
+	return (forParamVector ? (ncodon - 1) : ncodon);
+}
+
+
 char SequenceSummary::complimentNucleotide(char ch)
 {
 	if( ch == 'A' ) return 'T';
@@ -0,0 +1,142 @@
+#include "include/SynthesisRateBlock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+SynthesisRateBlock::SynthesisRateBlock()
+{
+	alignOffset = 0u;
+	numGenes = 0u;
+	columnStride = 0u;
+}
+
+
+SynthesisRateBlock::SynthesisRateBlock(const SynthesisRateBlock& other)
+{
+	alignOffset = 0u;
+	numGenes = 0u;
+	columnStride = 0u;
+	*this = other;
+}
+
+
+// Same as CodonSpecificParameterSet: the alignment offset depends on the address of the buffer,
+// so the columns are copied into a freshly aligned buffer.
+SynthesisRateBlock& SynthesisRateBlock::operator=(const SynthesisRateBlock& rhs)
+{
+	if (this == &rhs) return *this; // handle self assignment
+	numAccept = rhs.numAccept;
+	numGenes = rhs.numGenes;
+	columnStride = rhs.columnStride;
+
+	unsigned size = numColumns * columnStride;
+	values.assign(size + alignment, 0.0);
+	uintptr_t misalignment = ((uintptr_t)values.data() % (alignment * sizeof(double))) / sizeof(double);
+	alignOffset = (unsigned)((alignment - misalignment) % alignment);
+	if (size > 0u)
+		std::copy(rhs.values.begin() + rhs.alignOffset, rhs.values.begin() + rhs.alignOffset + size, column(currentPhi));
+	return *this;
+}
+
+
+SynthesisRateBlock::~SynthesisRateBlock()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Layout Functions ----------//
+//--------------------------------------//
+
+
+// Sets up numGenes genes with phi = 0 and the given proposal width. Resets all acceptance counts.
+void SynthesisRateBlock::resize(unsigned _numGenes, double _proposalWidth)
+{
+	numGenes = _numGenes;
+	columnStride = ((numGenes + alignment - 1u) / alignment) * alignment;
+
+	values.assign(numColumns * columnStride + alignment, 0.0);
+	uintptr_t misalignment = ((uintptr_t)values.data() % (alignment * sizeof(double))) / sizeof(double);
+	alignOffset = (unsigned)((alignment - misalignment) % alignment);
+	std::fill(column(proposalWidth), column(proposalWidth) + numGenes, _proposalWidth);
+	numAccept.assign(numGenes, 0u);
+}
+
+
+unsigned SynthesisRateBlock::size()
+{
+	return numGenes;
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Access Functions ----------//
+//--------------------------------------//
+
+
+void SynthesisRateBlock::setSynthesisRate(unsigned geneIndex, double phi)
+{
+	column(currentPhi)[geneIndex] = phi;
+	column(currentLogPhi)[geneIndex] = std::log(phi);
+}
+
+
+void SynthesisRateBlock::acceptProposal(unsigned geneIndex)
+{
+	numAccept[geneIndex]++;
+	column(currentPhi)[geneIndex] = column(proposedPhi)[geneIndex];
+	column(currentLogPhi)[geneIndex] = column(proposedLogPhi)[geneIndex];
+}
+
+
+// Copy of the current phi values, e.g. for R or restart files.
+std::vector<double> SynthesisRateBlock::getSynthesisRateVector()
+{
+	double *phi = column(currentPhi);
+	return std::vector<double>(phi, phi + numGenes);
+}
+
+
+
+
+
+//----------------------------------------//
+//---------- Proposal Functions ----------//
+//----------------------------------------//
+
+
+// Log-normal proposal for all genes: log(phi') = log(phi) + width * z. The draws are passed in
+// because the random number generators are sequential; the transformation itself runs over the
+// contiguous columns and is split between threads for large genomes.
+void SynthesisRateBlock::propose(const double *standardNormals)
+{
+	const double *logPhi = column(currentLogPhi);
+	const double *width = column(proposalWidth);
+	double *proposedLog = column(proposedLogPhi);
+	double *proposed = column(proposedPhi);
+	int n = (int)numGenes;
+
+#ifndef __APPLE__
+#pragma omp parallel for simd if(numGenes >= parallelProposalThreshold)
+#endif
+	for (int i = 0; i < n; i++)
+	{
+		proposedLog[i] = logPhi[i] + width[i] * standardNormals[i];
+		proposed[i] = std::exp(proposedLog[i]);
+	}
+}
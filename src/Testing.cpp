@@ -1,4 +1,8 @@
 #include "include/Testing.h"
+#include <cmath>
+#ifdef STANDALONE
+#include <thread>
+#endif
 
 
 void testSequenceSummary()
@@ -1210,6 +1214,87 @@ void testGenome(std::string testFileDir)
     }
 
 
+    //--------------------------------------------------------------//
+    //------ getCodonCountsForGene & getGenesWithAA Functions ------//
+    //--------------------------------------------------------------//
+
+    const unsigned *codonCounts = genome.getCodonCountsForGene(0);
+    for (unsigned i = 0; i < 64; i++)
+    {
+        if (codonCounts[i] != g1.geneData.getCodonCountForCodon(i))
+        {
+            std::cerr <<"Error with getCodonCountsForGene. Codon index " << i << " should be ";
+            std::cerr << g1.geneData.getCodonCountForCodon(i) << ", returns " << codonCounts[i] << ".\n";
+            error = 1;
+        }
+    }
+
+    // g1 contains Ala (index 0) but no Cys (index 1)
+    if (genome.getGenesWithAA(0).size() != 1 || genome.getGenesWithAA(1).size() != 0)
+    {
+        std::cerr <<"Error with getGenesWithAA. Ala should occur in 1 gene and Cys in none.\n";
+        error = 1;
+    }
+    if (genome.getCodonCountsForAA(0)[1] != 1) // GCC
+    {
+        std::cerr <<"Error with getCodonCountsForAA. GCC should be counted once, returns ";
+        std::cerr << genome.getCodonCountsForAA(0)[1] << ".\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"Genome getCodonCountsForGene & getGenesWithAA --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
+    //-----------------------------------------------------------------------------------//
+    //------ getLogObservedSynthesisRates & getObservedSynthesisRateMask Functions ------//
+    //-----------------------------------------------------------------------------------//
+
+    Genome phiGenome;
+    Gene phiGene1("ATGGCCTAG", "phi1", "");
+    Gene phiGene2("ATGGCCTAG", "phi2", "");
+    std::vector <double> phiValues1 = {1.0, -1.0};
+    std::vector <double> phiValues2 = {std::exp(1.0), 2.0};
+    phiGene1.setObservedSynthesisRateValues(phiValues1);
+    phiGene2.setObservedSynthesisRateValues(phiValues2);
+    phiGenome.addGene(phiGene1);
+    phiGenome.addGene(phiGene2);
+
+    const double *logPhi = phiGenome.getLogObservedSynthesisRates();
+    const unsigned char *mask = phiGenome.getObservedSynthesisRateMask();
+    if (2 != phiGenome.getNumObservedSynthesisRateSets())
+    {
+        std::cerr <<"Error with getNumObservedSynthesisRateSets. Should return 2, returns ";
+        std::cerr << phiGenome.getNumObservedSynthesisRateSets() <<".\n";
+        error = 1;
+    }
+    else if (mask[0] != 1 || mask[1] != 0 || mask[2] != 1 || mask[3] != 1)
+    {
+        std::cerr <<"Error with getObservedSynthesisRateMask. Only the -1 of the first gene should be masked.\n";
+        error = 1;
+    }
+    else if (std::abs(logPhi[0]) > 1e-12 || std::abs(logPhi[2] - 1.0) > 1e-12 || std::abs(logPhi[3] - std::log(2.0)) > 1e-12)
+    {
+        std::cerr <<"Error with getLogObservedSynthesisRates. Should return 0, 1 and log(2) for the observed values.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"Genome getLogObservedSynthesisRates & getObservedSynthesisRateMask --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
     //--------------------------------------------//
     //------ readObservedPhiValues Function ------//
     //--------------------------------------------//
@@ -1273,4 +1358,256 @@ void testGenome(std::string testFileDir)
         std::cerr <<"Error in readFasta. Genomes are not equivelant.\n";
     }
 */
-}
\ No newline at end of file
+}
+
+
+void testRandomStream()
+{
+    int error = 0;
+
+    //---------------------------------------------//
+    //------ philox Function (Random123 KAT) ------//
+    //---------------------------------------------//
+    uint32_t keys[3][2] = {{0x00000000u, 0x00000000u}, {0xffffffffu, 0xffffffffu}, {0xa4093822u, 0x299f31d0u}};
+    uint32_t counters[3][4] = {{0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+                               {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                               {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+    uint32_t expected[3][4] = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+                               {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+                               {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+    for (unsigned i = 0; i < 3; i++)
+    {
+        uint32_t output[4];
+        RandomStream::philox(keys[i], counters[i], output);
+        for (unsigned j = 0; j < 4; j++)
+        {
+            if (expected[i][j] != output[j])
+            {
+                std::cerr <<"Problem with RandomStream \"philox\" function.\n";
+                std::cerr <<"Known answer " << i << " differs at word " << j << "\n";
+                error = 1;
+            }
+        }
+    }
+
+    if (!error)
+    {
+        std::cout <<"RandomStream philox --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
+
+    //-------------------------------------------//
+    //------ setStream & discard Functions ------//
+    //-------------------------------------------//
+    RandomStream stream(42u, 7u, 3u);
+    RandomStream sameStream(42u, 7u, 3u);
+    RandomStream otherGene(42u, 7u, 4u);
+    for (unsigned i = 0; i < 5; i++)
+        stream();
+    sameStream.discard(5);
+    if (stream() != sameStream())
+    {
+        std::cerr <<"Error with discard. Streams with the same (seed, iteration, gene) differ.\n";
+        error = 1;
+    }
+    if (stream() == otherGene())
+    {
+        std::cerr <<"Error with setStream. Streams of different genes should differ.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"RandomStream setStream & discard --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
+
+#ifdef STANDALONE
+    //----------------------------------------//
+    //------ Parameter setSeed Function ------//
+    //----------------------------------------//
+    Parameter::setSeed(42u);
+    double mainDraw = Parameter::randUnif(0.0, 1.0);
+    Parameter::setSeed(42u);
+    if (Parameter::randUnif(0.0, 1.0) != mainDraw || RandomStream(42u).nextUnif() != mainDraw)
+    {
+        std::cerr <<"Error with setSeed. The main thread should draw from stream 0 of the seed.\n";
+        error = 1;
+    }
+
+    double threadDraws[2];
+    for (unsigned i = 0; i < 2; i++)
+    {
+        std::thread thread([&threadDraws, i]() { threadDraws[i] = Parameter::randUnif(0.0, 1.0); });
+        thread.join();
+    }
+    if (threadDraws[0] == threadDraws[1] || threadDraws[0] == mainDraw || threadDraws[1] == mainDraw)
+    {
+        std::cerr <<"Error with setSeed. Every thread should draw from its own stream.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"Parameter setSeed --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+#endif
+}
+
+
+void testTraceStatistics()
+{
+    int error = 0;
+    std::vector<double> trace;
+    TraceStatistics statistics(10u);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        double x = -100000.0 + std::sin(0.1 * i) + 0.001 * i;
+        trace.push_back(x);
+        statistics.add(x);
+    }
+    unsigned n = (unsigned)trace.size();
+
+    //-----------------------------------------------//
+    //------ getWindowMean & getWindowVariance ------//
+    //-----------------------------------------------//
+    double mean = 0.0;
+    for (unsigned i = 100; i < 600; i++)
+        mean += trace[i];
+    mean /= 500.0;
+    double variance = 0.0;
+    for (unsigned i = 100; i < 600; i++)
+        variance += (trace[i] - mean) * (trace[i] - mean);
+    variance /= 500.0;
+    if (std::abs(statistics.getWindowMean(100, 600) - mean) > 1e-8 ||
+        std::abs(statistics.getWindowVariance(100, 600) - variance) > 1e-8)
+    {
+        std::cerr <<"Error with window statistics. Mean or variance of [100, 600) differs from the direct computation.\n";
+        error = 1;
+    }
+    if (std::abs(statistics.getWindowMean(0, n) - statistics.getMean()) > 1e-8)
+    {
+        std::cerr <<"Error with getMean. Running mean differs from the window mean of the whole trace.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"TraceStatistics getWindowMean & getWindowVariance --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
+
+    //----------------------------------------//
+    //------ getAutocovariance Function ------//
+    //----------------------------------------//
+    mean = statistics.getMean();
+    for (unsigned lag = 0; lag <= 10; lag++)
+    {
+        double autocovariance = 0.0;
+        for (unsigned i = lag; i < n; i++)
+            autocovariance += (trace[i] - mean) * (trace[i - lag] - mean);
+        autocovariance /= n;
+        if (std::abs(statistics.getAutocovariance(lag) - autocovariance) > 1e-8)
+        {
+            std::cerr <<"Error with getAutocovariance. Lag " << lag << " differs from the direct computation.\n";
+            error = 1;
+        }
+    }
+    if (!std::isnan(statistics.getAutocovariance(11)))
+    {
+        std::cerr <<"Error with getAutocovariance. Lags above the maximum lag should be NaN.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"TraceStatistics getAutocovariance --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+
+
+
+    //--------------------------------------------//
+    //------ getBatchMeansVariance Function ------//
+    //--------------------------------------------//
+    // 1000 samples end in 62 batches of 16 samples, the last 8 samples are in the open batch
+    std::vector<double> batchMeans(62, 0.0);
+    for (unsigned i = 0; i < 62 * 16; i++)
+        batchMeans[i / 16] += (trace[i] - trace[0]) / 16.0;
+    double batchMean = 0.0;
+    for (unsigned i = 0; i < 62; i++)
+        batchMean += batchMeans[i] / 62.0;
+    variance = 0.0;
+    for (unsigned i = 0; i < 62; i++)
+        variance += (batchMeans[i] - batchMean) * (batchMeans[i] - batchMean);
+    variance /= 61.0 * 62.0;
+    if (std::abs(statistics.getBatchMeansVariance() - variance) > 1e-10)
+    {
+        std::cerr <<"Error with getBatchMeansVariance. Variance of the batch means differs from the direct computation.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"TraceStatistics getBatchMeansVariance --- Pass\n";
+    }
+    else
+    {
+        error = 0; //Reset for next function.
+    }
+}
+
+
+void testTraceStorage(std::string testFileDir)
+{
+    int error = 0;
+    std::string file = testFileDir + "/" + "traceStorageTest.bin";
+
+    //-----------------------------------------------//
+    //------ Copies of a mapped TraceStorage ------//
+    //-----------------------------------------------//
+    TraceStorage storage;
+    storage.initialize(2u, 100u, file);
+    storage.set(1u, 50u, 50000.0);
+    TraceStorage copy = storage;
+
+    storage.initialize(2u, 100u, file); // same size
+    if (copy.get(1u, 50u) != 50000.0 || storage.get(1u, 50u) != 0.0)
+    {
+        std::cerr <<"Error with initialize. A copy lost its values when the original was initialized again.\n";
+        error = 1;
+    }
+    storage.initialize(1u, 10u, file); // smaller file
+    if (copy.get(1u, 50u) != 50000.0 || copy.getColumn(1u).size() != 100u)
+    {
+        std::cerr <<"Error with initialize. A copy lost its values when the original was initialized smaller.\n";
+        error = 1;
+    }
+
+    if (!error)
+    {
+        std::cout <<"TraceStorage copy & initialize --- Pass\n";
+    }
+}
@@ -1,6 +1,11 @@
 #include "include/base/Trace.h"
 #include "include/SequenceSummary.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
 
 #ifndef STANDALONE
 #include <Rcpp.h>
@@ -19,6 +24,14 @@ Trace::Trace()
 	categories = 0;
 	numCodonSpecificParamTypes = 2;
 	codonSpecificParameterTrace.resize(numCodonSpecificParamTypes);
+	codonSpecificParameterStatistics.resize(numCodonSpecificParamTypes);
+	codonSpecificParameterColumn.resize(numCodonSpecificParamTypes, 0u);
+	traceWriterChunkSize = 100u;
+	synthesisRatePrecision = TraceStorage::doublePrecision;
+	stdDevSynthesisRatePrecision = TraceStorage::doublePrecision;
+	mixtureProbabilitiesPrecision = TraceStorage::doublePrecision;
+	posteriorWindow = 0u;
+	posteriorFirstSample = 0u;
 	// TODO: fill this
 }
 
@@ -32,6 +45,14 @@ Trace::Trace(unsigned _numCodonSpecificParamTypes)
 	categories = 0;
 	numCodonSpecificParamTypes = _numCodonSpecificParamTypes;
 	codonSpecificParameterTrace.resize(numCodonSpecificParamTypes);
+	codonSpecificParameterStatistics.resize(numCodonSpecificParamTypes);
+	codonSpecificParameterColumn.resize(numCodonSpecificParamTypes, 0u);
+	traceWriterChunkSize = 100u;
+	synthesisRatePrecision = TraceStorage::doublePrecision;
+	stdDevSynthesisRatePrecision = TraceStorage::doublePrecision;
+	mixtureProbabilitiesPrecision = TraceStorage::doublePrecision;
+	posteriorWindow = 0u;
+	posteriorFirstSample = 0u;
 }
 
 
@@ -49,12 +70,15 @@ void Trace::initializeSharedTraces(unsigned samples, unsigned num_genes, unsigne
 	std::cout << "maxGrouping: " << maxGrouping << "\n";
 #endif
 	//numSelectionCategories always == numSynthesisRateCategories, so only one is passed in for convience
-	
+
+	if (traceWriterFile.empty()) writer.reset();
+	else writer.reset(new TraceWriter(traceWriterFile, traceWriterChunkSize));
+	posteriorFirstSample = (samples > posteriorWindow) ? samples - posteriorWindow : 0u;
 	initStdDevSynthesisRateTrace(numSelectionCategories, samples);
 	initSynthesisRateAcceptanceRatioTrace(num_genes, numSelectionCategories);
 	codonSpecificAcceptanceRatioTrace.resize(maxGrouping);
 	initSynthesisRateTrace(samples, num_genes, numSelectionCategories);
-	initMixtureAssignmentTrace(samples, num_genes);
+	initMixtureAssignmentTrace(samples, num_genes, numMixtures);
 	initMixtureProbabilitesTrace(samples, numMixtures);
 
 	categories = &_categories;
@@ -63,12 +87,9 @@ void Trace::initializeSharedTraces(unsigned samples, unsigned num_genes, unsigne
 
 void Trace::initStdDevSynthesisRateTrace(unsigned numSelectionCategories, unsigned samples)
 {
-	stdDevSynthesisRateTrace.resize(numSelectionCategories);
-	for (unsigned i = 0u; i < numSelectionCategories; i++)
-	{
-		std::vector<double> temp(samples, 0.0);
-		stdDevSynthesisRateTrace[i] = temp;
-	}
+	stdDevSynthesisRateTrace.initialize(numSelectionCategories, samples, "", stdDevSynthesisRatePrecision);
+	stdDevSynthesisRateStatistics.assign(numSelectionCategories, TraceStatistics(0u, false));
+	if (writer) stdDevSynthesisRateColumn = addWriterColumns("stdDevSynthesisRate", numSelectionCategories);
 }
 
 
@@ -88,33 +109,35 @@ void Trace::initSynthesisRateTrace(unsigned samples, unsigned num_genes, unsigne
 	synthesisRateTrace.resize(numSynthesisRateCategories);
 	for (unsigned category = 0; category < numSynthesisRateCategories; category++)
 	{
-		synthesisRateTrace[category].resize(num_genes);
-		for (unsigned i = 0; i < num_genes; i++)
+		synthesisRateTrace[category].initialize(num_genes, samples, getSynthesisRateTraceFileName(category),
+			synthesisRatePrecision);
+		std::ostringstream oss;
+		oss << "synthesisRate." << category;
+		if (writer)
 		{
-			synthesisRateTrace[category][i].resize(samples);
-			std::vector<double> tempExpr(samples, 0.0);
-			synthesisRateTrace[category][i] = tempExpr;
+			unsigned column = addWriterColumns(oss.str(), num_genes);
+			if (category == 0u) synthesisRateColumn = column;
 		}
 	}
+	synthesisRateStatistics.assign(numSynthesisRateCategories, std::vector<TraceStatistics>(num_genes, TraceStatistics(0u, false)));
+	unsigned numAccumulators = (posteriorWindow > 0u) ? num_genes : 0u;
+	synthesisRateAccumulators.assign(numSynthesisRateCategories, std::vector<PosteriorAccumulator>(numAccumulators));
+	assignedSynthesisRateAccumulators.assign(numSynthesisRateCategories, std::vector<PosteriorAccumulator>(numAccumulators));
 }
 
-void Trace::initMixtureAssignmentTrace(unsigned samples, unsigned num_genes)
+void Trace::initMixtureAssignmentTrace(unsigned samples, unsigned num_genes, unsigned numMixtures)
 {
-	mixtureAssignmentTrace.resize(num_genes);
-	for (unsigned i = 0u; i < num_genes; i++)
-	{
-		mixtureAssignmentTrace[i].resize(samples);
-	}
+	mixtureAssignmentTrace.initialize(num_genes, samples, numMixtures);
+	mixtureAssignmentCounts.assign((posteriorWindow > 0u) ? num_genes : 0u, std::vector<unsigned>(numMixtures, 0u));
+	if (writer) mixtureAssignmentColumn = addWriterColumns("mixtureAssignment", num_genes);
 }
 
 
 void Trace::initMixtureProbabilitesTrace(unsigned samples, unsigned numMixtures)
 {
-	mixtureProbabilitiesTrace.resize(numMixtures);
-	for (unsigned i = 0u; i < numMixtures; i++)
-	{
-		mixtureProbabilitiesTrace[i].resize(samples, 0.0);
-	}
+	mixtureProbabilitiesTrace.initialize(numMixtures, samples, "", mixtureProbabilitiesPrecision);
+	mixtureProbabilitiesStatistics.assign(numMixtures, TraceStatistics(0u, false));
+	if (writer) mixtureProbabilitiesColumn = addWriterColumns("mixtureProbability", numMixtures);
 }
 
 
@@ -137,6 +160,25 @@ void Trace::initCodonSpecificParameterTrace(unsigned samples, unsigned numCatego
 
 	//TODO: R output for error message here
 	codonSpecificParameterTrace[paramType] = tmp;
+	// the codon specific parameters are few, so they keep the window statistics for the Geweke scores of checkConvergence
+	codonSpecificParameterStatistics[paramType].assign(numCategories, std::vector<TraceStatistics>(numParam, TraceStatistics(0u, true)));
+	for (unsigned category = 0; category < numCategories; category++)
+	{
+		for (unsigned i = 0; i < numParam; i++)
+		{
+			codonSpecificParameterStatistics[paramType][category][i].reserve(samples);
+		}
+	}
+	codonSpecificParameterAccumulators.resize(numCodonSpecificParamTypes);
+	codonSpecificParameterAccumulators[paramType].assign(numCategories,
+		std::vector<PosteriorAccumulator>((posteriorWindow > 0u) ? numParam : 0u));
+	for (unsigned category = 0; writer && category < numCategories; category++)
+	{
+		std::ostringstream oss;
+		oss << "codonSpecificParameter." << paramType << "." << category;
+		unsigned column = addWriterColumns(oss.str(), numParam);
+		if (category == 0u) codonSpecificParameterColumn[paramType] = column;
+	}
 	/*
 	switch (paramType) {
 	case 0:
@@ -168,6 +210,8 @@ void Trace::initSynthesisOffsetTrace(unsigned samples, unsigned numPhiGroupings)
 	}
 
 	synthesisOffsetAcceptanceRatioTrace.resize(numPhiGroupings);
+	synthesisOffsetStatistics.assign(numPhiGroupings, TraceStatistics(0u, false));
+	if (writer) synthesisOffsetColumn = addWriterColumns("synthesisOffset", numPhiGroupings);
 }
 
 
@@ -177,6 +221,8 @@ void Trace::initObservedSynthesisNoiseTrace(unsigned samples, unsigned numPhiGro
 	for (unsigned i = 0; i < numPhiGroupings; i++) {
 		observedSynthesisNoiseTrace[i].resize(samples);
 	}
+	observedSynthesisNoiseStatistics.assign(numPhiGroupings, TraceStatistics(0u, false));
+	if (writer) observedSynthesisNoiseColumn = addWriterColumns("observedSynthesisNoise", numPhiGroupings);
 }
 
 
@@ -184,6 +230,33 @@ void Trace::initObservedSynthesisNoiseTrace(unsigned samples, unsigned numPhiGro
 
 
 
+std::string Trace::getSynthesisRateTraceFileName(unsigned category)
+{
+	if (mappedTraceFilePrefix.empty()) return "";
+	std::ostringstream oss;
+	oss << mappedTraceFilePrefix << "synthesisRateTrace_" << category << ".bin";
+	return oss.str();
+}
+
+
+// Adds the writer columns <prefix>.0 ... <prefix>.<count - 1> and returns the first.
+unsigned Trace::addWriterColumns(std::string prefix, unsigned count)
+{
+	unsigned first = 0u;
+	for (unsigned i = 0u; i < count; i++)
+	{
+		std::ostringstream oss;
+		oss << prefix << "." << i;
+		unsigned column = writer->addColumn(oss.str());
+		if (i == 0u) first = column;
+	}
+	return first;
+}
+
+
+
+
+
 //----------------------------------------------------//
 //---------- Model Initialization Functions ----------//
 //----------------------------------------------------//
@@ -237,27 +310,132 @@ void Trace::initializePANSETrace(unsigned samples, unsigned num_genes, unsigned
 	initCodonSpecificParameterTrace(samples, numLambdaPrimeCategories, numParam, 1u);
 }
 
+
+// Keeps the synthesis rate traces, by far the largest traces, in memory mapped files
+// <prefix>synthesisRateTrace_<category>.bin instead of memory, see TraceStorage. Takes effect when the traces are
+// initialized, at the start of the next run.
+void Trace::setMappedTraceFilePrefix(std::string prefix)
+{
+	mappedTraceFilePrefix = prefix;
+}
+
+
+std::string Trace::getMappedTraceFilePrefix()
+{
+	return mappedTraceFilePrefix;
+}
+
+
+// Sets how the samples of a trace family are stored: "double", "float" or "logQuantized" (16 bit log values, see
+// TraceStorage). The families are "synthesisRate", "stdDevSynthesisRate" and "mixtureProbabilities". Values are
+// converted when they are added to the trace and expanded by the getters, the streaming statistics and the trace
+// writer still see the full precision. Takes effect when the traces are initialized.
+void Trace::setTracePrecision(std::string family, std::string precision)
+{
+	unsigned value;
+	if (precision == "double") value = TraceStorage::doublePrecision;
+	else if (precision == "float") value = TraceStorage::singlePrecision;
+	else if (precision == "logQuantized") value = TraceStorage::logQuantized;
+	else
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in Trace::setTracePrecision: Unknown precision %s, use double, float or logQuantized.\n",
+			precision.c_str());
+#else
+		std::cerr << "Warning in Trace::setTracePrecision: Unknown precision " << precision
+			<< ", use double, float or logQuantized.\n";
+#endif
+		return;
+	}
+
+	if (family == "synthesisRate") synthesisRatePrecision = value;
+	else if (family == "stdDevSynthesisRate") stdDevSynthesisRatePrecision = value;
+	else if (family == "mixtureProbabilities") mixtureProbabilitiesPrecision = value;
+	else
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in Trace::setTracePrecision: Unknown trace family %s.\n", family.c_str());
+#else
+		std::cerr << "Warning in Trace::setTracePrecision: Unknown trace family " << family << ".\n";
+#endif
+	}
+}
+
+
+std::string Trace::getTracePrecision(std::string family)
+{
+	unsigned value = TraceStorage::doublePrecision;
+	if (family == "synthesisRate") value = synthesisRatePrecision;
+	else if (family == "stdDevSynthesisRate") value = stdDevSynthesisRatePrecision;
+	else if (family == "mixtureProbabilities") value = mixtureProbabilitiesPrecision;
+
+	if (value == TraceStorage::singlePrecision) return "float";
+	if (value == TraceStorage::logQuantized) return "logQuantized";
+	return "double";
+}
+
+
+// Accumulates the posterior means and variances of the synthesis rates and codon specific parameters over the last
+// samples of the trace, e.g. the samples after burn in, while sampling. Posterior means and variances and mixture
+// assignment probabilities over exactly that window are then answered without reading the traces. Takes effect when
+// the traces are initialized, 0 turns the accumulators off.
+void Trace::setPosteriorWindow(unsigned samples)
+{
+	posteriorWindow = samples;
+}
+
+
+// Streams every trace to filename while sampling, in blocks of chunkSize samples per parameter (see TraceWriter), so
+// the samples are on disk during the run. Takes effect when the traces are initialized, an empty filename stops
+// writing. The columns are named after the traces with 0 based indices: stdDevSynthesisRate.<category>,
+// synthesisRate.<category>.<gene>, mixtureAssignment.<gene>, mixtureProbability.<mixture>,
+// codonSpecificParameter.<paramType>.<category>.<codon index>, synthesisOffset.<index>, observedSynthesisNoise.<index>.
+void Trace::setTraceWriterSettings(std::string filename, unsigned chunkSize)
+{
+	traceWriterFile = filename;
+	traceWriterChunkSize = chunkSize;
+}
+
+
+std::string Trace::getTraceWriterFile()
+{
+	return traceWriterFile;
+}
+
+
+unsigned Trace::getTraceWriterChunkSize()
+{
+	return traceWriterChunkSize;
+}
+
+
+// Writes the samples still buffered by the trace writer, called at the end of a run.
+void Trace::flushTraceWriter()
+{
+	if (writer) writer->flush();
+}
+
 //--------------------------------------//
 // --------- Getter Functions --------- //
 //--------------------------------------//
 std::vector<double> Trace::getStdDevSynthesisRateTrace(unsigned selectionCategory) 
 { 
-	return stdDevSynthesisRateTrace[selectionCategory]; 
+	return stdDevSynthesisRateTrace.getColumn(selectionCategory);
 }
 
 
 std::vector<double> Trace::getExpectedSynthesisRateTrace()
 {
-	unsigned numGenes = synthesisRateTrace[0].size(); //number of genes
-	unsigned samples = synthesisRateTrace[0][0].size(); //number of samples
+	unsigned numGenes = synthesisRateTrace[0].getNumColumns(); //number of genes
+	unsigned samples = synthesisRateTrace[0].getNumSamples(); //number of samples
 	std::vector<double> RV(samples, 0.0);
 	for (unsigned sample = 0; sample < samples; sample++)
 	{
 		for (unsigned geneIndex = 0; geneIndex < numGenes; geneIndex++)
 		{
-			unsigned mixtureElement = mixtureAssignmentTrace[geneIndex][sample];
+			unsigned mixtureElement = mixtureAssignmentTrace.get(geneIndex, sample);
 			unsigned category = getSynthesisRateCategory(mixtureElement);
-			RV[sample] += synthesisRateTrace[category][geneIndex][sample];
+			RV[sample] += synthesisRateTrace[category].get(geneIndex, sample);
 		}
 		RV[sample] /= numGenes;
 	}
@@ -273,7 +451,12 @@ std::vector<double> Trace::getStdDevSynthesisRateAcceptanceRatioTrace()
 
 std::vector<std::vector<std::vector<double>>> Trace::getSynthesisRateTrace()
 {
-	return synthesisRateTrace;
+	std::vector<std::vector<std::vector<double>>> RV(synthesisRateTrace.size());
+	for (unsigned category = 0; category < synthesisRateTrace.size(); category++)
+	{
+		RV[category] = synthesisRateTrace[category].getColumns();
+	}
+	return RV;
 }
 
 
@@ -300,14 +483,14 @@ std::vector<double> Trace::getCodonSpecficAcceptanceRatioTraceForAA(std::string
 
 std::vector<double> Trace::getSynthesisRateTraceForGene(unsigned geneIndex)
 {
-	unsigned traceLength = synthesisRateTrace[0][0].size();
+	unsigned traceLength = synthesisRateTrace[0].getNumSamples();
 
 	std::vector<double> returnVector(traceLength, 0.0);
 	for (unsigned i = 0u; i < traceLength; i++)
 	{
-		unsigned mixtureElement = mixtureAssignmentTrace[geneIndex][i];
+		unsigned mixtureElement = mixtureAssignmentTrace.get(geneIndex, i);
 		unsigned category = getSynthesisRateCategory(mixtureElement);
-		returnVector[i] = synthesisRateTrace[category][geneIndex][i];
+		returnVector[i] = synthesisRateTrace[category].get(geneIndex, i);
 	}
 	return returnVector;
 }
@@ -316,27 +499,45 @@ std::vector<double> Trace::getSynthesisRateTraceForGene(unsigned geneIndex)
 std::vector<double> Trace::getSynthesisRateTraceByMixtureElementForGene(unsigned mixtureElement, unsigned geneIndex)
 {
 	unsigned category = getSynthesisRateCategory(mixtureElement);
-	return synthesisRateTrace[category][geneIndex];
+	return synthesisRateTrace[category].getColumn(geneIndex);
 }
 
 
 std::vector<unsigned> Trace::getMixtureAssignmentTraceForGene(unsigned geneIndex)
 {
-	return mixtureAssignmentTrace[geneIndex];
+	return mixtureAssignmentTrace.getColumn(geneIndex);
 }
 std::vector<double> Trace::getMixtureProbabilitiesTraceForMixture(unsigned mixtureIndex)
 {
-	return mixtureProbabilitiesTrace[mixtureIndex];
+	return mixtureProbabilitiesTrace.getColumn(mixtureIndex);
 }
 
 std::vector<std::vector<unsigned>> Trace::getMixtureAssignmentTrace()
 {
-	return mixtureAssignmentTrace;
+	return mixtureAssignmentTrace.getColumns();
+}
+
+
+// Number of samples in [firstSample, lastSample) the gene is assigned to each mixture. The posterior window (see
+// setPosteriorWindow) and the whole trace are answered in O(numMixtures), other ranges count the shorter of the range
+// and the samples outside of it.
+std::vector<unsigned> Trace::getMixtureAssignmentCounts(unsigned geneIndex, unsigned firstSample, unsigned lastSample)
+{
+	if (firstSample == posteriorFirstSample && geneIndex < mixtureAssignmentCounts.size())
+	{
+		unsigned numSamples = 0u;
+		for (unsigned i = 0u; i < mixtureAssignmentCounts[geneIndex].size(); i++)
+		{
+			numSamples += mixtureAssignmentCounts[geneIndex][i];
+		}
+		if (numSamples == lastSample - firstSample) return mixtureAssignmentCounts[geneIndex];
+	}
+	return mixtureAssignmentTrace.getCounts(geneIndex, firstSample, lastSample);
 }
 
 std::vector<std::vector<double>> Trace::getMixtureProbabilitiesTrace()
 {
-	return mixtureProbabilitiesTrace;
+	return mixtureProbabilitiesTrace.getColumns();
 }
 std::vector<std::vector<double>> Trace::getCodonSpecificAcceptanceRatioTrace()
 {
@@ -443,6 +644,193 @@ unsigned Trace::getCodonSpecificCategory(unsigned mixtureElement, unsigned param
 	return rv;
 }
 
+//------------------------------------------//
+//---------- Statistics Functions ----------//
+//------------------------------------------//
+
+
+// Effective sample sizes and Monte Carlo standard errors by batch means, updated with every sample. They are NaN for
+// parameters without samples or that did not move.
+double Trace::getStdDevSynthesisRateEffectiveSampleSize(unsigned selectionCategory)
+{
+	return stdDevSynthesisRateStatistics[selectionCategory].getEffectiveSampleSize();
+}
+
+
+double Trace::getStdDevSynthesisRateMonteCarloStandardError(unsigned selectionCategory)
+{
+	return stdDevSynthesisRateStatistics[selectionCategory].getMonteCarloStandardError();
+}
+
+
+double Trace::getSynthesisRateEffectiveSampleSize(unsigned mixtureElement, unsigned geneIndex)
+{
+	unsigned category = getSynthesisRateCategory(mixtureElement);
+	return synthesisRateStatistics[category][geneIndex].getEffectiveSampleSize();
+}
+
+
+double Trace::getSynthesisRateMonteCarloStandardError(unsigned mixtureElement, unsigned geneIndex)
+{
+	unsigned category = getSynthesisRateCategory(mixtureElement);
+	return synthesisRateStatistics[category][geneIndex].getMonteCarloStandardError();
+}
+
+
+double Trace::getMixtureProbabilitiesEffectiveSampleSize(unsigned mixtureIndex)
+{
+	return mixtureProbabilitiesStatistics[mixtureIndex].getEffectiveSampleSize();
+}
+
+
+double Trace::getMixtureProbabilitiesMonteCarloStandardError(unsigned mixtureIndex)
+{
+	return mixtureProbabilitiesStatistics[mixtureIndex].getMonteCarloStandardError();
+}
+
+
+double Trace::getCodonSpecificParameterEffectiveSampleSize(unsigned mixtureElement, std::string& codon, unsigned paramType,
+	bool withoutReference)
+{
+	unsigned codonIndex = SequenceSummary::codonToIndex(codon, withoutReference);
+	unsigned category = getCodonSpecificCategory(mixtureElement, paramType);
+	return codonSpecificParameterStatistics[paramType][category][codonIndex].getEffectiveSampleSize();
+}
+
+
+double Trace::getCodonSpecificParameterMonteCarloStandardError(unsigned mixtureElement, std::string& codon, unsigned paramType,
+	bool withoutReference)
+{
+	unsigned codonIndex = SequenceSummary::codonToIndex(codon, withoutReference);
+	unsigned category = getCodonSpecificCategory(mixtureElement, paramType);
+	return codonSpecificParameterStatistics[paramType][category][codonIndex].getMonteCarloStandardError();
+}
+
+
+// Smallest effective sample size of all traced parameters, e.g. to stop a run once every parameter is sampled well
+// enough. Parameters without an effective sample size (see above) are skipped, NaN if there is none.
+double Trace::getMinimumEffectiveSampleSize()
+{
+	double minimum = std::numeric_limits<double>::quiet_NaN();
+	std::vector<std::vector<TraceStatistics>*> statistics;
+	statistics.push_back(&stdDevSynthesisRateStatistics);
+	statistics.push_back(&mixtureProbabilitiesStatistics);
+	statistics.push_back(&synthesisOffsetStatistics);
+	statistics.push_back(&observedSynthesisNoiseStatistics);
+	for (unsigned category = 0u; category < synthesisRateStatistics.size(); category++)
+	{
+		statistics.push_back(&synthesisRateStatistics[category]);
+	}
+	for (unsigned paramType = 0u; paramType < codonSpecificParameterStatistics.size(); paramType++)
+	{
+		for (unsigned category = 0u; category < codonSpecificParameterStatistics[paramType].size(); category++)
+		{
+			statistics.push_back(&codonSpecificParameterStatistics[paramType][category]);
+		}
+	}
+
+	for (unsigned i = 0u; i < statistics.size(); i++)
+	{
+		for (unsigned j = 0u; j < statistics[i]->size(); j++)
+		{
+			double effectiveSampleSize = (*statistics[i])[j].getEffectiveSampleSize();
+			if (effectiveSampleSize < minimum || (std::isnan(minimum) && !std::isnan(effectiveSampleSize)))
+			{
+				minimum = effectiveSampleSize;
+			}
+		}
+	}
+	return minimum;
+}
+
+
+// Largest absolute Geweke score of the codon specific parameters over the samples [start, end) after the initial
+// values, from the window statistics. Parameters that are not sampled (e.g. reference codons) are skipped and
+// numTraces is set to the number of scores. NaN if a score can not be computed yet.
+double Trace::getMaximumCodonSpecificParameterGewekeScore(unsigned start, unsigned end, unsigned &numTraces)
+{
+	double maximumScore = 0.0;
+	numTraces = 0u;
+	for (unsigned paramType = 0u; paramType < codonSpecificParameterStatistics.size(); paramType++)
+	{
+		for (unsigned category = 0u; category < codonSpecificParameterStatistics[paramType].size(); category++)
+		{
+			for (unsigned i = 0u; i < codonSpecificParameterStatistics[paramType][category].size(); i++)
+			{
+				TraceStatistics &statistics = codonSpecificParameterStatistics[paramType][category][i];
+				if (statistics.getNumSamples() == 0u) continue;
+				double score = statistics.getGewekeScore(start, end);
+				if (std::isnan(score)) return score;
+				maximumScore = std::max(maximumScore, std::abs(score));
+				numTraces++;
+			}
+		}
+	}
+	return maximumScore;
+}
+
+
+// Copies the accumulators of the synthesis rate of the gene in the category of the mixture element: all samples and
+// the samples the gene was assigned to that category. False if they do not cover exactly [firstSample, lastSample).
+bool Trace::getSynthesisRateAccumulators(unsigned mixtureElement, unsigned geneIndex, unsigned firstSample,
+	unsigned lastSample, PosteriorAccumulator &all, PosteriorAccumulator &assigned)
+{
+	unsigned category = getSynthesisRateCategory(mixtureElement);
+	if (firstSample != posteriorFirstSample || category >= synthesisRateAccumulators.size()
+		|| geneIndex >= synthesisRateAccumulators[category].size()) return false;
+
+	all = synthesisRateAccumulators[category][geneIndex];
+	assigned = assignedSynthesisRateAccumulators[category][geneIndex];
+	return all.getNumSamples() == lastSample - firstSample;
+}
+
+
+// Copies the accumulator of the codon specific parameter, false if it does not cover exactly
+// [firstSample, lastSample).
+bool Trace::getCodonSpecificParameterAccumulator(unsigned mixtureElement, std::string& codon, unsigned paramType,
+	bool withoutReference, unsigned firstSample, unsigned lastSample, PosteriorAccumulator &accumulator)
+{
+	unsigned codonIndex = SequenceSummary::codonToIndex(codon, withoutReference);
+	unsigned category = getCodonSpecificCategory(mixtureElement, paramType);
+	if (firstSample != posteriorFirstSample || paramType >= codonSpecificParameterAccumulators.size()
+		|| category >= codonSpecificParameterAccumulators[paramType].size()
+		|| codonIndex >= codonSpecificParameterAccumulators[paramType][category].size()) return false;
+
+	accumulator = codonSpecificParameterAccumulators[paramType][category][codonIndex];
+	return accumulator.getNumSamples() == lastSample - firstSample;
+}
+
+
+//----------------------------------//
+//---------- ROC Specific ----------//
+//----------------------------------//
+
+
+double Trace::getSynthesisOffsetEffectiveSampleSize(unsigned index)
+{
+	return synthesisOffsetStatistics[index].getEffectiveSampleSize();
+}
+
+
+double Trace::getSynthesisOffsetMonteCarloStandardError(unsigned index)
+{
+	return synthesisOffsetStatistics[index].getMonteCarloStandardError();
+}
+
+
+double Trace::getObservedSynthesisNoiseEffectiveSampleSize(unsigned index)
+{
+	return observedSynthesisNoiseStatistics[index].getEffectiveSampleSize();
+}
+
+
+double Trace::getObservedSynthesisNoiseMonteCarloStandardError(unsigned index)
+{
+	return observedSynthesisNoiseStatistics[index].getMonteCarloStandardError();
+}
+
+
+
 //--------------------------------------//
 //---------- Update Functions ----------//
 //--------------------------------------//
@@ -450,7 +838,9 @@ unsigned Trace::getCodonSpecificCategory(unsigned mixtureElement, unsigned param
 
 void Trace::updateStdDevSynthesisRateTrace(unsigned sample, double stdDevSynthesisRate, unsigned synthesisRateCategory)
 {
-	stdDevSynthesisRateTrace[synthesisRateCategory][sample] = stdDevSynthesisRate;
+	stdDevSynthesisRateTrace.set(synthesisRateCategory, sample, stdDevSynthesisRate);
+	if (sample > 0u) stdDevSynthesisRateStatistics[synthesisRateCategory].add(stdDevSynthesisRate);
+	if (writer) writer->add(stdDevSynthesisRateColumn + synthesisRateCategory, sample, stdDevSynthesisRate);
 }
 
 
@@ -472,26 +862,41 @@ void Trace::updateCodonSpecificAcceptanceRatioTrace(unsigned codonIndex, double
 }
 
 
-void Trace::updateSynthesisRateTrace(unsigned sample, unsigned geneIndex, std::vector<std::vector <double>> &currentSynthesisRateLevel)
+void Trace::updateSynthesisRateTrace(unsigned sample, unsigned geneIndex, std::vector<SynthesisRateBlock> &currentSynthesisRateLevel)
 {
 	for (unsigned category = 0; category < synthesisRateTrace.size(); category++)
 	{
-		synthesisRateTrace[category][geneIndex][sample] = currentSynthesisRateLevel[category][geneIndex];
+		double synthesisRate = currentSynthesisRateLevel[category].getSynthesisRates()[geneIndex];
+		synthesisRateTrace[category].set(geneIndex, sample, synthesisRate);
+		if (sample > 0u) synthesisRateStatistics[category][geneIndex].add(synthesisRate);
+		if (posteriorWindow > 0u && sample >= posteriorFirstSample)
+			synthesisRateAccumulators[category][geneIndex].add(synthesisRateTrace[category].get(geneIndex, sample));
+		if (writer) writer->add(synthesisRateColumn + category * synthesisRateTrace[category].getNumColumns() + geneIndex, sample, synthesisRate);
 	}
 }
 
 
+// Has to follow updateSynthesisRateTrace of the same sample, whose value in the assigned category is accumulated.
 void Trace::updateMixtureAssignmentTrace(unsigned sample, unsigned geneIndex, unsigned value)
 {
-	mixtureAssignmentTrace[geneIndex][sample] = value;
+	mixtureAssignmentTrace.set(geneIndex, sample, value);
+	if (posteriorWindow > 0u && sample >= posteriorFirstSample)
+	{
+		mixtureAssignmentCounts[geneIndex][value]++;
+		unsigned category = getSynthesisRateCategory(value);
+		assignedSynthesisRateAccumulators[category][geneIndex].add(synthesisRateTrace[category].get(geneIndex, sample));
+	}
+	if (writer) writer->add(mixtureAssignmentColumn + geneIndex, sample, value);
 }
 
 
 void Trace::updateMixtureProbabilitiesTrace(unsigned samples, std::vector<double> &categoryProbabilities)
 {
-	for (unsigned category = 0; category < mixtureProbabilitiesTrace.size(); category++)
+	for (unsigned category = 0; category < mixtureProbabilitiesTrace.getNumColumns(); category++)
 	{
-		mixtureProbabilitiesTrace[category][samples] = categoryProbabilities[category];
+		mixtureProbabilitiesTrace.set(category, samples, categoryProbabilities[category]);
+		if (samples > 0u) mixtureProbabilitiesStatistics[category].add(categoryProbabilities[category]);
+		if (writer) writer->add(mixtureProbabilitiesColumn + category, samples, categoryProbabilities[category]);
 	}
 }
 
@@ -501,7 +906,7 @@ void Trace::updateMixtureProbabilitiesTrace(unsigned samples, std::vector<double
 //----------------------------------//
 
 
-void Trace::updateCodonSpecificParameterTraceForAA(unsigned sample, std::string aa, std::vector<std::vector<double>> &curParam, unsigned paramType)
+void Trace::updateCodonSpecificParameterTraceForAA(unsigned sample, std::string aa, CodonSpecificParameterSet::ParameterTypeView curParam, unsigned paramType)
 {
 	unsigned aaStart;
 	unsigned aaEnd;
@@ -511,6 +916,11 @@ void Trace::updateCodonSpecificParameterTraceForAA(unsigned sample, std::string
 		for (unsigned i = aaStart; i < aaEnd; i++)
 		{
 			codonSpecificParameterTrace[paramType][category][i][sample] = curParam[category][i];
+			if (sample > 0u) codonSpecificParameterStatistics[paramType][category][i].add(curParam[category][i]);
+			if (posteriorWindow > 0u && sample >= posteriorFirstSample)
+				codonSpecificParameterAccumulators[paramType][category][i].add(curParam[category][i]);
+			if (writer) writer->add(codonSpecificParameterColumn[paramType] + category * codonSpecificParameterTrace[paramType][category].size() + i,
+				sample, curParam[category][i]);
 		}
 	}
 	/*
@@ -544,6 +954,8 @@ void Trace::updateCodonSpecificParameterTraceForAA(unsigned sample, std::string
 void Trace::updateSynthesisOffsetTrace(unsigned index, unsigned sample, double value)
 {
 	synthesisOffsetTrace[index][sample] = value;
+	if (sample > 0u) synthesisOffsetStatistics[index].add(value);
+	if (writer) writer->add(synthesisOffsetColumn + index, sample, value);
 }
 
 
@@ -556,6 +968,8 @@ void Trace::updateSynthesisOffsetAcceptanceRatioTrace(unsigned index, double val
 void Trace::updateObservedSynthesisNoiseTrace(unsigned index, unsigned sample, double value)
 {
 	observedSynthesisNoiseTrace[index][sample] = value;
+	if (sample > 0u) observedSynthesisNoiseStatistics[index].add(value);
+	if (writer) writer->add(observedSynthesisNoiseColumn + index, sample, value);
 }
 
 
@@ -565,12 +979,17 @@ void Trace::updateObservedSynthesisNoiseTrace(unsigned index, unsigned sample, d
 
 
 void Trace::updateCodonSpecificParameterTraceForCodon(unsigned sample, std::string codon,
-				std::vector<std::vector<double>> &curParam, unsigned paramType)
+				CodonSpecificParameterSet::ParameterTypeView curParam, unsigned paramType)
 {
 	unsigned i = SequenceSummary::codonToIndex(codon);
 	for (unsigned category = 0; category < codonSpecificParameterTrace[paramType].size(); category++)
 	{
 		codonSpecificParameterTrace[paramType][category][i][sample] = curParam[category][i];
+		if (sample > 0u) codonSpecificParameterStatistics[paramType][category][i].add(curParam[category][i]);
+		if (posteriorWindow > 0u && sample >= posteriorFirstSample)
+			codonSpecificParameterAccumulators[paramType][category][i].add(curParam[category][i]);
+		if (writer) writer->add(codonSpecificParameterColumn[paramType] + category * codonSpecificParameterTrace[paramType][category].size() + i,
+			sample, curParam[category][i]);
 	}
 
 	/*
@@ -609,7 +1028,7 @@ std::vector<double> Trace::getSynthesisRateAcceptanceRatioTraceByMixtureElementF
 {
 	std::vector<double> RV;
 	bool checkGene = checkIndex(geneIndex, 1, synthesisRateAcceptanceRatioTrace.size());
-	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.size());
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.getNumColumns());
 	if (checkGene && checkMixtureElement)
 	{
 		RV = getSynthesisRateAcceptanceRatioTraceByMixtureElementForGene(mixtureElement - 1, geneIndex - 1);
@@ -621,7 +1040,7 @@ std::vector<double> Trace::getSynthesisRateAcceptanceRatioTraceByMixtureElementF
 std::vector<double> Trace::getSynthesisRateTraceForGeneR(unsigned geneIndex)
 {
 	std::vector<double> RV;
-	bool checkGene = checkIndex(geneIndex, 1, synthesisRateTrace[0].size());
+	bool checkGene = checkIndex(geneIndex, 1, synthesisRateTrace[0].getNumColumns());
 	if (checkGene)
 	{
 		RV = getSynthesisRateTraceForGene(geneIndex - 1);
@@ -633,8 +1052,8 @@ std::vector<double> Trace::getSynthesisRateTraceForGeneR(unsigned geneIndex)
 std::vector<double> Trace::getSynthesisRateTraceByMixtureElementForGeneR(unsigned mixtureElement, unsigned geneIndex)
 {
 	std::vector<double> RV;
-	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.size());
-	bool checkGene = checkIndex(geneIndex, 1, synthesisRateTrace[0].size());
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.getNumColumns());
+	bool checkGene = checkIndex(geneIndex, 1, synthesisRateTrace[0].getNumColumns());
 	if (checkMixtureElement && checkGene)
 	{
 		RV = getSynthesisRateTraceByMixtureElementForGene(mixtureElement - 1, geneIndex - 1);
@@ -646,7 +1065,7 @@ std::vector<double> Trace::getSynthesisRateTraceByMixtureElementForGeneR(unsigne
 std::vector<unsigned> Trace::getMixtureAssignmentTraceForGeneR(unsigned geneIndex)
 {
 	std::vector <unsigned> RV;
-	bool checkGene = checkIndex(geneIndex, 1, mixtureAssignmentTrace[0].size());
+	bool checkGene = checkIndex(geneIndex, 1, mixtureAssignmentTrace.getNumColumns());
 	if (checkGene)
 	{
 		RV = getMixtureAssignmentTraceForGene(geneIndex - 1);
@@ -658,7 +1077,7 @@ std::vector<unsigned> Trace::getMixtureAssignmentTraceForGeneR(unsigned geneInde
 std::vector<double> Trace::getMixtureProbabilitiesTraceForMixtureR(unsigned mixtureIndex)
 {
 	std::vector<double> RV;
-	bool check = checkIndex(mixtureIndex, 1, mixtureProbabilitiesTrace.size());
+	bool check = checkIndex(mixtureIndex, 1, mixtureProbabilitiesTrace.getNumColumns());
 	if (check)
 	{
 		RV = getMixtureProbabilitiesTraceForMixture(mixtureIndex - 1);
@@ -669,13 +1088,164 @@ std::vector<double> Trace::getMixtureProbabilitiesTraceForMixtureR(unsigned mixt
 
 std::vector<std::vector<double>> Trace::getStdDevSynthesisRateTraces()
 {
-	return stdDevSynthesisRateTrace;
+	return stdDevSynthesisRateTrace.getColumns();
 }
 
 
 unsigned Trace::getNumberOfMixtures()
 {
-	return mixtureProbabilitiesTrace.size();
+	return mixtureProbabilitiesTrace.getNumColumns();
+}
+
+
+//------------------------------------------//
+//---------- Statistics Functions ----------//
+//------------------------------------------//
+double Trace::getStdDevSynthesisRateEffectiveSampleSizeR(unsigned selectionCategory)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(selectionCategory, 1, stdDevSynthesisRateStatistics.size());
+	if (check)
+	{
+		RV = getStdDevSynthesisRateEffectiveSampleSize(selectionCategory - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getStdDevSynthesisRateMonteCarloStandardErrorR(unsigned selectionCategory)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(selectionCategory, 1, stdDevSynthesisRateStatistics.size());
+	if (check)
+	{
+		RV = getStdDevSynthesisRateMonteCarloStandardError(selectionCategory - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getSynthesisRateEffectiveSampleSizeR(unsigned mixtureElement, unsigned geneIndex)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.getNumColumns());
+	bool checkGene = checkIndex(geneIndex, 1, synthesisRateStatistics[0].size());
+	if (checkMixtureElement && checkGene)
+	{
+		RV = getSynthesisRateEffectiveSampleSize(mixtureElement - 1, geneIndex - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getSynthesisRateMonteCarloStandardErrorR(unsigned mixtureElement, unsigned geneIndex)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, mixtureProbabilitiesTrace.getNumColumns());
+	bool checkGene = checkIndex(geneIndex, 1, synthesisRateStatistics[0].size());
+	if (checkMixtureElement && checkGene)
+	{
+		RV = getSynthesisRateMonteCarloStandardError(mixtureElement - 1, geneIndex - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getMixtureProbabilitiesEffectiveSampleSizeR(unsigned mixtureIndex)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(mixtureIndex, 1, mixtureProbabilitiesStatistics.size());
+	if (check)
+	{
+		RV = getMixtureProbabilitiesEffectiveSampleSize(mixtureIndex - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getMixtureProbabilitiesMonteCarloStandardErrorR(unsigned mixtureIndex)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(mixtureIndex, 1, mixtureProbabilitiesStatistics.size());
+	if (check)
+	{
+		RV = getMixtureProbabilitiesMonteCarloStandardError(mixtureIndex - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getCodonSpecificParameterEffectiveSampleSizeR(unsigned mixtureElement, std::string& codon, unsigned paramType,
+	bool withoutReference)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, getNumberOfMixtures());
+	if (checkMixtureElement)
+	{
+		RV = getCodonSpecificParameterEffectiveSampleSize(mixtureElement - 1, codon, paramType, withoutReference);
+	}
+	return RV;
+}
+
+
+double Trace::getCodonSpecificParameterMonteCarloStandardErrorR(unsigned mixtureElement, std::string& codon, unsigned paramType,
+	bool withoutReference)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool checkMixtureElement = checkIndex(mixtureElement, 1, getNumberOfMixtures());
+	if (checkMixtureElement)
+	{
+		RV = getCodonSpecificParameterMonteCarloStandardError(mixtureElement - 1, codon, paramType, withoutReference);
+	}
+	return RV;
+}
+
+
+double Trace::getSynthesisOffsetEffectiveSampleSizeR(unsigned index)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(index, 1, synthesisOffsetStatistics.size());
+	if (check)
+	{
+		RV = getSynthesisOffsetEffectiveSampleSize(index - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getSynthesisOffsetMonteCarloStandardErrorR(unsigned index)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(index, 1, synthesisOffsetStatistics.size());
+	if (check)
+	{
+		RV = getSynthesisOffsetMonteCarloStandardError(index - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getObservedSynthesisNoiseEffectiveSampleSizeR(unsigned index)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(index, 1, observedSynthesisNoiseStatistics.size());
+	if (check)
+	{
+		RV = getObservedSynthesisNoiseEffectiveSampleSize(index - 1);
+	}
+	return RV;
+}
+
+
+double Trace::getObservedSynthesisNoiseMonteCarloStandardErrorR(unsigned index)
+{
+	double RV = std::numeric_limits<double>::quiet_NaN();
+	bool check = checkIndex(index, 1, observedSynthesisNoiseStatistics.size());
+	if (check)
+	{
+		RV = getObservedSynthesisNoiseMonteCarloStandardError(index - 1);
+	}
+	return RV;
 }
 
 //--------------------------------------//
@@ -683,7 +1253,12 @@ unsigned Trace::getNumberOfMixtures()
 //--------------------------------------//
 void Trace::setStdDevSynthesisRateTraces(std::vector<std::vector<double>> _stdDevSynthesisRateTrace)
 {
-	stdDevSynthesisRateTrace = _stdDevSynthesisRateTrace;
+	unsigned samples = _stdDevSynthesisRateTrace.empty() ? 0u : _stdDevSynthesisRateTrace[0].size();
+	stdDevSynthesisRateTrace.initialize(_stdDevSynthesisRateTrace.size(), samples, "", stdDevSynthesisRatePrecision);
+	for (unsigned i = 0u; i < _stdDevSynthesisRateTrace.size(); i++)
+	{
+		stdDevSynthesisRateTrace.setColumn(i, _stdDevSynthesisRateTrace[i]);
+	}
 }
 
 
@@ -695,7 +1270,21 @@ void Trace::setStdDevSynthesisRateAcceptanceRatioTrace(std::vector<double> _stdD
 
 void Trace::setSynthesisRateTrace(std::vector<std::vector<std::vector<double>>> _synthesisRateTrace)
 {
-	synthesisRateTrace = _synthesisRateTrace;
+	// the accumulated posteriors are of the replaced trace
+	synthesisRateAccumulators.clear();
+	assignedSynthesisRateAccumulators.clear();
+	synthesisRateTrace.resize(_synthesisRateTrace.size());
+	for (unsigned category = 0; category < _synthesisRateTrace.size(); category++)
+	{
+		unsigned numGenes = _synthesisRateTrace[category].size();
+		unsigned samples = (numGenes == 0u) ? 0u : _synthesisRateTrace[category][0].size();
+		synthesisRateTrace[category].initialize(numGenes, samples, getSynthesisRateTraceFileName(category),
+			synthesisRatePrecision);
+		for (unsigned i = 0; i < numGenes; i++)
+		{
+			synthesisRateTrace[category].setColumn(i, _synthesisRateTrace[category][i]);
+		}
+	}
 }
 
 
@@ -707,13 +1296,34 @@ void Trace::setSynthesisRateAcceptanceRatioTrace(std::vector<std::vector<std::ve
 
 void Trace::setMixtureAssignmentTrace(std::vector<std::vector<unsigned>> _mixtureAssignmentTrace)
 {
-	mixtureAssignmentTrace = _mixtureAssignmentTrace;
+	synthesisRateAccumulators.clear();
+	assignedSynthesisRateAccumulators.clear();
+	mixtureAssignmentCounts.clear();
+	unsigned samples = _mixtureAssignmentTrace.empty() ? 0u : _mixtureAssignmentTrace[0].size();
+	unsigned numMixtures = 1u;
+	for (unsigned i = 0u; i < _mixtureAssignmentTrace.size(); i++)
+	{
+		for (unsigned j = 0u; j < _mixtureAssignmentTrace[i].size(); j++)
+		{
+			numMixtures = std::max(numMixtures, _mixtureAssignmentTrace[i][j] + 1u);
+		}
+	}
+	mixtureAssignmentTrace.initialize(_mixtureAssignmentTrace.size(), samples, numMixtures);
+	for (unsigned i = 0u; i < _mixtureAssignmentTrace.size(); i++)
+	{
+		mixtureAssignmentTrace.setColumn(i, _mixtureAssignmentTrace[i]);
+	}
 }
 
 
 void Trace::setMixtureProbabilitiesTrace(std::vector<std::vector<double>> _mixtureProbabilitiesTrace)
 {
-	mixtureProbabilitiesTrace = _mixtureProbabilitiesTrace;
+	unsigned samples = _mixtureProbabilitiesTrace.empty() ? 0u : _mixtureProbabilitiesTrace[0].size();
+	mixtureProbabilitiesTrace.initialize(_mixtureProbabilitiesTrace.size(), samples, "", mixtureProbabilitiesPrecision);
+	for (unsigned i = 0u; i < _mixtureProbabilitiesTrace.size(); i++)
+	{
+		mixtureProbabilitiesTrace.setColumn(i, _mixtureProbabilitiesTrace[i]);
+	}
 }
 
 
@@ -777,6 +1387,7 @@ void Trace::setObservedSynthesisNoiseTrace(std::vector<std::vector <double> > _O
 void Trace::setCodonSpecificParameterTrace(std::vector<std::vector<std::vector<double>>> _parameterTrace, unsigned paramType)
 {
 	codonSpecificParameterTrace[paramType] = _parameterTrace;
+	if (paramType < codonSpecificParameterAccumulators.size()) codonSpecificParameterAccumulators[paramType].clear();
 	/*
 	switch (paramType) {
 	case 0:
@@ -0,0 +1,179 @@
+#include "include/TraceReader.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#ifndef STANDALONE
+#include <Rcpp.h>
+using namespace Rcpp;
+#endif
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+TraceReader::TraceReader(std::string _filename)
+{
+	filename = _filename;
+	std::ifstream in(filename.c_str(), std::ifstream::binary);
+	char magic[8];
+	unsigned fileVersion = 0u;
+	if (!in.read(magic, 8) || std::memcmp(magic, "RIBTRACE", 8) != 0 || !TraceWriter::readUnsigned(in, fileVersion)
+		|| fileVersion != TraceWriter::version)
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in TraceReader: %s is not a trace file.\n", filename.c_str());
+#else
+		std::cerr << "Warning in TraceReader: " << filename << " is not a trace file.\n";
+#endif
+		return;
+	}
+
+	std::streamoff headerEnd = in.tellg();
+	in.seekg(0, std::ifstream::end);
+	std::streamoff fileSize = in.tellg();
+	in.seekg(headerEnd);
+
+	// stops at the end of the file or at the first incomplete record, e.g. of a crashed run
+	char type;
+	while (in.get(type))
+	{
+		unsigned column;
+		if (!TraceWriter::readUnsigned(in, column)) break;
+		if (type == 'C')
+		{
+			unsigned length;
+			if (!TraceWriter::readUnsigned(in, length)) break;
+			std::string name(length, ' ');
+			if (length > 0u && !in.read(&name[0], length)) break;
+			if (column != columnNames.size()) break;
+			columnIndex[name] = column;
+			columnNames.push_back(name);
+			blocks.resize(columnNames.size());
+		}
+		else if (type == 'B')
+		{
+			Block block;
+			unsigned bytes;
+			if (!TraceWriter::readUnsigned(in, block.firstSample) || !TraceWriter::readUnsigned(in, block.numSamples)
+				|| !TraceWriter::readUnsigned(in, bytes)) break;
+			block.bytes = bytes;
+			block.offset = in.tellg();
+			if (column >= blocks.size() || block.offset + (std::streamoff)bytes > fileSize) break;
+			blocks[column].push_back(block);
+			in.seekg(block.offset + (std::streamoff)bytes);
+		}
+		else break;
+	}
+}
+
+
+TraceReader::~TraceReader()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Reader Functions ----------//
+//--------------------------------------//
+
+
+std::vector<std::string> TraceReader::getColumnNames()
+{
+	return columnNames;
+}
+
+
+unsigned TraceReader::getNumSamples(std::string column)
+{
+	std::map<std::string, unsigned>::iterator it = columnIndex.find(column);
+	if (it == columnIndex.end() || blocks[it->second].empty()) return 0u;
+	Block &last = blocks[it->second].back();
+	return last.firstSample + last.numSamples;
+}
+
+
+// Samples [firstSample, lastSample) of the column, as far as they are in the file.
+std::vector<double> TraceReader::readColumn(std::string column, unsigned firstSample, unsigned lastSample)
+{
+	std::vector<double> RV;
+	std::map<std::string, unsigned>::iterator it = columnIndex.find(column);
+	if (it == columnIndex.end())
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in TraceReader::readColumn: Unknown column %s.\n", column.c_str());
+#else
+		std::cerr << "Warning in TraceReader::readColumn: Unknown column " << column << ".\n";
+#endif
+		return RV;
+	}
+
+	std::ifstream in(filename.c_str(), std::ifstream::binary);
+	std::vector<unsigned char> encoded;
+	std::vector<double> values;
+	std::vector<Block> &columnBlocks = blocks[it->second];
+	for (unsigned i = 0u; i < columnBlocks.size(); i++)
+	{
+		Block &block = columnBlocks[i];
+		if (block.firstSample + block.numSamples <= firstSample || block.firstSample >= lastSample) continue;
+
+		encoded.resize(block.bytes);
+		in.seekg(block.offset);
+		if (block.bytes > 0u && !in.read((char*)encoded.data(), block.bytes)) break;
+		if (!TraceWriter::decodeChunk(encoded, block.numSamples, values)) break;
+		unsigned start = (firstSample > block.firstSample) ? firstSample - block.firstSample : 0u;
+		unsigned end = (lastSample < block.firstSample + block.numSamples) ? lastSample - block.firstSample : block.numSamples;
+		RV.insert(RV.end(), values.begin() + start, values.begin() + end);
+	}
+	return RV;
+}
+
+
+std::vector<std::vector<double>> TraceReader::readColumns(std::vector<std::string> columns, unsigned firstSample,
+	unsigned lastSample)
+{
+	std::vector<std::vector<double>> RV(columns.size());
+	for (unsigned i = 0u; i < columns.size(); i++)
+	{
+		RV[i] = readColumn(columns[i], firstSample, lastSample);
+	}
+	return RV;
+}
+
+
+
+
+
+// -----------------------------------------------------------------------------------------------------//
+// ---------------------------------------- R SECTION --------------------------------------------------//
+// -----------------------------------------------------------------------------------------------------//
+
+
+#ifndef STANDALONE
+
+
+//----------------------------------//
+//---------- RCPP Module -----------//
+//----------------------------------//
+
+
+RCPP_MODULE(TraceReader_mod)
+{
+	class_<TraceReader>( "TraceReader" )
+		.constructor<std::string>()
+
+		.method("getColumnNames", &TraceReader::getColumnNames)
+		.method("getNumSamples", &TraceReader::getNumSamples)
+		.method("readColumn", &TraceReader::readColumn)
+		.method("readColumns", &TraceReader::readColumns)
+		;
+}
+#endif
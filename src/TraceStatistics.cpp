@@ -0,0 +1,231 @@
+#include "include/TraceStatistics.h"
+
+#include <cmath>
+#include <limits>
+
+
+const unsigned TraceStatistics::numBatches;
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+TraceStatistics::TraceStatistics(unsigned _maxLag, bool _windowStatistics)
+{
+	windowStatistics = _windowStatistics;
+	maxLag = windowStatistics ? _maxLag : 0u;
+	clear();
+}
+
+
+TraceStatistics::~TraceStatistics()
+{
+	//dtor
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Update Functions ----------//
+//--------------------------------------//
+
+
+void TraceStatistics::clear()
+{
+	numSamples = 0u;
+	shift = 0.0;
+	mean = 0.0;
+	sumOfSquaredDeviations = 0.0;
+	cumulativeSum.assign(1, 0.0);
+	cumulativeSumOfSquares.assign(1, 0.0);
+	batchSize = 1u;
+	batchCount = 0u;
+	batchSum = 0.0;
+	batchMeans.clear();
+	recentValues.assign(maxLag, 0.0);
+	laggedProducts.assign(maxLag + 1u, 0.0);
+}
+
+
+void TraceStatistics::add(double x)
+{
+	if (numSamples == 0u) shift = x;
+	double y = x - shift;
+	unsigned t = numSamples++;
+
+	double delta = y - mean;
+	mean += delta / numSamples;
+	sumOfSquaredDeviations += delta * (y - mean);
+
+	if (windowStatistics)
+	{
+		cumulativeSum.push_back(cumulativeSum.back() + y);
+		cumulativeSumOfSquares.push_back(cumulativeSumOfSquares.back() + y * y);
+	}
+
+	batchSum += y;
+	if (++batchCount == batchSize)
+	{
+		batchMeans.push_back(batchSum / batchSize);
+		batchSum = 0.0;
+		batchCount = 0u;
+		if (batchMeans.size() == 2u * numBatches)
+		{
+			for (unsigned i = 0u; i < numBatches; i++)
+			{
+				batchMeans[i] = 0.5 * (batchMeans[2u * i] + batchMeans[2u * i + 1u]);
+			}
+			batchMeans.resize(numBatches);
+			batchSize *= 2u;
+		}
+	}
+
+	if (!windowStatistics) return;
+	laggedProducts[0] += y * y;
+	unsigned lags = (t < maxLag) ? t : maxLag;
+	for (unsigned lag = 1u; lag <= lags; lag++)
+	{
+		laggedProducts[lag] += y * recentValues[(t - lag) % maxLag];
+	}
+	if (maxLag > 0u) recentValues[t % maxLag] = y;
+}
+
+
+void TraceStatistics::reserve(unsigned samples)
+{
+	if (!windowStatistics) return;
+	cumulativeSum.reserve(samples + 1u);
+	cumulativeSumOfSquares.reserve(samples + 1u);
+}
+
+
+
+
+
+//------------------------------------------//
+//---------- Statistics Functions ----------//
+//------------------------------------------//
+
+
+unsigned TraceStatistics::getNumSamples()
+{
+	return numSamples;
+}
+
+
+unsigned TraceStatistics::getMaxLag()
+{
+	return maxLag;
+}
+
+
+double TraceStatistics::getMean()
+{
+	return (numSamples == 0u) ? std::numeric_limits<double>::quiet_NaN() : mean + shift;
+}
+
+
+// Variances are divided by the number of samples, as in the Geweke score and the autocovariances.
+double TraceStatistics::getVariance()
+{
+	return (numSamples == 0u) ? std::numeric_limits<double>::quiet_NaN() : sumOfSquaredDeviations / numSamples;
+}
+
+
+double TraceStatistics::getWindowMean(unsigned start, unsigned end)
+{
+	if (!windowStatistics || end <= start || end > numSamples) return std::numeric_limits<double>::quiet_NaN();
+	return (cumulativeSum[end] - cumulativeSum[start]) / (end - start) + shift;
+}
+
+
+double TraceStatistics::getWindowVariance(unsigned start, unsigned end)
+{
+	if (!windowStatistics || end <= start || end > numSamples) return std::numeric_limits<double>::quiet_NaN();
+	double n = end - start;
+	double windowMean = (cumulativeSum[end] - cumulativeSum[start]) / n;
+	double variance = (cumulativeSumOfSquares[end] - cumulativeSumOfSquares[start]) / n - windowMean * windowMean;
+	return (variance > 0.0) ? variance : 0.0;
+}
+
+
+// Geweke score of the samples [start, end): the mean of the first 10% against the mean of the last 50%.
+double TraceStatistics::getGewekeScore(unsigned start, unsigned end)
+{
+	if (end <= start || end > numSamples) return std::numeric_limits<double>::quiet_NaN();
+	unsigned end1 = start + (unsigned)std::round((end - start) * 0.1);
+	unsigned start2 = end - (unsigned)std::round((end - start) * 0.5);
+	if (end1 < start + 2u || end < start2 + 2u) return std::numeric_limits<double>::quiet_NaN();
+
+	double numSamples1 = (double)(end1 - start);
+	double numSamples2 = (double)(end - start2);
+	double mean1 = getWindowMean(start, end1);
+	double mean2 = getWindowMean(start2, end);
+	double standardError = std::sqrt(getWindowVariance(start, end1) / numSamples1 + getWindowVariance(start2, end) / numSamples2);
+	if (standardError == 0.0) // parameter that does not move, e.g. not estimated
+	{
+		return (mean1 == mean2) ? 0.0 : std::numeric_limits<double>::infinity();
+	}
+	return (mean1 - mean2) / standardError;
+}
+
+
+// Variance of the mean of the trace, estimated from the variance of the batch means.
+double TraceStatistics::getBatchMeansVariance()
+{
+	unsigned a = (unsigned)batchMeans.size();
+	if (a < 2u) return std::numeric_limits<double>::quiet_NaN();
+
+	double batchMean = 0.0;
+	for (unsigned i = 0u; i < a; i++)
+	{
+		batchMean += batchMeans[i];
+	}
+	batchMean /= a;
+	double variance = 0.0;
+	for (unsigned i = 0u; i < a; i++)
+	{
+		variance += (batchMeans[i] - batchMean) * (batchMeans[i] - batchMean);
+	}
+	return variance / (a - 1.0) / a;
+}
+
+
+// 1/n sum_t (x_t - mean) * (x_t-lag - mean), expanded into the lagged products and the prefix sums.
+double TraceStatistics::getAutocovariance(unsigned lag)
+{
+	if (!windowStatistics || lag > maxLag || lag >= numSamples) return std::numeric_limits<double>::quiet_NaN();
+	double n = numSamples;
+	double sumLater = cumulativeSum[numSamples] - cumulativeSum[lag]; // x_lag ... x_n-1
+	double sumEarlier = cumulativeSum[numSamples - lag]; // x_0 ... x_n-1-lag
+	return (laggedProducts[lag] - mean * (sumLater + sumEarlier) + (n - lag) * mean * mean) / n;
+}
+
+
+double TraceStatistics::getAutocorrelation(unsigned lag)
+{
+	double variance = getAutocovariance(0u);
+	if (!(variance > 0.0)) return std::numeric_limits<double>::quiet_NaN();
+	return getAutocovariance(lag) / variance;
+}
+
+
+// Number of independent samples with the same variance of the mean: the variance of the trace over the batch-means
+// variance of its mean.
+double TraceStatistics::getEffectiveSampleSize()
+{
+	double batchMeansVariance = getBatchMeansVariance();
+	if (!(batchMeansVariance > 0.0)) return std::numeric_limits<double>::quiet_NaN();
+	return getVariance() / batchMeansVariance;
+}
+
+
+double TraceStatistics::getMonteCarloStandardError()
+{
+	return std::sqrt(getBatchMeansVariance());
+}
@@ -0,0 +1,237 @@
+#include "include/TraceStorage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef STANDALONE
+#include <Rcpp.h>
+#endif
+
+
+const double TraceStorage::minLogQuantized = -16.0;
+const double TraceStorage::maxLogQuantized = 16.0;
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+TraceStorage::TraceStorage()
+{
+	numColumns = 0u;
+	numSamples = 0u;
+	precision = doublePrecision;
+	data = 0;
+}
+
+
+TraceStorage::TraceStorage(const TraceStorage& other)
+{
+	numColumns = other.numColumns;
+	numSamples = other.numSamples;
+	precision = other.precision;
+	values = other.values;
+	mapping = other.mapping;
+	data = mapping ? mapping->data : values.data();
+}
+
+
+TraceStorage& TraceStorage::operator=(const TraceStorage& rhs)
+{
+	if (this == &rhs) return *this; // handle self assignment
+	numColumns = rhs.numColumns;
+	numSamples = rhs.numSamples;
+	precision = rhs.precision;
+	values = rhs.values;
+	mapping = rhs.mapping;
+	data = mapping ? mapping->data : values.data();
+	return *this;
+}
+
+
+TraceStorage::~TraceStorage()
+{
+	//dtor
+}
+
+
+TraceStorage::MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+	if (data != 0) munmap(data, bytes);
+	if (fileDescriptor >= 0) close(fileDescriptor);
+#endif
+}
+
+
+
+
+
+//---------------------------------------//
+//---------- Storage Functions ----------//
+//---------------------------------------//
+
+
+// Sizes the storage to numColumns traces of numSamples samples, all 0, stored with the given Precision. With a
+// filename the values are kept in that file, an existing file is overwritten.
+void TraceStorage::initialize(unsigned _numColumns, unsigned _numSamples, std::string filename, unsigned _precision)
+{
+	numColumns = _numColumns;
+	numSamples = _numSamples;
+	precision = (_precision <= logQuantized) ? _precision : doublePrecision;
+	mapping.reset();
+	values.clear();
+
+	if (!filename.empty() && (std::size_t)numColumns * numSamples > 0u && mapFile(filename))
+	{
+		data = mapping->data;
+		return;
+	}
+	values.assign((std::size_t)numColumns * numSamples * getValueSize(precision), 0u);
+	data = values.data();
+}
+
+
+bool TraceStorage::mapFile(std::string filename)
+{
+#ifndef _WIN32
+	std::shared_ptr<MappedFile> file(new MappedFile());
+	file->bytes = (std::size_t)numColumns * numSamples * getValueSize(precision);
+	// a new file each time: copies still mapping the old one (e.g. of a trace kept from an earlier run) keep its
+	// inode and values instead of seeing it truncated under them
+	unlink(filename.c_str());
+	file->fileDescriptor = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	// the truncated file reads as zeros and only takes disk space where samples are written
+	if (file->fileDescriptor >= 0 && ftruncate(file->fileDescriptor, (off_t)file->bytes) == 0)
+	{
+		void *address = mmap(0, file->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file->fileDescriptor, 0);
+		if (address != MAP_FAILED)
+		{
+			file->data = (unsigned char*)address;
+			mapping = file;
+			return true;
+		}
+	}
+#endif
+#ifndef STANDALONE
+	Rf_warning("Warning in TraceStorage::initialize: Can not map file %s, keeping the trace in memory.\n", filename.c_str());
+#else
+	std::cerr << "Warning in TraceStorage::initialize: Can not map file " << filename << ", keeping the trace in memory.\n";
+#endif
+	return false;
+}
+
+
+bool TraceStorage::isMapped()
+{
+	return (bool)mapping;
+}
+
+
+unsigned TraceStorage::getNumColumns()
+{
+	return numColumns;
+}
+
+
+unsigned TraceStorage::getNumSamples()
+{
+	return numSamples;
+}
+
+
+unsigned TraceStorage::getPrecision()
+{
+	return precision;
+}
+
+
+std::size_t TraceStorage::getValueSize(unsigned precision)
+{
+	if (precision == singlePrecision) return sizeof(float);
+	if (precision == logQuantized) return sizeof(uint16_t);
+	return sizeof(double);
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Access Functions ----------//
+//--------------------------------------//
+
+
+double TraceStorage::get(unsigned column, unsigned sample)
+{
+	std::size_t index = (std::size_t)column * numSamples + sample;
+	if (precision == singlePrecision) return ((float*)data)[index];
+	if (precision == logQuantized)
+	{
+		// code 0 is 0, codes 1 ... 65535 span [minLogQuantized, maxLogQuantized]
+		uint16_t code = ((uint16_t*)data)[index];
+		if (code == 0u) return 0.0;
+		return std::exp(minLogQuantized + (code - 1u) * (maxLogQuantized - minLogQuantized) / 65534.0);
+	}
+	return ((double*)data)[index];
+}
+
+
+void TraceStorage::set(unsigned column, unsigned sample, double value)
+{
+	std::size_t index = (std::size_t)column * numSamples + sample;
+	if (precision == singlePrecision) ((float*)data)[index] = (float)value;
+	else if (precision == logQuantized)
+	{
+		uint16_t code = 0u;
+		if (value > 0.0)
+		{
+			double logValue = std::min(std::max(std::log(value), minLogQuantized), maxLogQuantized);
+			code = (uint16_t)(1u + (unsigned)std::floor((logValue - minLogQuantized) / (maxLogQuantized - minLogQuantized)
+				* 65534.0 + 0.5));
+		}
+		((uint16_t*)data)[index] = code;
+	}
+	else ((double*)data)[index] = value;
+}
+
+
+std::vector<double> TraceStorage::getColumn(unsigned column)
+{
+	std::vector<double> RV(numSamples);
+	for (unsigned i = 0u; i < numSamples; i++)
+	{
+		RV[i] = get(column, i);
+	}
+	return RV;
+}
+
+
+std::vector<std::vector<double>> TraceStorage::getColumns()
+{
+	std::vector<std::vector<double>> RV(numColumns);
+	for (unsigned i = 0u; i < numColumns; i++)
+	{
+		RV[i] = getColumn(i);
+	}
+	return RV;
+}
+
+
+// Copies the trace into the column, cut or padded with 0 to the number of samples.
+void TraceStorage::setColumn(unsigned column, const std::vector<double> &trace)
+{
+	for (unsigned i = 0u; i < numSamples; i++)
+	{
+		set(column, i, (i < trace.size()) ? trace[i] : 0.0);
+	}
+}
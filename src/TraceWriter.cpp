@@ -0,0 +1,219 @@
+#include "include/TraceWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifndef STANDALONE
+#include <Rcpp.h>
+#endif
+
+
+const unsigned TraceWriter::version;
+
+
+
+//--------------------------------------------------//
+// ---------- Constructors & Destructors ---------- //
+//--------------------------------------------------//
+
+
+TraceWriter::TraceWriter(std::string filename, unsigned _chunkSize)
+{
+	chunkSize = (_chunkSize == 0u) ? 1u : _chunkSize;
+	blocksSinceFlush = 0u;
+	out.open(filename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+	if (!out)
+	{
+#ifndef STANDALONE
+		Rf_warning("Warning in TraceWriter: Can not open file %s, traces are not written.\n", filename.c_str());
+#else
+		std::cerr << "Warning in TraceWriter: Can not open file " << filename << ", traces are not written.\n";
+#endif
+		return;
+	}
+	out.write("RIBTRACE", 8);
+	writeUnsigned(out, version);
+}
+
+
+TraceWriter::~TraceWriter()
+{
+	flush();
+}
+
+
+
+
+
+//--------------------------------------//
+//---------- Writer Functions ----------//
+//--------------------------------------//
+
+
+bool TraceWriter::isOpen()
+{
+	return out.is_open() && out.good();
+}
+
+
+unsigned TraceWriter::addColumn(std::string name)
+{
+	unsigned column = columns.size();
+	Column newColumn;
+	newColumn.name = name;
+	newColumn.firstSample = 0u;
+	newColumn.buffer.reserve(chunkSize);
+	columns.push_back(newColumn);
+
+	if (isOpen())
+	{
+		out.put('C');
+		writeUnsigned(out, column);
+		writeUnsigned(out, name.size());
+		out.write(name.data(), name.size());
+	}
+	return column;
+}
+
+
+// Appends the value of the sample to the column. Columns take one sample after the other. Different columns can be
+// added to from different threads at the same time.
+void TraceWriter::add(unsigned column, unsigned sample, double value)
+{
+	Column &current = columns[column];
+	if (current.buffer.empty()) current.firstSample = sample;
+	current.buffer.push_back(value);
+	if (current.buffer.size() == chunkSize) writeBlock(column);
+}
+
+
+// Writes the buffered samples of all columns and flushes the file, e.g. at the end of a run.
+void TraceWriter::flush()
+{
+	for (unsigned i = 0u; i < columns.size(); i++)
+	{
+		if (!columns[i].buffer.empty()) writeBlock(i);
+	}
+	if (isOpen()) out.flush();
+	blocksSinceFlush = 0u;
+}
+
+
+void TraceWriter::writeBlock(unsigned column)
+{
+	Column &current = columns[column];
+	std::vector<unsigned char> encoded;
+	encodeChunk(current.buffer, encoded);
+
+#ifndef __APPLE__
+#pragma omp critical(traceWriter)
+#endif
+	{
+		if (isOpen())
+		{
+			out.put('B');
+			writeUnsigned(out, column);
+			writeUnsigned(out, current.firstSample);
+			writeUnsigned(out, current.buffer.size());
+			writeUnsigned(out, encoded.size());
+			out.write((const char*)encoded.data(), encoded.size());
+			// the columns fill up together, flush about once per round of blocks
+			if (++blocksSinceFlush >= columns.size())
+			{
+				out.flush();
+				blocksSinceFlush = 0u;
+			}
+		}
+	}
+	current.buffer.clear();
+}
+
+
+
+
+
+//-------------------------------------//
+//---------- Codec Functions ----------//
+//-------------------------------------//
+
+
+// Every value is XORed with the previous one (the first with 0). Successive samples of a parameter are close, so the
+// XOR has many zero bytes at the front (sign, exponent, leading mantissa) and often at the end. Each value is one
+// control byte, <leading zero bytes> << 4 | <trailing zero bytes>, followed by the remaining bytes. A repeated value,
+// e.g. a rejected proposal, takes one byte.
+void TraceWriter::encodeChunk(const std::vector<double> &values, std::vector<unsigned char> &encoded)
+{
+	encoded.clear();
+	encoded.reserve(values.size() * 9u);
+	uint64_t previous = 0u;
+	for (unsigned i = 0u; i < values.size(); i++)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &values[i], sizeof(double));
+		uint64_t x = bits ^ previous;
+		previous = bits;
+
+		unsigned leading = 0u;
+		while (leading < 8u && ((x >> (56u - 8u * leading)) & 0xffu) == 0u) leading++;
+		unsigned trailing = 0u;
+		if (leading < 8u)
+		{
+			while (((x >> (8u * trailing)) & 0xffu) == 0u) trailing++;
+		}
+		encoded.push_back((unsigned char)((leading << 4u) | trailing));
+		for (unsigned byte = trailing; byte < 8u - leading; byte++)
+		{
+			encoded.push_back((unsigned char)((x >> (8u * byte)) & 0xffu));
+		}
+	}
+}
+
+
+bool TraceWriter::decodeChunk(const std::vector<unsigned char> &encoded, unsigned numValues, std::vector<double> &values)
+{
+	values.resize(numValues);
+	uint64_t previous = 0u;
+	std::size_t position = 0u;
+	for (unsigned i = 0u; i < numValues; i++)
+	{
+		if (position >= encoded.size()) return false;
+		unsigned leading = encoded[position] >> 4u;
+		unsigned trailing = encoded[position] & 0x0fu;
+		position++;
+		if (leading > 8u || leading + trailing > 8u || position + (8u - leading - trailing) > encoded.size()) return false;
+
+		uint64_t x = 0u;
+		for (unsigned byte = trailing; byte < 8u - leading; byte++)
+		{
+			x |= (uint64_t)encoded[position++] << (8u * byte);
+		}
+		previous ^= x;
+		std::memcpy(&values[i], &previous, sizeof(double));
+	}
+	return position == encoded.size();
+}
+
+
+void TraceWriter::writeUnsigned(std::ostream &stream, unsigned value)
+{
+	char bytes[4];
+	for (unsigned i = 0u; i < 4u; i++)
+	{
+		bytes[i] = (char)((value >> (8u * i)) & 0xffu);
+	}
+	stream.write(bytes, 4);
+}
+
+
+bool TraceWriter::readUnsigned(std::istream &stream, unsigned &value)
+{
+	unsigned char bytes[4];
+	if (!stream.read((char*)bytes, 4)) return false;
+	value = 0u;
+	for (unsigned i = 0u; i < 4u; i++)
+	{
+		value |= (unsigned)bytes[i] << (8u * i);
+	}
+	return true;
+}
@@ -0,0 +1,66 @@
+#ifndef CODONSPECIFICPARAMETERSET_H
+#define CODONSPECIFICPARAMETERSET_H
+
+#include <vector>
+
+// Flat storage for the codon specific parameters of every parameter type and category.
+// All values live in one buffer laid out as [paramType][category][codon]. Every category row
+// is padded to a multiple of eight doubles and the buffer starts on a 64 byte boundary,
+// so every row starts on its own cache line.
+class CodonSpecificParameterSet
+{
+	public:
+		// Strided view on all categories of one parameter type. view[category][codon]
+		// works like the nested vectors this class replaces.
+		class ParameterTypeView
+		{
+			private:
+				double *base;
+				unsigned numCategories;
+				unsigned stride;
+
+			public:
+				ParameterTypeView(double *_base, unsigned _numCategories, unsigned _stride)
+					: base(_base), numCategories(_numCategories), stride(_stride) {}
+				double* operator[](unsigned category) const {return base + category * stride;}
+				unsigned size() const {return numCategories;}
+				unsigned getStride() const {return stride;}
+				double* data() const {return base;}
+		};
+
+		//Constructors & Destructors:
+		CodonSpecificParameterSet();
+		CodonSpecificParameterSet(const CodonSpecificParameterSet& other);
+		CodonSpecificParameterSet& operator=(const CodonSpecificParameterSet& rhs);
+		virtual ~CodonSpecificParameterSet();
+
+
+		//Layout Functions:
+		void initialize(unsigned numParamTypes, unsigned _numCodons);
+		void resizeParameterType(unsigned paramType, unsigned numCategories, double value = 0.0);
+		unsigned getNumParameterTypes();
+		unsigned getNumCategories(unsigned paramType);
+		unsigned getNumCodons();
+
+
+		//Access Functions:
+		ParameterTypeView operator[](unsigned paramType);
+		std::vector<std::vector<double>> getParameterType(unsigned paramType);
+		void setParameterType(unsigned paramType, const std::vector<std::vector<double>> &matrix);
+		void copyCodonRange(CodonSpecificParameterSet &other, unsigned codonStart, unsigned codonEnd);
+
+	private:
+		static const unsigned alignment = 8u; // in doubles, 64 bytes
+
+		std::vector<double> values; // over-allocated by alignment doubles, see base()
+		unsigned alignOffset;
+		std::vector<unsigned> categoriesPerType;
+		std::vector<unsigned> typeOffset; // first value of every parameter type
+		unsigned numCodons;
+		unsigned rowStride;
+
+		double* base() {return values.data() + alignOffset;}
+		void relayout(std::vector<unsigned> newCategoriesPerType, unsigned newNumCodons, double value);
+};
+
+#endif // CODONSPECIFICPARAMETERSET_H
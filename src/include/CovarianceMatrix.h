@@ -16,7 +16,11 @@ class CovarianceMatrix
         std::vector<double> choleskiMatrix;
         int numVariates; //make static const again
 
-		double sampleMean(std::vector<double> sampleVector, unsigned samples, unsigned lastIteration);
+		// Running moments of the samples added since the last clearSamples (Welford), see addSample.
+		unsigned numSamples;
+		std::vector<double> sampleMeans; // [variate]
+		std::vector<double> sampleComoments; // [variate * numVariates + variate], sum of products of the deviations
+		std::vector<double> sampleDeviations; // scratch for addSample
 
     public:
         //Constructors & Destructors:
@@ -40,7 +44,10 @@ class CovarianceMatrix
         std::vector<double>* getCovMatrix();
         int getNumVariates();
         std::vector<double> transformIidNumersIntoCovaryingNumbers(std::vector<double> iidnumbers);
-		void calculateSampleCovariance(std::vector<std::vector<std::vector<std::vector<double>>>> codonSpecificParameterTrace, std::string aa, unsigned samples, unsigned lastIteration);
+		void addSample(const std::vector<double> &sample);
+		void clearSamples();
+		unsigned getNumSamples();
+		void calculateSampleCovariance();
 
 #ifndef STANDALONE
     void setCovarianceMatrix(SEXP _matrix);
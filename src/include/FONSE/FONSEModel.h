@@ -8,9 +8,20 @@ class FONSEModel : public Model
 {
 	private:
 		FONSEParameter *parameter;
+		static const unsigned maxGroupings = 22u; // one grouping per amino acid at most
+		static const unsigned codonSpecificChunkSize = 64u; // genes per work item of calculateLogLikelihoodRatioForAllGroupings
 		double calculateLogLikelihoodRatioPerAA(Gene& gene, std::string grouping, double *mutation, double *selection, double phiValue);
 		double calculateMutationPrior(std::string grouping, bool proposed = false);
 
+		// current and proposed parameters, set in prepareCodonSpecificParameterTables and prepareFusedIteration
+		std::vector<std::string> tableGroupings; // [grouping]
+		std::vector<double> tableMutation, tableMutation_proposed; // [grouping][mutation category][codon]
+		std::vector<double> tableSelection, tableSelection_proposed; // [grouping][selection category][codon]
+		std::vector<double> fusedStdDevSynthesisRate, fusedStdDevSynthesisRate_proposed; // [synthesis rate category]
+
+		void prepareCodonSpecificParameterTables();
+		void addGeneToCodonSpecificLogLikelihoods(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods);
+
 	public:
 		//Constructors & Destructors:
 		explicit FONSEModel();
@@ -21,10 +32,22 @@ class FONSEModel : public Model
 		//Likelihood Ratio Functions:
 		virtual void calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneIndex, unsigned k, double* logProbabilityRatio);
 		virtual void calculateLogLikelihoodRatioPerGroupingPerCategory(std::string grouping, Genome& genome, double& logAcceptanceRatioForAllMixtures);
+		virtual void calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios);
 		virtual void calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration, std::vector <double> &logProbabilityRatio);
 
 
 
+		//Fused Iteration Functions:
+		virtual bool isFusedIterationSupported();
+		virtual unsigned getNumHyperParameterLogRatios();
+		virtual void prepareFusedIteration(Genome& genome);
+		virtual void addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+				double *hyperParameterLogRatios);
+		virtual void completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+				std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios);
+
+
+
 		//Initialization and Restart Functions:
 		virtual void initTraces(unsigned samples, unsigned num_genes);
 		virtual void writeRestartFile(std::string filename);
@@ -36,7 +59,7 @@ class FONSEModel : public Model
 		virtual unsigned getMutationCategory(unsigned mixture);
 		virtual unsigned getSelectionCategory(unsigned mixture);
 		virtual unsigned getSynthesisRateCategory(unsigned mixture);
-		virtual std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned k);
+		virtual std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned k);
 
 
 
@@ -55,6 +78,7 @@ class FONSEModel : public Model
 
 		//Synthesis Rate Functions:
 		virtual double getSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
+		virtual double getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
 		virtual void updateSynthesisRate(unsigned i, unsigned k);
 
 
@@ -73,6 +97,7 @@ class FONSEModel : public Model
 		virtual void updateCodonSpecificParameterTrace(unsigned sample, std::string grouping);
 		virtual void updateHyperParameterTraces(unsigned sample);
 		virtual void updateTracesWithInitialValues(Genome &genome);
+		virtual Trace& getTraceObject();
 
 
 
@@ -107,6 +132,7 @@ class FONSEModel : public Model
 		virtual void printHyperParameters();
 		void setParameter(FONSEParameter &_parameter);
 		virtual double calculateAllPriors();
+		virtual double calculateLogLikelihood(Genome& genome);
 		void calculateCodonProbabilityVector(unsigned numCodons, unsigned position, unsigned maxIndexValue,
 											 double* mutation, double* selection, double phi, double codonProb[]);
 		virtual void getParameterForCategory(unsigned category, unsigned param, std::string aa, bool proposal,
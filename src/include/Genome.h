@@ -22,6 +22,15 @@ class Genome
 		std::vector<Gene> genes;
 		std::vector<Gene> simulatedGenes;
 		std::vector <unsigned> numGenesWithPhi;
+		std::vector <unsigned> codonCountMatrix; //order: gene, codon (64 per gene, codonArray order)
+		std::vector <std::vector <unsigned>> genesWithAA; //order: aaIndex, genes in which the amino acid occurs
+		std::vector <std::vector <unsigned>> codonCountsForAA; //order: aaIndex, (genesWithAA entry, codon of the amino acid)
+		unsigned numObservedSynthesisRateSets;
+		std::vector <double> logObservedSynthesisRates; //order: gene, phi set (0 if the value is missing)
+		std::vector <unsigned char> observedSynthesisRateMask; //order: gene, phi set (1 if the value is observed)
+
+		void addGeneToCodonCountTables(unsigned geneIndex);
+		void addGeneToObservedSynthesisRateMatrix(unsigned geneIndex);
 
 	public:
 
@@ -53,6 +62,14 @@ class Genome
 		void clear();
 		Genome getGenomeForGeneIndicies(std::vector <unsigned> indicies, bool simulated = false); //NOTE: If simulated is true, it will return a genome with the simulated genes, but the returned genome's genes vector will contain the simulated genes.
 		std::vector<unsigned> getCodonCountsPerGene(std::string codon);
+		void buildCodonCountMatrix();
+		const unsigned* getCodonCountsForGene(unsigned geneIndex);
+		const std::vector<unsigned>& getGenesWithAA(unsigned aaIndex);
+		const unsigned* getCodonCountsForAA(unsigned aaIndex);
+		void buildObservedSynthesisRateMatrix();
+		unsigned getNumObservedSynthesisRateSets();
+		const double* getLogObservedSynthesisRates();
+		const unsigned char* getObservedSynthesisRateMask();
 
 
 		//Testing Functions:
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdlib.h> //can be removed later
+#include <random>
 #ifndef STANDALONE
 #include <Rcpp.h>
 #endif
@@ -15,6 +16,7 @@
 #include "ROC/ROCModel.h"
 #include "RFP/RFPModel.h"
 #include "FONSE/FONSEModel.h"
+#include "TraceStatistics.h"
 
 
 
@@ -33,23 +35,69 @@ class MCMCAlgorithm
 		bool estimateHyperParameter;
 		bool estimateMixtureAssignment;
 		bool writeRestartFile;
+		bool parallelSynthesisRateSweep; // run the gene loop of the synthesis rate sweep in parallel
+		bool blockedCodonSpecificParameterUpdate; // evaluate the proposals of all groupings in one pass over the genome
+		bool fusedIteration; // run all update steps of an iteration in one pass over the genome
+		bool fusedIterationActive; // fusedIteration, if the model and the estimated parameters allow it. Set by initializeRun
+
+
+		unsigned convergenceDiagnostics; // diagnostics that have to pass to stop the run early, 0 never stops
+		double convergenceThreshold; // largest absolute Geweke score of a converged trace
+		unsigned minimumConvergenceSamples; // no early stop before this many samples
+		bool converged;
 
 
 		std::vector<double> likelihoodTrace;
+		TraceStatistics likelihoodStatistics; // of likelihoodTrace, without the initial evaluation: sample i is likelihoodTrace[i + 1]
 		std::vector<double> tmp;
 
 
+		// Working memory of one thread in the synthesis rate sweeps.
+		struct SweepScratch
+		{
+			std::vector<double> unscaledLogProb_curr; // [selection category]
+			std::vector<double> unscaledLogProb_prop;
+			std::vector<double> unscaledLogPost_curr;
+			std::vector<double> unscaledLogPost_prop;
+			std::vector<double> unscaledLogProb_curr_singleMixture; // [mixture]
+			std::vector<double> probabilities;
+			std::vector<double> dirichletParameters;
+		};
+		std::vector<SweepScratch> sweepScratch; // [thread]
+		std::vector<double> acceptanceDraws; // [gene * selection category]
+		std::vector<double> mixtureDraws; // [gene]
+		std::vector<double> geneLogLikelihood; // [gene]
+		std::vector<double> categoryProbabilities; // [mixture]
+		std::vector<double> newMixtureProbabilities; // [mixture]
+
+		static const unsigned sweepChunkSize = 64u; // genes per work item of the parallel sweep and per partial sum of a fused iteration
+		std::vector<double> fusedLogRatios; // [chunk][codon specific log likelihoods, hyper parameter log ratios]
+
+
 		std::string file;
 		unsigned fileWriteInterval;
 		bool multipleFiles;
 
 
 		//Acceptance Rejection Functions:
-		double acceptRejectSynthesisRateLevelForAllGenes(Genome& genome, Model& model, int iteration);
+		void prepareSweepScratch(unsigned numGenes, unsigned numSynthesisRateCategories, unsigned numMixtures, unsigned numThreads);
+		double acceptRejectSynthesisRateLevelForAllGenes(Genome& genome, Model& model, int iteration, bool fused = false);
+		double acceptRejectSynthesisRateLevelForAllGenesInParallel(Genome& genome, Model& model, int iteration, bool fused = false);
 		void acceptRejectCodonSpecificParameter(Genome& genome, Model& model, int iteration);
 		void acceptRejectHyperParameter(Genome &genome, Model& model, int iteration);
+		void acceptCodonSpecificParameters(Model& model, int iteration, std::vector<double> &logAcceptanceRatios);
+		void acceptHyperParameters(Model& model, int iteration, std::vector<double> &logProbabilityRatios);
+		double acceptRejectFusedIteration(Genome& genome, Model& model, int iteration);
+
+
+		//Convergence Functions:
+		bool checkConvergence(Model& model, unsigned sample);
 
 	public:
+		// convergence diagnostics for setConvergenceCriteria, combined with |
+		static const unsigned gewekeLogLikelihood;
+		static const unsigned gewekeCodonSpecificParameters;
+
 
 		//Constructors & Destructors:
 		explicit MCMCAlgorithm();
@@ -62,18 +110,30 @@ class MCMCAlgorithm
 
 		//MCMC Functions:
 		void run(Genome& genome, Model& model, unsigned numCores = 1u, unsigned divergenceIterations = 0u);
+		void initializeRun(Genome& genome, Model& model, unsigned divergenceIterations = 0u);
+		bool runIteration(Genome& genome, Model& model, unsigned iteration);
 		void varyInitialConditions(Genome& genome, Model& model, unsigned divergenceIterations);
 		double calculateGewekeScore(unsigned current_iteration);
+		void setConvergenceCriteria(unsigned diagnostics, double threshold = 1.96, unsigned minimumSamples = 0u);
+		unsigned getConvergenceDiagnostics();
+		bool isConverged();
+		void truncateTraces(Model& model, unsigned sample);
 
 		bool isEstimateSynthesisRate();
 		bool isEstimateCodonSpecificParameter();
 		bool isEstimateHyperParameter();
 		bool isEstimateMixtureAssignment();
+		bool isParallelSynthesisRateSweep();
+		bool isBlockedCodonSpecificParameterUpdate();
+		bool isFusedIteration();
 
 		void setEstimateSynthesisRate(bool in);
 		void setEstimateCodonSpecificParameter(bool in);
 		void setEstimateHyperParameter(bool in);
 		void setEstimateMixtureAssignment(bool in);
+		void setParallelSynthesisRateSweep(bool in);
+		void setBlockedCodonSpecificParameterUpdate(bool in);
+		void setFusedIteration(bool in);
 
 		void setRestartFileSettings(std::string filename, unsigned interval, bool multiple);
 		void setStepsToAdapt(unsigned steps);
@@ -81,6 +141,8 @@ class MCMCAlgorithm
 
 		std::vector<double> getLogLikelihoodTrace();
 		double getLogLikelihoodPosteriorMean(unsigned samples);
+		double getLogLikelihoodAutocorrelation(unsigned lag);
+		double getLogLikelihoodBatchMeansVariance();
 
 		static std::vector<double> acf(std::vector<double>& x, int nrows, int ncols, int lagmax, bool correlation, bool demean);
 		static std::vector<std::vector<double>> solveToeplitzMatrix(int lr, std::vector<double> r, std::vector<double> g);
@@ -0,0 +1,114 @@
+#ifndef MULTICHAINMCMC_H
+#define MULTICHAINMCMC_H
+
+#include <vector>
+#include <string>
+#ifndef STANDALONE
+#include <Rcpp.h>
+#endif
+
+#include "MCMCAlgorithm.h"
+
+
+// Runs several chains against one shared genome. Every chain has its own model (and parameter object) and its own
+// MCMCAlgorithm, the genome is only read. Each chain runs at an inverse temperature (see
+// Model::setInverseTemperature). Every swapInterval iterations neighbouring temperatures of the ladder propose to swap
+// their states (parallel tempering). Swapping the temperatures of the two chains is equivalent and much cheaper than
+// swapping the states, so the chains keep their model and record the temperature they ran at.
+// With all inverse temperatures at 1 (the default) the chains are independent and the run gives the split R-hat of the
+// log likelihood across chains while running, which can also stop the run (see setConvergenceCriteria).
+// Files of the chains (restart files, mapped traces and trace writer files, see Trace) get the prefix chain<c>_ on
+// their file name, so chains built from copies of one parameter object do not write to the same files.
+//
+// In standalone builds the chains run in parallel, each with its own random stream, so the results do not depend on
+// the number of threads. R builds run the chains one after the other as the R API and random number generator are
+// not thread safe.
+class MultiChainMCMC
+{
+	private:
+		struct Chain
+		{
+			Model *model;
+			MCMCAlgorithm mcmc;
+			unsigned slot; // position in the temperature ladder
+			bool stopped; // log likelihood became NaN
+			double logLikelihood; // untempered codon log likelihood at the end of the last segment
+			std::vector<double> inverseTemperatureTrace; // [swap round]
+			std::vector<double> logLikelihoodTrace; // [swap round], untempered
+#ifdef STANDALONE
+			RandomStream generator;
+#endif
+		};
+
+		MCMCAlgorithm settings; // copied into every chain when the run starts
+		unsigned samples;
+		unsigned thining;
+		unsigned adaptiveWidth;
+		unsigned swapInterval;
+
+		std::vector<Chain> chains;
+		std::vector<double> inverseTemperatures; // [slot], descending
+		std::vector<unsigned> chainInSlot; // [slot]
+		std::vector<unsigned> numSwapProposals; // [slot pair]
+		std::vector<unsigned> numSwapAccepts; // [slot pair]
+		std::vector<double> rHatTrace; // [swap round]
+		double rHatThreshold; // stop once the R-hat falls below, 0 never stops early
+		unsigned minimumConvergenceSamples;
+		bool converged;
+
+		std::string file;
+		unsigned fileWriteInterval;
+		bool multipleFiles;
+		bool writeRestartFile;
+
+
+		void runSegment(Genome& genome, unsigned chain, unsigned firstIteration, unsigned lastIteration);
+		void proposeSwaps(unsigned round);
+		std::string getChainFileName(unsigned chain, std::string filename);
+
+	public:
+
+		//Constructors & Destructors:
+		explicit MultiChainMCMC();
+		MultiChainMCMC(unsigned _samples, unsigned _thining, unsigned _adaptiveWidth = 100,
+					bool _estimateSynthesisRate = true, bool _estimateCodonSpecificParameter = true,
+					bool _estimateHyperParameter = true);
+		virtual ~MultiChainMCMC();
+
+
+
+		//Chain Functions:
+		void addChain(Model& model);
+		unsigned getNumChains();
+		void setInverseTemperatures(std::vector<double> betas);
+		std::vector<double> getInverseTemperatures();
+		void setSwapInterval(unsigned interval);
+		unsigned getSwapInterval();
+
+
+
+		//MCMC Functions:
+		void run(Genome& genome, unsigned numCores = 1u, unsigned divergenceIterations = 0u);
+		void setEstimateMixtureAssignment(bool in);
+		void setParallelSynthesisRateSweep(bool in);
+		void setBlockedCodonSpecificParameterUpdate(bool in);
+		void setFusedIteration(bool in);
+		void setStepsToAdapt(unsigned steps);
+		void setRestartFileSettings(std::string filename, unsigned interval, bool multiple);
+		void setConvergenceCriteria(double threshold, unsigned minimumSamples = 0u);
+		bool isConverged();
+
+
+
+		//Diagnostic Functions:
+		std::vector<double> getLogLikelihoodTrace(unsigned chain);
+		std::vector<double> getUntemperedLogLikelihoodTrace(unsigned chain);
+		std::vector<double> getInverseTemperatureTrace(unsigned chain);
+		std::vector<double> getSwapAcceptanceRates();
+		std::vector<double> getRHatTrace();
+		void writeChainTraces(std::string filename);
+
+		static double calculateRHat(std::vector<std::vector<double>> &traces, unsigned start, unsigned end);
+};
+
+#endif // MULTICHAINMCMC_H
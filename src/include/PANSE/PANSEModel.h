@@ -9,6 +9,7 @@
 class PANSEModel: public Model {
 	private:
 		PANSEParameter *parameter;
+		std::vector<unsigned> groupListCodonIndex; // codon index of every grouping, set in setParameter
 
 		virtual double calculateLogLikelihoodPerCodonPerGene(double currAlpha, double currLambdaPrime,
 				unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue);
@@ -93,6 +94,10 @@ class PANSEModel: public Model {
 		{
 			return parameter->getSynthesisRate(index, mixture, proposed);
 		}
+		virtual double getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed = false)
+		{
+			return parameter->getLogSynthesisRate(index, mixture, proposed);
+		}
 		virtual double getCurrentSphiProposalWidth()
 		{
 			return parameter->getCurrentSphiProposalWidth();
@@ -117,7 +122,7 @@ class PANSEModel: public Model {
 		{
 			return parameter->getNumSynthesisRateCategories();
 		}
-		virtual std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned k)
+		virtual std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned k)
 		{
 			return parameter->getMixtureElementsOfSelectionCategory(k);
 		}
@@ -153,6 +158,10 @@ class PANSEModel: public Model {
 		{
 			return parameter->getParameterForCategory(category, param, codon, proposal);
 		}
+		double getParameterForCategory(unsigned category, unsigned param, unsigned codonIndex, bool proposal)
+		{
+			return parameter->getParameterForCategory(category, param, codonIndex, proposal);
+		}
 		virtual unsigned getListSize() //TODO: should not be static
 		{
 			return 61;
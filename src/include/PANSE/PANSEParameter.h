@@ -102,6 +102,7 @@ class PANSEParameter: public Parameter {
 
 		//Other functions:
 		double getParameterForCategory(unsigned category, unsigned paramType, std::string codon, bool proposal);
+		double getParameterForCategory(unsigned category, unsigned paramType, unsigned codonIndex, bool proposal);
 		virtual std::vector<double> getEstimatedMixtureAssignmentProbabilities(unsigned samples, unsigned geneIndex);
 
 
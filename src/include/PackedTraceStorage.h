@@ -0,0 +1,50 @@
+#ifndef PACKEDTRACESTORAGE_H
+#define PACKEDTRACESTORAGE_H
+
+#include <vector>
+#include <cstdint>
+
+// Column oriented storage for traces of small unsigned values in [0, numValues), e.g. the mixture assignment of every
+// gene: storage[column][sample]. Each value takes ceil(log2(numValues)) bits (none for a single value) instead of an
+// unsigned. Fields do not cross 64 bit words and every column starts at a new word, so different columns can be set
+// from different threads at the same time.
+// Every column also keeps a histogram of its values, which answers counts over the whole trace in O(numValues). Counts
+// over any other range still scan the shorter of the range and the samples outside of it, so only ranges covering
+// (nearly) the whole trace are cheap. Trace keeps separate histograms of its posterior window for the usual
+// "last N samples" queries.
+class PackedTraceStorage
+{
+	private:
+		unsigned numColumns;
+		unsigned numSamples;
+		unsigned numValues;
+		unsigned bitsPerValue;
+		unsigned valuesPerWord;
+		unsigned wordsPerColumn;
+		std::vector<uint64_t> words; // column after column
+		std::vector<unsigned> counts; // order: column, value
+
+	public:
+		//Constructors & Destructors:
+		PackedTraceStorage();
+		virtual ~PackedTraceStorage();
+
+
+		//Storage Functions:
+		void initialize(unsigned _numColumns, unsigned _numSamples, unsigned _numValues);
+		unsigned getNumColumns();
+		unsigned getNumSamples();
+		unsigned getNumValues();
+		unsigned getBitsPerValue();
+
+
+		//Access Functions:
+		unsigned get(unsigned column, unsigned sample);
+		void set(unsigned column, unsigned sample, unsigned value);
+		std::vector<unsigned> getColumn(unsigned column);
+		std::vector<std::vector<unsigned>> getColumns();
+		void setColumn(unsigned column, const std::vector<unsigned> &trace);
+		std::vector<unsigned> getCounts(unsigned column, unsigned firstSample, unsigned lastSample);
+};
+
+#endif // PACKEDTRACESTORAGE_H
@@ -0,0 +1,34 @@
+#ifndef POSTERIORACCUMULATOR_H
+#define POSTERIORACCUMULATOR_H
+
+// Running posterior summaries of one parameter: the mean and the sum of squared deviations (Welford) and the mean of
+// the log values, updated in constant time per sample and constant memory. Trace keeps one per parameter for the
+// samples of the posterior window, so the posterior means and variances do not have to copy and rescan the traces.
+class PosteriorAccumulator
+{
+	public:
+		//Constructors & Destructors:
+		PosteriorAccumulator();
+		virtual ~PosteriorAccumulator();
+
+
+		//Update Functions:
+		void clear();
+		void add(double x);
+
+
+		//Posterior Functions:
+		unsigned getNumSamples();
+		double getMean();
+		double getLogMean();
+		double getVariance(bool unbiased);
+		double getSumOfSquaredDeviations(double center);
+
+	private:
+		unsigned numSamples;
+		double mean;
+		double sumOfSquaredDeviations;
+		double sumOfLogs;
+};
+
+#endif // POSTERIORACCUMULATOR_H
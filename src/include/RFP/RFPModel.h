@@ -11,9 +11,24 @@ class RFPModel: public Model
 {
 	private:
 		RFPParameter *parameter;
+		std::vector<unsigned> groupListCodonIndex; // codon index of every grouping, set in setParameter
+
+		static const unsigned maxGroupings = 64u; // one grouping per codon at most
+		static const unsigned lgammaTableSize = 64u; // lgamma(n * alpha) is tabulated for n < lgammaTableSize
+		static const unsigned codonSpecificChunkSize = 64u; // genes per work item of calculateLogLikelihoodRatioForAllGroupings
 
 		double calculateLogLikelihoodPerCodonPerGene(double currAlpha, double currLambdaPrime,
-				unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue);
+				unsigned currRFPObserved, unsigned currNumCodonsInMRNA, double phiValue, double logPhiValue,
+				const double *lgammaAlphaTable = NULL);
+
+		// current and proposed codon specific parameters, set in prepareCodonSpecificParameterTables
+		std::vector<double> tableAlpha, tableAlpha_proposed; // [grouping][alpha category]
+		std::vector<double> tableLambdaPrime, tableLambdaPrime_proposed; // [grouping][lambda prime category]
+		std::vector<double> tableLgammaAlpha, tableLgammaAlpha_proposed; // [grouping][alpha category][n]
+		std::vector<double> fusedStdDevSynthesisRate, fusedStdDevSynthesisRate_proposed; // [synthesis rate category]
+
+		void prepareCodonSpecificParameterTables();
+		void addGeneToCodonSpecificLogLikelihoods(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods);
 
 
 	public:
@@ -27,11 +42,23 @@ class RFPModel: public Model
 				double* logProbabilityRatio);
 		virtual void calculateLogLikelihoodRatioPerGroupingPerCategory(std::string grouping, Genome& genome,
 				double& logAcceptanceRatioForAllMixtures);
+		virtual void calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios);
 		virtual void calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration,
 				std::vector <double> &logProbabilityRatio);
 
 
 
+		//Fused Iteration Functions:
+		virtual bool isFusedIterationSupported();
+		virtual unsigned getNumHyperParameterLogRatios();
+		virtual void prepareFusedIteration(Genome& genome);
+		virtual void addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+				double *hyperParameterLogRatios);
+		virtual void completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+				std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios);
+
+
+
 		//Initialization and Restart Functions:
 		virtual void initTraces(unsigned samples, unsigned num_genes);
 		virtual void writeRestartFile(std::string filename);
@@ -43,7 +70,7 @@ class RFPModel: public Model
 		virtual unsigned getMutationCategory(unsigned mixture);
 		virtual unsigned getSelectionCategory(unsigned mixture);
 		virtual unsigned getSynthesisRateCategory(unsigned mixture);
-		virtual std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned k);
+		virtual std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned k);
 
 
 
@@ -62,6 +89,7 @@ class RFPModel: public Model
 
 		//Synthesis Rate Functions:
 		virtual double getSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
+		virtual double getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
 		virtual void updateSynthesisRate(unsigned i, unsigned k);
 
 
@@ -80,6 +108,7 @@ class RFPModel: public Model
 		virtual void updateCodonSpecificParameterTrace(unsigned sample, std::string codon);
 		virtual void updateHyperParameterTraces(unsigned sample);
 		virtual void updateTracesWithInitialValues(Genome &genome);
+		virtual Trace& getTraceObject();
 
 
 
@@ -114,7 +143,9 @@ class RFPModel: public Model
 		virtual void printHyperParameters();
 		void setParameter(RFPParameter &_parameter);
 		virtual double calculateAllPriors();
+		virtual double calculateLogLikelihood(Genome& genome);
 		virtual double getParameterForCategory(unsigned category, unsigned param, std::string codon, bool proposal);
+		double getParameterForCategory(unsigned category, unsigned param, unsigned codonIndex, bool proposal);
 
 	protected:
 };
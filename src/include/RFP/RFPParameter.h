@@ -72,6 +72,7 @@ class RFPParameter: public Parameter {
 
 		//Other functions:
 		double getParameterForCategory(unsigned category, unsigned paramType, std::string codon, bool proposal);
+		double getParameterForCategory(unsigned category, unsigned paramType, unsigned codonIndex, bool proposal);
 		void calculateRFPMean(Genome& genome);
 
 
@@ -9,10 +9,27 @@ class ROCModel : public Model
     private:
 		ROCParameter *parameter;
 		bool withPhi;
+		std::vector<unsigned> groupListAAIndex; // amino acid index of every grouping, set in setParameter
 
-		double calculateLogLikelihoodPerAAPerGene(unsigned numCodons, int codonCount[], double mutation[], double selection[], double phiValue);
+		static const unsigned maxGroupings = 22u; // one grouping per amino acid at most
+		static const unsigned geneBlockSize = 64u; // number of genes evaluated together by calculateLogLikelihoodPerAAForGeneBlock
+		static const unsigned codonSpecificChunkSize = 256u; // genes per work item of calculateLogLikelihoodsPerAA
+		static const unsigned hyperParameterChunkSize = 256u; // genes per work item of calculateLogLikelihoodRatioForHyperParameters
+
+		double calculateLogLikelihoodPerAAForGeneBlock(unsigned numCodons, unsigned numGenes, unsigned stride, const unsigned codonCount[],
+					const double phi[], double mutation[], double selection[], double logLikelihood[]);
+		void calculateLogLikelihoodsPerAA(Genome& genome, std::vector<unsigned> &aaIndices, std::vector<double> &likelihood,
+					std::vector<double> &likelihood_proposed);
 		double calculateMutationPrior(std::string grouping, bool proposed = false); // TODO add to FONSE as well? // cedric
-		void obtainCodonCount(SequenceSummary *seqsum, std::string curAA, int codonCount[]);
+
+		// current and proposed parameters of a fused iteration, set in prepareFusedIteration
+		std::vector<double> fusedMutation, fusedMutation_proposed; // [grouping][mutation category][codon]
+		std::vector<double> fusedSelection, fusedSelection_proposed; // [grouping][selection category][codon]
+		std::vector<double> fusedStdDevSynthesisRate, fusedStdDevSynthesisRate_proposed; // [synthesis rate category]
+		std::vector<double> fusedNoiseOffset, fusedNoiseOffset_proposed, fusedObservedSynthesisNoise; // [observed phi set]
+		const double *fusedLogObservedPhi; // see Genome::getLogObservedSynthesisRates
+		const unsigned char *fusedObservedPhiMask;
+		unsigned fusedNumPhiSets;
 
     public:
 		//Constructors & Destructors:
@@ -26,10 +43,22 @@ class ROCModel : public Model
 					double* logProbabilityRatio);
 		virtual void calculateLogLikelihoodRatioPerGroupingPerCategory(std::string grouping, Genome& genome,
 					double& logAcceptanceRatioForAllMixtures);
+		virtual void calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios);
 		virtual void calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration,
 					std::vector <double> &logProbabilityRatio);
 
 
+
+		//Fused Iteration Functions:
+		virtual bool isFusedIterationSupported();
+		virtual unsigned getNumHyperParameterLogRatios();
+		virtual void prepareFusedIteration(Genome& genome);
+		virtual void addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+					double *hyperParameterLogRatios);
+		virtual void completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+					std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios);
+
+
 		//Initialization and Restart Functions:
 		virtual void initTraces(unsigned samples, unsigned num_genes);
 		virtual void writeRestartFile(std::string filename);
@@ -41,7 +70,7 @@ class ROCModel : public Model
 		virtual unsigned getMutationCategory(unsigned mixture);
 		virtual unsigned getSelectionCategory(unsigned mixture);
 		virtual unsigned getSynthesisRateCategory(unsigned mixture);
-		virtual std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned k);
+		virtual std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned k);
 
 
 
@@ -60,6 +89,7 @@ class ROCModel : public Model
 
 		//Synthesis Rate Functions:
 		virtual double getSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
+		virtual double getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed = false);
 		virtual void updateSynthesisRate(unsigned i, unsigned k);
 
 
@@ -78,6 +108,7 @@ class ROCModel : public Model
 		virtual void updateCodonSpecificParameterTrace(unsigned sample, std::string grouping);
 		virtual void updateHyperParameterTraces(unsigned sample);
 		virtual void updateTracesWithInitialValues(Genome &genome);
+		virtual Trace& getTraceObject();
 
 
 
@@ -112,6 +143,7 @@ class ROCModel : public Model
 		virtual void printHyperParameters();
 		void setParameter(ROCParameter &_parameter);
 		virtual double calculateAllPriors();
+		virtual double calculateLogLikelihood(Genome& genome);
 		void calculateCodonProbabilityVector(unsigned numCodons, double mutation[], double selection[], double phi, double codonProb[]);
 		virtual void getParameterForCategory(unsigned category, unsigned param, std::string aa, bool proposal, double* returnValue);
 
@@ -0,0 +1,59 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+
+// Counter-based random number generator (Philox4x32-10, Salmon et al. 2011, "Parallel random
+// numbers: as easy as 1, 2, 3"). The output is a pure function of the key (the seed) and a
+// 128 bit counter. The counter holds the position within the stream and the (iteration, gene)
+// the stream belongs to, so every gene of every iteration has its own independent stream and
+// the draws of a gene do not depend on which thread handles it.
+//
+// RandomStream satisfies the UniformRandomBitGenerator requirements and can be passed to the
+// std distributions. The next* and fill* functions use fixed algorithms and give the same
+// values with every standard library.
+class RandomStream
+{
+	public:
+		typedef uint32_t result_type;
+		static constexpr result_type min() {return 0u;}
+		static constexpr result_type max() {return 0xFFFFFFFFu;}
+		static const unsigned fillBlockSize = 256u; // uniforms generated ahead of a vectorized transformation
+
+		//Constructors & Destructors:
+		RandomStream();
+		explicit RandomStream(uint64_t seed, uint32_t iteration = 0u, uint32_t gene = 0u);
+		virtual ~RandomStream();
+
+
+		//Stream Functions:
+		void seed(uint64_t seed);
+		void setStream(uint64_t seed, uint32_t iteration, uint32_t gene);
+		void discard(unsigned long long z);
+		result_type operator()();
+
+
+		//Draw Functions:
+		double nextUnif();
+		double nextNorm();
+		double nextExp();
+		void fillUnif(double *output, unsigned n, double minVal = 0.0, double maxVal = 1.0);
+		void fillNorm(double *output, unsigned n, double mean = 0.0, double sd = 1.0);
+		void fillExp(double *output, unsigned n, double rate = 1.0);
+
+
+		//Static Functions:
+		static void philox(const uint32_t key[2], const uint32_t counter[4], uint32_t output[4]);
+
+	private:
+		uint32_t key[2];
+		uint32_t counter[4]; // {block (low), block (high), gene, iteration}
+		uint32_t block[4]; // output of the current counter
+		unsigned position; // next unused word of block, 4 if block is used up
+		bool hasSavedNorm; // Box-Muller gives two normals per pair of uniforms
+		double savedNorm;
+
+		void nextBlock();
+};
+
+#endif // RANDOMSTREAM_H
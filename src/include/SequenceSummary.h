@@ -34,6 +34,8 @@ class SequenceSummary
 		static const std::map<std::string, unsigned> aaToIndex;
 		static const std::map<std::string, unsigned> codonToIndexWithReference;
 		static const std::map<std::string, unsigned> codonToIndexWithoutReference;
+		static const unsigned codonRangeForAAIndex[22][2]; //[start, end) in codonArray, indexed like AminoAcidArray
+		static const unsigned codonRangeForAAIndexParameter[22][2]; //[start, end) in codonArrayParameter
 
 
 
@@ -77,6 +79,7 @@ class SequenceSummary
 		static std::string indexToAA(unsigned aaIndex); //Moving to CT
 		static std::string indexToCodon(unsigned index, bool forParamVector = false); //Moving to CT
 		static unsigned GetNumCodonsForAA(std::string& aa, bool forParamVector = false); //Moving to CT
+		static unsigned GetNumCodonsForAAIndex(unsigned aaIndex, bool forParamVector = false);
 		static char complimentNucleotide(char ch); //TODO: Testing (c++)
 		static std::vector<std::string> aminoAcids(); //Moving to CT, but used in R currently
 		static std::vector<std::string> codons(); //Moving to CT, but used in R currently
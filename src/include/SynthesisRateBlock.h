@@ -0,0 +1,52 @@
+#ifndef SYNTHESISRATEBLOCK_H
+#define SYNTHESISRATEBLOCK_H
+
+#include <vector>
+
+// Synthesis rate state of all genes for one selection category, stored as a structure of arrays.
+// The columns (phi, proposed phi, their logs and the proposal widths) share one buffer. Every
+// column is padded to a multiple of eight doubles and the buffer starts on a 64 byte boundary,
+// so every column starts on its own cache line.
+class SynthesisRateBlock
+{
+	public:
+		//Constructors & Destructors:
+		SynthesisRateBlock();
+		SynthesisRateBlock(const SynthesisRateBlock& other);
+		SynthesisRateBlock& operator=(const SynthesisRateBlock& rhs);
+		virtual ~SynthesisRateBlock();
+
+
+		//Layout Functions:
+		void resize(unsigned _numGenes, double proposalWidth);
+		unsigned size();
+
+
+		//Access Functions:
+		double* getSynthesisRates(bool proposed = false) {return column(proposed ? proposedPhi : currentPhi);}
+		double* getLogSynthesisRates(bool proposed = false) {return column(proposed ? proposedLogPhi : currentLogPhi);}
+		double* getProposalWidths() {return column(proposalWidth);}
+		unsigned* getNumAccept() {return numAccept.data();}
+		void setSynthesisRate(unsigned geneIndex, double phi);
+		void acceptProposal(unsigned geneIndex);
+		std::vector<double> getSynthesisRateVector();
+
+
+		//Proposal Functions:
+		void propose(const double *standardNormals);
+
+	private:
+		enum Column {currentPhi, proposedPhi, currentLogPhi, proposedLogPhi, proposalWidth, numColumns};
+		static const unsigned alignment = 8u; // in doubles, 64 bytes
+		static const unsigned parallelProposalThreshold = 4096u; // genes, below this threads cost more than exp
+
+		std::vector<double> values; // over-allocated by alignment doubles, see column()
+		std::vector<unsigned> numAccept;
+		unsigned alignOffset;
+		unsigned numGenes;
+		unsigned columnStride;
+
+		double* column(Column c) {return values.data() + alignOffset + c * columnStride;}
+};
+
+#endif // SYNTHESISRATEBLOCK_H
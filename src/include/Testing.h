@@ -5,11 +5,18 @@
 #include "SequenceSummary.h"
 #include "Gene.h"
 #include "Genome.h"
+#include "RandomStream.h"
+#include "TraceStatistics.h"
+#include "TraceStorage.h"
+#include "base/Parameter.h"
 
 
 void testSequenceSummary();
 void testGene();
 void testGenome(std::string testFileDir);
+void testRandomStream();
+void testTraceStatistics();
+void testTraceStorage(std::string testFileDir);
 
 
 
@@ -0,0 +1,46 @@
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+#include <vector>
+#include <string>
+#include <map>
+
+#ifndef STANDALONE
+#include <Rcpp.h>
+#endif
+
+#include "TraceWriter.h"
+
+// Reads files written by TraceWriter. Opening a file only reads the record headers to index the blocks of every
+// column. Reading a column range then decodes just the blocks overlapping it.
+class TraceReader
+{
+	private:
+		struct Block
+		{
+			unsigned firstSample;
+			unsigned numSamples;
+			unsigned bytes;
+			std::streamoff offset; // of the encoded values
+		};
+
+		std::string filename;
+		std::vector<std::string> columnNames;
+		std::map<std::string, unsigned> columnIndex;
+		std::vector<std::vector<Block>> blocks; // [column], in sample order
+
+	public:
+		//Constructors & Destructors:
+		explicit TraceReader(std::string _filename);
+		virtual ~TraceReader();
+
+
+		//Reader Functions:
+		std::vector<std::string> getColumnNames();
+		unsigned getNumSamples(std::string column);
+		std::vector<double> readColumn(std::string column, unsigned firstSample, unsigned lastSample);
+		std::vector<std::vector<double>> readColumns(std::vector<std::string> columns, unsigned firstSample,
+			unsigned lastSample);
+};
+
+#endif // TRACEREADER_H
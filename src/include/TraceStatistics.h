@@ -0,0 +1,68 @@
+#ifndef TRACESTATISTICS_H
+#define TRACESTATISTICS_H
+
+#include <vector>
+
+// Streaming statistics of one trace, updated with every sample in constant time (constant per lag for the
+// autocovariances), so convergence diagnostics do not have to rescan the trace:
+// - mean and variance of the whole trace (Welford),
+// - mean and variance of any window [start, end) from prefix sums, e.g. for the Geweke score,
+// - the variance of the mean estimate by batch means. The batches double in size whenever their number reaches
+//	2 * numBatches, so there are always between numBatches and 2 * numBatches of them,
+// - the autocovariances up to maxLag.
+// Without window statistics only the mean, the variance and the batch means are kept, in constant memory, e.g. for
+// the effective sample size of every gene's synthesis rate.
+// All sums are of x - x_0 with the first sample x_0, which keeps them small for traces far away from 0 (log
+// likelihoods) and makes the window variances accurate.
+class TraceStatistics
+{
+	public:
+		static const unsigned numBatches = 32u;
+
+		//Constructors & Destructors:
+		explicit TraceStatistics(unsigned _maxLag = 50u, bool _windowStatistics = true);
+		virtual ~TraceStatistics();
+
+
+		//Update Functions:
+		void clear();
+		void add(double x);
+		void reserve(unsigned samples);
+
+
+		//Statistics Functions:
+		unsigned getNumSamples();
+		unsigned getMaxLag();
+		double getMean();
+		double getVariance();
+		double getWindowMean(unsigned start, unsigned end);
+		double getWindowVariance(unsigned start, unsigned end);
+		double getGewekeScore(unsigned start, unsigned end);
+		double getBatchMeansVariance();
+		double getAutocovariance(unsigned lag);
+		double getAutocorrelation(unsigned lag);
+		double getEffectiveSampleSize();
+		double getMonteCarloStandardError();
+
+	private:
+		unsigned maxLag;
+		bool windowStatistics; // keep the prefix sums and the autocovariances
+		unsigned numSamples;
+		double shift; // first sample
+
+		double mean; // of x - shift
+		double sumOfSquaredDeviations;
+
+		std::vector<double> cumulativeSum; // [n] sum of the first n samples
+		std::vector<double> cumulativeSumOfSquares;
+
+		unsigned batchSize;
+		unsigned batchCount; // samples in the current batch
+		double batchSum;
+		std::vector<double> batchMeans;
+
+		std::vector<double> recentValues; // ring buffer of the last maxLag samples
+		std::vector<double> laggedProducts; // [lag] sum_t (x_t - shift) * (x_t-lag - shift)
+};
+
+#endif // TRACESTATISTICS_H
@@ -0,0 +1,74 @@
+#ifndef TRACESTORAGE_H
+#define TRACESTORAGE_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+// Column oriented storage for a family of traces of the same length, e.g. the synthesis rate trace of every gene of
+// one category: storage[column][sample]. Each column is contiguous, so reading the trace of one gene touches only
+// its own pages.
+// The values live either in memory or in a memory mapped binary file (raw values, column after column), which lets
+// the OS page the traces out so their size is not limited by the physical memory.
+// Values are stored with the precision given at initialization and expanded to double on access: as doubles, as
+// floats (half the memory), or as the log of the value quantized to 16 bits (a quarter of the memory, relative error
+// below 2.5e-4 for values in [exp(-16), exp(16)], values <= 0 are stored as 0). The latter is meant for positive,
+// log normal parameters like synthesis rates. Copies of a mapped storage share
+// the mapping, the file is unmapped with the last copy and is kept on disk. Initializing a storage again replaces the
+// file by a new one, so copies sharing the old mapping keep their values. Where files can not be mapped (Windows,
+// or the file can not be created) the storage falls back to memory with a warning.
+class TraceStorage
+{
+	private:
+		struct MappedFile
+		{
+			unsigned char *data;
+			std::size_t bytes;
+			int fileDescriptor;
+
+			MappedFile() : data(0), bytes(0u), fileDescriptor(-1) {}
+			~MappedFile();
+		};
+
+		unsigned numColumns;
+		unsigned numSamples;
+		unsigned precision;
+		std::vector<unsigned char> values; // in memory storage
+		std::shared_ptr<MappedFile> mapping; // file storage
+		unsigned char *data; // first value of either
+
+		static const double minLogQuantized;
+		static const double maxLogQuantized;
+
+		bool mapFile(std::string filename);
+
+	public:
+		enum Precision {doublePrecision, singlePrecision, logQuantized};
+
+
+		//Constructors & Destructors:
+		TraceStorage();
+		TraceStorage(const TraceStorage& other);
+		TraceStorage& operator=(const TraceStorage& rhs);
+		virtual ~TraceStorage();
+
+
+		//Storage Functions:
+		void initialize(unsigned _numColumns, unsigned _numSamples, std::string filename = "",
+			unsigned _precision = doublePrecision);
+		bool isMapped();
+		unsigned getNumColumns();
+		unsigned getNumSamples();
+		unsigned getPrecision();
+		static std::size_t getValueSize(unsigned precision);
+
+
+		//Access Functions:
+		double get(unsigned column, unsigned sample);
+		void set(unsigned column, unsigned sample, double value);
+		std::vector<double> getColumn(unsigned column);
+		std::vector<std::vector<double>> getColumns();
+		void setColumn(unsigned column, const std::vector<double> &trace);
+};
+
+#endif // TRACESTORAGE_H
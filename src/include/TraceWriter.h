@@ -0,0 +1,56 @@
+#ifndef TRACEWRITER_H
+#define TRACEWRITER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+// Writes traces to a chunked columnar file while sampling, so the samples are on disk long before the run ends.
+// Every traced parameter is a named column. Its samples are buffered and written as one block per chunkSize samples,
+// encoded by encodeChunk. The file is a sequence of self-describing records after the header
+// "RIBTRACE" <version>:
+//	'C' <column> <name length> <name>							column definition
+//	'B' <column> <first sample> <samples> <bytes> <encoded values>	block of samples of one column
+// with all integers as unsigned 32 bit little endian. As there is no index at the end, a file of a crashed run is
+// readable up to its last complete block. See TraceReader for reading parameter subsets and sample ranges.
+class TraceWriter
+{
+	private:
+		struct Column
+		{
+			std::string name;
+			unsigned firstSample; // of the buffered values
+			std::vector<double> buffer;
+		};
+
+		std::ofstream out;
+		unsigned chunkSize;
+		std::vector<Column> columns;
+		unsigned blocksSinceFlush;
+
+		void writeBlock(unsigned column);
+
+	public:
+		static const unsigned version = 1u;
+
+		//Constructors & Destructors:
+		explicit TraceWriter(std::string filename, unsigned _chunkSize = 100u);
+		virtual ~TraceWriter();
+
+
+		//Writer Functions:
+		bool isOpen();
+		unsigned addColumn(std::string name);
+		void add(unsigned column, unsigned sample, double value);
+		void flush();
+
+
+		//Codec Functions:
+		static void encodeChunk(const std::vector<double> &values, std::vector<unsigned char> &encoded);
+		static bool decodeChunk(const std::vector<unsigned char> &encoded, unsigned numValues, std::vector<double> &values);
+		static void writeUnsigned(std::ostream &stream, unsigned value);
+		static bool readUnsigned(std::istream &stream, unsigned &value);
+};
+
+#endif // TRACEWRITER_H
@@ -20,9 +20,28 @@ class Model
         virtual void calculateLogLikelihoodRatioPerGene(Gene& gene, unsigned geneIndex, unsigned k, double* logProbabilityRatio) = 0;
         virtual void calculateLogLikelihoodRatioPerGroupingPerCategory(std::string grouping, Genome& genome,
         		double& logAcceptanceRatioForAllMixtures) = 0;
+		virtual void calculateLogLikelihoodRatioForAllGroupings(Genome& genome, std::vector<double> &logAcceptanceRatios);
 		virtual void calculateLogLikelihoodRatioForHyperParameters(Genome &genome, unsigned iteration, std::vector <double> &logProbabilityRatio) = 0;
 
 		virtual double calculateAllPriors() = 0;
+		virtual double calculateLogLikelihood(Genome& genome) = 0;
+
+
+
+		//Tempering Functions:
+		double getInverseTemperature();
+		void setInverseTemperature(double beta);
+
+
+
+		//Fused Iteration Functions (see MCMCAlgorithm::setFusedIteration):
+		virtual bool isFusedIterationSupported();
+		virtual unsigned getNumHyperParameterLogRatios();
+		virtual void prepareFusedIteration(Genome& genome);
+		virtual void addGeneToFusedLogRatios(Gene& gene, unsigned geneIndex, double *codonSpecificLogLikelihoods,
+				double *hyperParameterLogRatios);
+		virtual void completeFusedLogRatios(std::vector<double> &codonSpecificLogLikelihoods,
+				std::vector<double> &codonSpecificLogRatios, std::vector<double> &hyperParameterLogRatios);
 
 
 
@@ -37,7 +56,7 @@ class Model
 		virtual unsigned getMutationCategory(unsigned mixture) = 0;
 		virtual unsigned getSelectionCategory(unsigned mixture) = 0;
 		virtual unsigned getSynthesisRateCategory(unsigned mixture) = 0;
-		virtual std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned k) = 0;
+		virtual std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned k) = 0;
 
 
 
@@ -58,6 +77,7 @@ class Model
 
 		//Synthesis Rate Functions:
 		virtual double getSynthesisRate(unsigned index, unsigned mixture, bool proposed = false) = 0;
+		virtual double getLogSynthesisRate(unsigned index, unsigned mixture, bool proposed = false) = 0;
 		virtual void updateSynthesisRate(unsigned i, unsigned k) = 0;
 
 
@@ -75,6 +95,7 @@ class Model
 		virtual void updateCodonSpecificParameterTrace(unsigned sample, std::string grouping) = 0;
 		virtual void updateHyperParameterTraces(unsigned sample) = 0;
 		virtual void updateTracesWithInitialValues(Genome &genome) = 0;
+		virtual Trace& getTraceObject() = 0;
 
 		//Adaptive Width Functions:
 		virtual void adaptStdDevSynthesisRateProposalWidth(unsigned adaptiveWidth, bool adapt) = 0;
@@ -107,6 +128,7 @@ class Model
 		virtual void printHyperParameters() = 0;
 
 	protected:
+		double inverseTemperature; // the codon likelihood enters the posterior as likelihood^inverseTemperature
 };
 
 #endif // MODEL_H
@@ -15,6 +15,9 @@
 
 #include "../Genome.h"
 #include "../CovarianceMatrix.h"
+#include "../CodonSpecificParameterSet.h"
+#include "../SynthesisRateBlock.h"
+#include "../RandomStream.h"
 #include "Trace.h"
 
 
@@ -30,6 +33,11 @@ class Parameter {
 		static void swap(double& a, double& b);
 		static void swap(int& a, int& b);
 
+#ifdef STANDALONE
+		static uint64_t seed; // see setSeed
+		static RandomStream createThreadGenerator();
+#endif
+
 		unsigned adaptiveStepPrev;
 		unsigned adaptiveStepCurr;
 
@@ -47,8 +55,10 @@ class Parameter {
 		static const unsigned alp;
 		static const unsigned lmPri;
 
+		static const unsigned logGammaRecurrenceLimit;
+
 #ifdef STANDALONE
-		static std::default_random_engine generator; // static to make sure that the same generator is during the runtime.
+		static thread_local RandomStream generator; // one per thread, MultiChainMCMC swaps in the stream of the chain a thread runs.
 #endif
 
 
@@ -91,8 +101,8 @@ class Parameter {
 		unsigned getMutationCategory(unsigned mixtureElement);
 		unsigned getSelectionCategory(unsigned mixtureElement); //TODO: Add comments explaining reasonsing here for same function
 		unsigned getSynthesisRateCategory(unsigned mixtureElement);
-		std::vector<unsigned> getMixtureElementsOfMutationCategory(unsigned category);
-		std::vector<unsigned> getMixtureElementsOfSelectionCategory(unsigned category);
+		std::vector<unsigned>& getMixtureElementsOfMutationCategory(unsigned category);
+		std::vector<unsigned>& getMixtureElementsOfSelectionCategory(unsigned category);
 		std::string getMutationSelectionState();
 
 
@@ -116,6 +126,7 @@ class Parameter {
 
 		//Synthesis Rate Functions:
 		double getSynthesisRate(unsigned geneIndex, unsigned mixtureElement, bool proposed = false);
+		double getLogSynthesisRate(unsigned geneIndex, unsigned mixtureElement, bool proposed = false);
 		double getCurrentSynthesisRateProposalWidth(unsigned expressionCategory, unsigned geneIndex);
 		double getSynthesisRateProposalWidth(unsigned geneIndex, unsigned mixtureElement);
 		void proposeSynthesisRateLevels();
@@ -134,6 +145,10 @@ class Parameter {
 		//Trace Functions:
 		Trace& getTraceObject();
 		void setTraceObject(Trace _trace);
+		void setMappedTraceFilePrefix(std::string prefix);
+		void setTraceWriterSettings(std::string filename, unsigned chunkSize);
+		void setTracePrecision(std::string family, std::string precision);
+		void setPosteriorWindow(unsigned samples);
 		void updateStdDevSynthesisRateTrace(unsigned sample);
 		void updateSynthesisRateTrace(unsigned sample, unsigned geneIndex);
 		void updateMixtureAssignmentTrace(unsigned sample, unsigned geneIndex);
@@ -144,11 +159,13 @@ class Parameter {
 		void adaptStdDevSynthesisRateProposalWidth(unsigned adaptationWidth, bool adapt);
 		void adaptSynthesisRateProposalWidth(unsigned adaptationWidth, bool adapt);
 		virtual void adaptCodonSpecificParameterProposalWidth(unsigned adaptationWidth, unsigned lastIteration, bool adapt);
+		void updateCodonSpecificParameterCovariance(std::string grouping);
 
 
 		//Posterior, Variance, and Estimates Functions:
 		double getStdDevSynthesisRatePosteriorMean(unsigned samples, unsigned mixture);
 		double getSynthesisRatePosteriorMean(unsigned samples, unsigned geneIndex, unsigned mixtureElement);
+		double getLogSynthesisRatePosteriorMean(unsigned samples, unsigned geneIndex, unsigned mixtureElement);
 
 		double getCodonSpecificPosteriorMean(unsigned mixtureElement, unsigned samples, std::string &codon, unsigned paramType,
 			bool withoutReference = true);
@@ -175,6 +192,9 @@ class Parameter {
 
 		//Static Functions:
 		static double calculateSCUO(Gene& gene, unsigned maxAA);
+#ifdef STANDALONE
+		static void setSeed(uint64_t _seed);
+#endif
 		static void drawIidRandomVector(unsigned draws, double mean, double sd, double (*proposal)(double a, double b),
 				double* randomNumbers);
 		static void drawIidRandomVector(unsigned draws, double r, double (*proposal)(double r), double* randomNumber);
@@ -185,8 +205,15 @@ class Parameter {
 		static void randDirichlet(double *input, unsigned numElements, double *output);
 		static double randUnif(double minVal, double maxVal);
 		static unsigned randMultinom(double* probabilities, unsigned mixtureElements);
+		static unsigned randMultinom(double* probabilities, unsigned mixtureElements, double referenceValue);
+		static void randNormVector(unsigned draws, double mean, double sd, double* randomNumbers);
+		static void randExpVector(unsigned draws, double r, double* randomNumbers);
+		static void randUnifVector(unsigned draws, double minVal, double maxVal, double* randomNumbers);
 		static double densityNorm(double x, double mean, double sd, bool log = false);
 		static double densityLogNorm(double x, double mean, double sd, bool log = false);
+		static double densityLogNormLogScale(double logX, double mean, double sd, bool log = false);
+		static double logGammaRatio(double x, unsigned n);
+		static double logGammaRatio(double x, unsigned n, double lgammaX);
 		//double getMixtureAssignmentPosteriorMean(unsigned samples, unsigned geneIndex); // TODO: implement variance function, fix Mean function (won't work with 3 groups)
 
 
@@ -228,6 +255,8 @@ class Parameter {
 		//Posterior, Variance, and Estimates Functions:
 		double getSynthesisRatePosteriorMeanByMixtureElementForGene(unsigned samples, unsigned geneIndex,
 																	unsigned mixtureElement);
+		double getLogSynthesisRatePosteriorMeanByMixtureElementForGene(unsigned samples, unsigned geneIndex,
+																	unsigned mixtureElement);
 		double getSynthesisRateVarianceByMixtureElementForGene(unsigned samples, unsigned geneIndex,
 														   unsigned mixtureElement, bool unbiased);
 		unsigned getEstimatedMixtureAssignmentForGene(unsigned samples, unsigned geneIndex);
@@ -261,8 +290,8 @@ class Parameter {
 		std::vector<unsigned> numAcceptForCodonSpecificParameters;
 		std::string mutationSelectionState; //TODO: Probably needs to be renamed
 
-		std::vector<std::vector<std::vector<double>>> proposedCodonSpecificParameter;
-		std::vector<std::vector<std::vector<double>>> currentCodonSpecificParameter;
+		CodonSpecificParameterSet proposedCodonSpecificParameter; // [paramType][category][codon]
+		CodonSpecificParameterSet currentCodonSpecificParameter;
 
 		std::vector<unsigned> mixtureAssignment;
 		std::vector<std::string> groupList;
@@ -278,9 +307,7 @@ class Parameter {
 
 
 
-		std::vector<std::vector<double>> proposedSynthesisRateLevel;
-		std::vector<std::vector<double>> currentSynthesisRateLevel;
-		std::vector<std::vector<unsigned>> numAcceptForSynthesisRate;
+		std::vector<SynthesisRateBlock> synthesisRateLevel; //[category]: phi, log(phi), proposals, widths and acceptance counts
 
 		unsigned lastIteration;
 
@@ -289,7 +316,6 @@ class Parameter {
 		unsigned obsPhiSets;
 
 		double bias_phi;
-		std::vector<std::vector<double>> std_phi;
 
 };
 
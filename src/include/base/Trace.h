@@ -6,29 +6,68 @@
 #include <iostream>
 #include <vector>
 #include <cctype>
+#include <memory>
 
 #ifndef STANDALONE
 #include <Rcpp.h>
 #endif
 
 #include "../mixtureDefinition.h"
+#include "../CodonSpecificParameterSet.h"
+#include "../SynthesisRateBlock.h"
+#include "../TraceStatistics.h"
+#include "../PosteriorAccumulator.h"
+#include "../TraceStorage.h"
+#include "../PackedTraceStorage.h"
+#include "../TraceWriter.h"
 
 class Trace {
 	private:
     
 		unsigned numCodonSpecificParamTypes;
 
-		std::vector<std::vector<double>> stdDevSynthesisRateTrace; //mixture, samples
+		TraceStorage stdDevSynthesisRateTrace; //order: category, samples
 		std::vector<double> stdDevSynthesisRateAcceptanceRatioTrace; //samples TODO: Correctly sized for the time being,
         //however, it will need to be changed at some point when there are some adjustments to hyper parameter acceptance/rejection
 		std::vector<std::vector<std::vector<double>>>synthesisRateAcceptanceRatioTrace; //order: expressionCategory, gene, sample
 		std::vector<std::vector<double>> codonSpecificAcceptanceRatioTrace;//order: codon, sample
-		std::vector<std::vector<std::vector<double>>> synthesisRateTrace;//order: expressioncategoy, gene, samples
-		std::vector<std::vector<unsigned>> mixtureAssignmentTrace;//order: numGenes, samples
-		std::vector<std::vector<double>> mixtureProbabilitiesTrace;//order: numMixtures, samples
+		std::vector<TraceStorage> synthesisRateTrace;//order: expressioncategoy, gene, samples
+		PackedTraceStorage mixtureAssignmentTrace;//order: numGenes, samples
+		TraceStorage mixtureProbabilitiesTrace;//order: numMixtures, samples
 		std::vector<std::vector<std::vector<std::vector<double>>>> codonSpecificParameterTrace; //order: paramType, category, numparam, samples
 		//std::vector<std::vector<std::vector<double>>> codonSpecificParameterTraceTwo; //order: category, numparam, samples
 		std::vector<mixtureDefinition> *categories;
+		std::string mappedTraceFilePrefix; // keep the synthesis rate traces in files starting with it, empty keeps them in memory
+		unsigned synthesisRatePrecision; // TraceStorage::Precision of the trace families, see setTracePrecision
+		unsigned stdDevSynthesisRatePrecision;
+		unsigned mixtureProbabilitiesPrecision;
+
+		// Streams all traces to traceWriterFile while sampling, see setTraceWriterSettings. Every trace family takes
+		// consecutive writer columns starting at its *Column, in the order of its trace.
+		std::shared_ptr<TraceWriter> writer;
+		std::string traceWriterFile;
+		unsigned traceWriterChunkSize;
+		unsigned stdDevSynthesisRateColumn;
+		unsigned synthesisRateColumn;
+		unsigned mixtureAssignmentColumn;
+		unsigned mixtureProbabilitiesColumn;
+		std::vector<unsigned> codonSpecificParameterColumn; //[paramType]
+
+		// Streaming statistics of the traces above, without the initial values (sample 0). They are kept without window
+		// statistics so their memory does not grow with the number of samples.
+		std::vector<TraceStatistics> stdDevSynthesisRateStatistics; //mixture
+		std::vector<std::vector<TraceStatistics>> synthesisRateStatistics; //order: expressionCategory, gene
+		std::vector<TraceStatistics> mixtureProbabilitiesStatistics; //order: numMixtures
+		std::vector<std::vector<std::vector<TraceStatistics>>> codonSpecificParameterStatistics; //order: paramType, category, numparam, with window statistics
+
+		// Posterior summaries of the last posteriorWindow samples (samples >= posteriorFirstSample), see
+		// setPosteriorWindow, including the histogram of every gene's mixture assignments. Not kept with a window of 0.
+		unsigned posteriorWindow;
+		unsigned posteriorFirstSample;
+		std::vector<std::vector<PosteriorAccumulator>> synthesisRateAccumulators; //order: expressionCategory, gene
+		std::vector<std::vector<PosteriorAccumulator>> assignedSynthesisRateAccumulators; //order: expressionCategory, gene
+		std::vector<std::vector<std::vector<PosteriorAccumulator>>> codonSpecificParameterAccumulators; //order: paramType, category, numparam
+		std::vector<std::vector<unsigned>> mixtureAssignmentCounts; //order: gene, mixture
 
 
 
@@ -36,6 +75,10 @@ class Trace {
 		std::vector<std::vector <double>> synthesisOffsetTrace;
 		std::vector<std::vector <double>> synthesisOffsetAcceptanceRatioTrace;
 		std::vector<std::vector <double>> observedSynthesisNoiseTrace;
+		std::vector<TraceStatistics> synthesisOffsetStatistics;
+		std::vector<TraceStatistics> observedSynthesisNoiseStatistics;
+		unsigned synthesisOffsetColumn;
+		unsigned observedSynthesisNoiseColumn;
 
 		//FONSE Trace:
 
@@ -51,9 +94,11 @@ class Trace {
 		void initStdDevSynthesisRateTrace(unsigned numSelectionCategories, unsigned samples);
 		void initSynthesisRateAcceptanceRatioTrace(unsigned num_genes, unsigned numExpressionCategories);
 		void initSynthesisRateTrace(unsigned samples, unsigned num_genes, unsigned numExpressionCategories);
-		void initMixtureAssignmentTrace(unsigned samples, unsigned num_genes);
+		void initMixtureAssignmentTrace(unsigned samples, unsigned num_genes, unsigned numMixtures);
 		void initMixtureProbabilitesTrace(unsigned samples, unsigned numMixtures);
 		void initCodonSpecificParameterTrace(unsigned samples, unsigned numMutationCategories, unsigned numParam, unsigned paramType);
+		std::string getSynthesisRateTraceFileName(unsigned category);
+		unsigned addWriterColumns(std::string prefix, unsigned count);
 
 
 		//ROC Specific:
@@ -92,6 +137,15 @@ public:
 	void initializePANSETrace(unsigned samples, unsigned num_genes, unsigned numAlphaCategories,
 		unsigned numLambdaPrimeCategories, unsigned numParam, unsigned numMixtures,
 		std::vector<mixtureDefinition> &_categories, unsigned maxGrouping);
+	void setMappedTraceFilePrefix(std::string prefix);
+	std::string getMappedTraceFilePrefix();
+	void setTracePrecision(std::string family, std::string precision);
+	void setPosteriorWindow(unsigned samples);
+	std::string getTracePrecision(std::string family);
+	void setTraceWriterSettings(std::string filename, unsigned chunkSize = 100u);
+	std::string getTraceWriterFile();
+	unsigned getTraceWriterChunkSize();
+	void flushTraceWriter();
 
 
         //Getter Functions:
@@ -107,6 +161,7 @@ public:
         std::vector<unsigned> getMixtureAssignmentTraceForGene(unsigned geneIndex);
         std::vector<double> getMixtureProbabilitiesTraceForMixture(unsigned mixtureIndex);
         std::vector<std::vector<unsigned>> getMixtureAssignmentTrace();
+        std::vector<unsigned> getMixtureAssignmentCounts(unsigned geneIndex, unsigned firstSample, unsigned lastSample);
         std::vector<std::vector<double>> getMixtureProbabilitiesTrace();
         std::vector<std::vector<double>> getCodonSpecificAcceptanceRatioTrace();
         unsigned getSynthesisRateCategory(unsigned mixtureElement);
@@ -128,18 +183,44 @@ public:
 
 
 
+        //Statistics Functions:
+        double getStdDevSynthesisRateEffectiveSampleSize(unsigned selectionCategory);
+        double getStdDevSynthesisRateMonteCarloStandardError(unsigned selectionCategory);
+        double getSynthesisRateEffectiveSampleSize(unsigned mixtureElement, unsigned geneIndex);
+        double getSynthesisRateMonteCarloStandardError(unsigned mixtureElement, unsigned geneIndex);
+        double getMixtureProbabilitiesEffectiveSampleSize(unsigned mixtureIndex);
+        double getMixtureProbabilitiesMonteCarloStandardError(unsigned mixtureIndex);
+        double getCodonSpecificParameterEffectiveSampleSize(unsigned mixtureElement, std::string& codon, unsigned paramType,
+                bool withoutReference = true);
+        double getCodonSpecificParameterMonteCarloStandardError(unsigned mixtureElement, std::string& codon, unsigned paramType,
+                bool withoutReference = true);
+        double getMinimumEffectiveSampleSize();
+        double getMaximumCodonSpecificParameterGewekeScore(unsigned start, unsigned end, unsigned &numTraces);
+        bool getSynthesisRateAccumulators(unsigned mixtureElement, unsigned geneIndex, unsigned firstSample,
+                unsigned lastSample, PosteriorAccumulator &all, PosteriorAccumulator &assigned);
+        bool getCodonSpecificParameterAccumulator(unsigned mixtureElement, std::string& codon, unsigned paramType,
+                bool withoutReference, unsigned firstSample, unsigned lastSample, PosteriorAccumulator &accumulator);
+
+        //ROC Specific:
+        double getSynthesisOffsetEffectiveSampleSize(unsigned index);
+        double getSynthesisOffsetMonteCarloStandardError(unsigned index);
+        double getObservedSynthesisNoiseEffectiveSampleSize(unsigned index);
+        double getObservedSynthesisNoiseMonteCarloStandardError(unsigned index);
+
+
+
         //Update Functions:
         void updateStdDevSynthesisRateTrace(unsigned sample, double stdDevSynthesisRate, unsigned synthesisRateCategory);
         void updateStdDevSynthesisRateAcceptanceRatioTrace(double acceptanceLevel);
         void updateSynthesisRateAcceptanceRatioTrace(unsigned category, unsigned geneIndex, double acceptanceLevel);
         void updateCodonSpecificAcceptanceRatioTrace(unsigned codonIndex, double acceptanceLevel);
-        void updateSynthesisRateTrace(unsigned sample, unsigned geneIndex, std::vector<std::vector <double>> &currentExpressionLevel);
+        void updateSynthesisRateTrace(unsigned sample, unsigned geneIndex, std::vector<SynthesisRateBlock> &currentExpressionLevel);
         void updateMixtureAssignmentTrace(unsigned sample, unsigned geneIndex, unsigned value);
         void updateMixtureProbabilitiesTrace(unsigned samples, std::vector<double> &categoryProbabilities);
 
 
         //ROC Specific:
-        void updateCodonSpecificParameterTraceForAA(unsigned sample, std::string aa, std::vector<std::vector<double>> &curParam, unsigned paramType);
+        void updateCodonSpecificParameterTraceForAA(unsigned sample, std::string aa, CodonSpecificParameterSet::ParameterTypeView curParam, unsigned paramType);
         void updateSynthesisOffsetTrace(unsigned index, unsigned sample, double value);
         void updateSynthesisOffsetAcceptanceRatioTrace(unsigned index, double value);
         void updateObservedSynthesisNoiseTrace(unsigned index, unsigned sample, double value);
@@ -147,7 +228,7 @@ public:
         //FONSE Specific:
 
         //RFP Specific:
-        void updateCodonSpecificParameterTraceForCodon(unsigned sample, std::string codon, std::vector<std::vector<double>> &curParam, unsigned paramType);
+        void updateCodonSpecificParameterTraceForCodon(unsigned sample, std::string codon, CodonSpecificParameterSet::ParameterTypeView curParam, unsigned paramType);
 
 
 
@@ -164,6 +245,24 @@ public:
 
 
 
+        //Statistics Functions:
+        double getStdDevSynthesisRateEffectiveSampleSizeR(unsigned selectionCategory);//R WRAPPER
+        double getStdDevSynthesisRateMonteCarloStandardErrorR(unsigned selectionCategory);//R WRAPPER
+        double getSynthesisRateEffectiveSampleSizeR(unsigned mixtureElement, unsigned geneIndex);//R WRAPPER
+        double getSynthesisRateMonteCarloStandardErrorR(unsigned mixtureElement, unsigned geneIndex);//R WRAPPER
+        double getMixtureProbabilitiesEffectiveSampleSizeR(unsigned mixtureIndex);//R WRAPPER
+        double getMixtureProbabilitiesMonteCarloStandardErrorR(unsigned mixtureIndex);//R WRAPPER
+        double getCodonSpecificParameterEffectiveSampleSizeR(unsigned mixtureElement, std::string& codon, unsigned paramType,
+                bool withoutReference);//R WRAPPER
+        double getCodonSpecificParameterMonteCarloStandardErrorR(unsigned mixtureElement, std::string& codon, unsigned paramType,
+                bool withoutReference);//R WRAPPER
+        double getSynthesisOffsetEffectiveSampleSizeR(unsigned index);//R WRAPPER
+        double getSynthesisOffsetMonteCarloStandardErrorR(unsigned index);//R WRAPPER
+        double getObservedSynthesisNoiseEffectiveSampleSizeR(unsigned index);//R WRAPPER
+        double getObservedSynthesisNoiseMonteCarloStandardErrorR(unsigned index);//R WRAPPER
+
+
+
         //Setter Functions:
         void setStdDevSynthesisRateTraces(std::vector<std::vector<double>> _stdDevSynthesisRateTrace);
         void setStdDevSynthesisRateAcceptanceRatioTrace(std::vector<double> _stdDevSynthesisRateAcceptanceRatioTrace);
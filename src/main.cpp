@@ -13,6 +13,9 @@ int main()
 	int useSamples = 100;
 	std::cout << "\t# Samples: " << samples << "\n";
 	std::cout << "\tThining: " << thining << "\n";
+	uint64_t seed = (uint64_t)std::time(NULL); // set a fixed seed to repeat a run
+	std::cout << "\tSeed: " << seed << "\n";
+	Parameter::setSeed(seed);
 	std::cout << "\t# Samples used: " << useSamples << "\n";
 	MCMCAlgorithm mcmc = MCMCAlgorithm(samples, thining, 100, true, true, true);
 	//mcmc.setRestartFileSettings("RestartFile.txt", 20, true);
@@ -151,6 +154,9 @@ int main()
 	int useSamples = 100;
 	std::cout << "\t# Samples: " << samples << "\n";
 	std::cout << "\tThining: " << thining << "\n";
+	uint64_t seed = (uint64_t)std::time(NULL); // set a fixed seed to repeat a run
+	std::cout << "\tSeed: " << seed << "\n";
+	Parameter::setSeed(seed);
 	std::cout << "\t # Samples used: " << useSamples << "\n";
 	MCMCAlgorithm mcmc = MCMCAlgorithm(samples, thining, 10, true, true, true);
 	mcmc.setRestartFileSettings("RestartFile.txt", 20, true);
@@ -418,6 +424,9 @@ int main()
 	unsigned numMixtures = 1;
 	std::cout << "\t# Samples: " << samples << "\n";
 	std::cout << "\tThining: " << thining << "\n";
+	uint64_t seed = (uint64_t)std::time(NULL); // set a fixed seed to repeat a run
+	std::cout << "\tSeed: " << seed << "\n";
+	Parameter::setSeed(seed);
 	std::cout << "\t # Samples used: " << useSamples << "\n";
 	MCMCAlgorithm mcmc = MCMCAlgorithm(samples, thining, 10, true, true, true);
 	mcmc.setRestartFileSettings("RestartFile.txt", 20, true);